@@ -2,12 +2,30 @@
 #define GAME_MANAGER_H
 #include "board_config.h"
 #include <atomic>
+#include <mutex>
 #include <vector>
 #include <array>
 #include <ESPGameAPI.h>
 #include <NFCBuildingRegistry.h>
 #include "power_plant_config.h"
 #include "PeripheralFactory.h"
+#include "encoder_input.h"
+#include "latency_histogram.h"
+#include "amount_debouncer.h"
+#include "actuation_policy.h"
+#include "warm_start.h"
+#include "uid_store.h"
+#include "server_tables.h"
+#include "storage_integrator.h"
+#include "window_aggregator.h"
+#include "telemetry_journal.h"
+#include "upload_list.h"
+#include "poll_handoff.h"
+#include "poll_cadence.h"
+#include "fingerprint.h"
+#include "request_stats.h"
+#include "telemetry_frame.h"
+#include "server_events.h"
 
 // ConnectedBuilding is defined in ESPGameAPI.h — do not redefine here.
 
@@ -38,7 +56,7 @@ struct PowerPlant {
     float maxWatts;             // Maximum production capacity
     
     // Hardware references
-    Encoder* encoder;
+    EncoderInput* encoder;
     SegmentDisplay* powerDisplay;
     Bargraph* powerBargraph;
     
@@ -87,7 +105,9 @@ class GameManager {
 private:
     // Maximum number of power plant types we can control locally
     static constexpr size_t MAX_POWER_PLANTS = 8;
-    static constexpr unsigned long ATTRACTION_UPDATE_MS = 200;
+    static constexpr unsigned long ATTRACTION_UPDATE_MS = 200;        // periodic full refresh (backstop)
+    static constexpr unsigned long ATTRACTION_EVENT_MIN_GAP_MS = 20;  // per-type rate limit for event-driven commands
+    static constexpr uint8_t MAX_SLAVE_TYPE = BATTERY;
     
     // Array of local power plant type controllers (encoder + display)
     // The actual count of powerplants comes from UART
@@ -102,20 +122,114 @@ private:
     
     // UART Powerplant tracking
     std::vector<UartSlaveInfo> uartPowerplants;
-    // Pending decreases (including disconnects) awaiting grace timeout before committing
-    struct PendingDecrease {
-        uint8_t slaveType;        // Type identifier
-        uint8_t targetAmount;     // Amount we will switch to after grace
-        unsigned long firstSeen;  // When this pending decrease was first observed
-        uint8_t originalAmount;   // Amount before decrease (for debug)
-    };
-    std::vector<PendingDecrease> pendingDecreases;
-    static constexpr unsigned long DECREASE_GRACE_MS = 500; // Grace period before applying a decrease / disconnect
+    // Per-type debounce of reported amounts (grace periods, flap counters)
+    AmountDebouncer uartDebouncer;
     unsigned long lastUartAttractionUpdate;
+
+    // Event-driven actuation: encoder / range / inventory changes mark a type dirty and the
+    // next updateAttractionStates() call emits a command for just that type (rate limited)
+    std::array<long, MAX_POWER_PLANTS> lastEncoderValues;           // raw encoder value per plant index
+    std::atomic<uint16_t> pendingActuationMask;                      // bit N = slave type N needs a command
+    std::atomic<uint16_t> forcedActuationMask;                       // bit N = send a frame even if unchanged
+    std::array<unsigned long, MAX_SLAVE_TYPE + 1> lastActuationTime; // millis() of last command per type
+    std::array<uint32_t, MAX_SLAVE_TYPE + 1> actuationEventMicros;   // micros() of oldest unserved event (0 = none)
+    std::array<uint8_t, MAX_SLAVE_TYPE + 1> lastActuationCommand;    // last cmd4 sent per type
+    std::array<ActuationPolicy::LevelState, MAX_SLAVE_TYPE + 1> actuationLevels; // hysteresis / dwell state
+    uint32_t suppressedActuationFrames;                              // event frames skipped (command unchanged)
+    LatencyHistogram actuationLatencyUs;                             // event -> UART frame latency
+
+    // State of charge of the storage types, integrated from their signed power on every update()
+    StorageIntegrator batteryStorage;
+    StorageIntegrator hydroStorage;
     
-    // Consumption tracking
+    // Consumption tracking: per-building-type counts maintained from NFC add/remove events,
+    // combined with a type-indexed consumption table -> O(1) update per card event
+    static constexpr size_t BUILDING_TYPE_SLOTS = 256;
     std::atomic<float> totalConsumption;
-    unsigned long lastConsumptionUpdate;
+    std::array<uint16_t, BUILDING_TYPE_SLOTS> buildingTypeCounts; // written under telemetryMutex
+    std::array<float, BUILDING_TYPE_SLOTS> consumptionByBuildingType;
+
+    // Server tables: API callbacks build a new version off to the side and publish it with one
+    // index swap; update() mirrors each new generation into the plants and the loop-side arrays
+    ServerTableBuffer serverTables;
+    ServerTables serverTablesSnapshot;              // loop-side copy while applying a generation
+    uint32_t appliedTablesGeneration;
+    static_assert(ServerTables::TYPE_SLOTS == MAX_SLAVE_TYPE + 1, "server tables indexed by slave type");
+
+    // Production coefficients mirrored per source type (O(1) lookup, survives reboot via warm start)
+    std::array<float, MAX_SLAVE_TYPE + 1> productionCoefficientByType;
+    uint16_t productionCoefficientMask;     // bit N = the server tables hold a coefficient for type N
+
+    // Warm start: last-known tables restored from NVS before WiFi, superseded once the server answers
+    static constexpr unsigned long WARM_START_TRUST_MS = 30000; // restored game state expires without server
+    WarmStart warmStart;
+    bool warmStartDirty;                            // something persisted changed since the last save
+    uint32_t warmStartBuildingGeneration;           // building set generation covered by the last save
+    bool warmGameActive;                            // game state assumed until the server answers
+    unsigned long warmRestoreTime;
+    std::atomic<bool> serverStateConfirmed;         // server game state trusted over the restored one
+    bool stateResponseOk;                           // a ranges / coefficients request succeeded
+    bool libraryReportedState;                      // espApi->update() completed a status exchange
+
+    // Versioned building set: every add/remove/bulk change bumps the generation; the API-facing
+    // list is rebuilt and pushed to ESP-API only when the generation moved
+    uint32_t buildingSetGeneration;
+    uint32_t pushedBuildingGeneration;
+    uint32_t apiBuildingsGeneration;
+    std::vector<ConnectedBuilding> apiBuildings;
+
+    // Connected buildings by raw UID (mirror of the NFC registry; hex text only at the API /
+    // registry boundary). Holds the warm-start buildings until the registry is attached.
+    UidStore buildingUids;
+
+    // High-rate telemetry: totals sampled on every update() and summarized per ESP-API upload,
+    // so the uploaded power is the window's time-weighted mean rather than one instant
+    struct TelemetryWindow {
+        uint32_t sequence;                                          // 0 = nothing closed yet
+        WindowStats production;
+        WindowStats consumption;
+        std::array<WindowStats, MAX_SLAVE_TYPE + 1> typeProduction; // per slave type, all units
+    };
+    WindowAggregator productionAggregator;
+    WindowAggregator consumptionAggregator;
+    std::array<WindowAggregator, MAX_SLAVE_TYPE + 1> typeProductionAggregators;
+    TelemetryWindow uploadWindow;        // last closed window, shared by the callbacks of one upload
+    unsigned long uploadWindowClosedAt;
+    std::mutex telemetryMutex;
+
+    // While the server is unreachable during a game the aggregators are cut into journal
+    // records. Once it answers again the journal upload task backfills them oldest first, with
+    // their age, in batches next to the live upload windows; a batch leaves the journal when
+    // the server acknowledged it.
+    TelemetryJournal<JOURNAL_CAPACITY> telemetryJournal;
+    unsigned long telemetryCutAt;        // aggregators last closed (upload window or journal record)
+    uint32_t journalReplayed;            // records acknowledged since the journal was last empty
+    std::atomic<unsigned long> lastServerResponse;  // last successful server exchange, 0 = none yet
+    std::atomic<unsigned long> serverFailingSince;  // first failed request since then, 0 = none
+    void journalTelemetry(unsigned long now);
+    // Unknown counts as reachable: only requests that really failed, with no answer since,
+    // for JOURNAL_OFFLINE_AFTER_MS make the server unreachable
+    bool isServerReachable(unsigned long now) const {
+        const unsigned long failingSince = serverFailingSince;
+        return failingSince == 0 || now - failingSince < JOURNAL_OFFLINE_AFTER_MS;
+    }
+    void noteServerResponse(bool ok, unsigned long now) {
+        if (ok) {
+            lastServerResponse = now ? now : 1;
+            serverFailingSince = 0;
+        } else if (serverFailingSince == 0) {
+            serverFailingSince = now ? now : 1;
+        }
+    }
+
+    // Telemetry lists refilled in place for the ESP-API callbacks: the periodic path does not
+    // touch the heap apart from the copy the library callback signature returns
+    static constexpr size_t MAX_CONNECTED_CONSUMERS = 128;
+    static_assert(MAX_CONNECTED_CONSUMERS == UidStore::CAPACITY,
+                  "every uploaded building needs an interned UID for the warm start");
+    UploadList<ConnectedPowerPlant> connectedPlants;
+    UploadList<ConnectedConsumer> connectedConsumers;
+    uint32_t lastReportedConsumerDrop; // consumers cut from the last upload, logged on change
 
     // Total displays for production and consumption
     SegmentDisplay* productionTotalDisplay;
@@ -125,22 +239,52 @@ private:
     unsigned long lastRetranslationPing;   // millis() of last ping / status response
     unsigned long lastPingRequest;         // millis() when we last sent a status request
     bool retranslationConnected;           // current evaluated connectivity state
-    bool displayBlinkState;                // current blink phase
-    unsigned long lastBlinkToggle;         // last toggle time
+    bool displayBlinkState;                // current blink phase (toggled by the scheduler)
+    std::atomic<bool> powerTraceDue;       // log per-type power on the next display pass
     static constexpr unsigned long RETRANSLATION_TIMEOUT_MS = 9500;      // if no ping within 9.5s -> disconnected
     static constexpr unsigned long PING_REQUEST_INTERVAL_MS = 3000;      // send status request every 3s
 
-    // Throttling for server requests
-    unsigned long lastRequestTime;
-    static constexpr unsigned long REQUEST_INTERVAL_MS = 3000; // Request both coefficients and ranges every 3 seconds
-    
-    // Request in-flight tracking to prevent queue backlog
-    bool productionRangesRequestInFlight;
-    bool productionCoefficientsRequestInFlight;
-    
+    // Server state poll. Ranges and coefficients are fetched as one sequence with a single
+    // request in flight: coefficients every cycle, ranges only when due (first poll, game state
+    // change, RANGES_REFRESH_INTERVAL_MS). Each response is fingerprinted and an unchanged one
+    // is dropped without republishing, so a steady server costs no table apply or actuation.
+    // The cycle interval comes from pollCadence (game state and observed change rate).
+    //
+    // The request callbacks run on the AsyncRequest worker and touch nothing but the
+    // fingerprints, the server tables and pollResponse: a callback claims its request by moving
+    // pollHandoff from in flight to POLL_RECEIVING with the ticket of its own request, fills
+    // pollResponse and hands it over with POLL_ANSWERED. updateEspApi() applies it on the loop
+    // task. The loop gives up on a lost request with the same compare-exchange, so a late
+    // answer is dropped, never half-applied, even once a newer request is in flight.
+    struct PollResponse {
+        RequestStats::Endpoint endpoint;
+        bool success;
+        bool changed;               // fingerprint differs from the previous response
+        unsigned long receivedAt;
+        char error[96];
+    };
+    PollHandoff pollHandoff;
+    PollResponse pollResponse;
+    unsigned long lastRequestTime;         // start of the current / last poll cycle
+    unsigned long pollStageStartTime;      // when the in-flight request was sent
+    unsigned long lastRangesFetch;
+    bool rangesRefreshDue;
+    uint32_t rangesFingerprint;            // 0 = nothing received yet; callbacks write while in flight
+    uint32_t coefficientsFingerprint;
+    uint32_t pollCycles;
+    uint32_t pollRequests;
+    uint32_t pollUnchanged;                // responses identical to the previous one
+    bool pollCycleChanged;                 // the running cycle brought new ranges or coefficients
+    PollCadence pollCadence;
+    bool pushSubscribed;                   // server-push stream up: poll at the fallback interval
+    bool statePollRequested;               // run a cycle as soon as none is in flight
+    RequestStats requestStats;             // per-endpoint latency and failure causes
+    std::atomic<uint32_t> statusUploads;   // upload lists handed to the library (one per status exchange)
+    char serverUrl[96];                    // base URL the ESP-API instance talks to
+    static constexpr unsigned long RANGES_REFRESH_INTERVAL_MS = 30000;   // ranges only change per scenario
+    static constexpr unsigned long POLL_TIMEOUT_MS = 15000;              // give up on a lost response
+
     // Debug timing for API requests
-    unsigned long rangesRequestStartTime;
-    unsigned long coefficientsRequestStartTime;
     unsigned long lastDebugTime;
 
     // Track whether we've already applied initial building list from server
@@ -153,20 +297,54 @@ private:
         espApi(nullptr),
         nfcRegistry(nullptr),
         lastUartAttractionUpdate(0),
+        pendingActuationMask(0),
+        forcedActuationMask(0),
+        suppressedActuationFrames(0),
+        batteryStorage(STORAGE_INITIAL_SOC),
+        hydroStorage(STORAGE_INITIAL_SOC),
         totalConsumption(0.0f),
-        lastConsumptionUpdate(0),
+        appliedTablesGeneration(0),
+        warmStartDirty(false),
+        warmStartBuildingGeneration(0),
+        warmGameActive(false),
+        warmRestoreTime(0),
+        serverStateConfirmed(false),
+        stateResponseOk(false),
+        libraryReportedState(false),
+        buildingSetGeneration(1),
+        pushedBuildingGeneration(0),
+        apiBuildingsGeneration(0),
+        uploadWindowClosedAt(0),
+        telemetryCutAt(0),
+        journalReplayed(0),
+        lastServerResponse(0),
+        serverFailingSince(0),
+        connectedPlants(MAX_SLAVE_TYPE),
+        connectedConsumers(MAX_CONNECTED_CONSUMERS),
+        lastReportedConsumerDrop(0),
         productionTotalDisplay(nullptr),
         consumptionTotalDisplay(nullptr),
     lastRetranslationPing(0),
     lastPingRequest(0),
     retranslationConnected(false),
     displayBlinkState(false),
-    lastBlinkToggle(0),
+    powerTraceDue(false),
+        pollResponse(),
         lastRequestTime(0),
-        productionRangesRequestInFlight(false),
-        productionCoefficientsRequestInFlight(false),
-        rangesRequestStartTime(0),
-        coefficientsRequestStartTime(0),
+        pollStageStartTime(0),
+        lastRangesFetch(0),
+        rangesRefreshDue(true),
+        rangesFingerprint(0),
+        coefficientsFingerprint(0),
+        pollCycles(0),
+        pollRequests(0),
+        pollUnchanged(0),
+        pollCycleChanged(false),
+        pollCadence(STATE_POLL_MIN_MS, STATE_POLL_BASE_MS, STATE_POLL_MAX_ACTIVE_MS, STATE_POLL_STEP_MS,
+                    STATE_POLL_IDLE_MS, STATE_POLL_BURST_MS),
+        pushSubscribed(false),
+        statePollRequested(false),
+        statusUploads(0),
         lastDebugTime(0),
     buildingsInitializedFromServer(false),
     lastGameActive(false) { // added init
@@ -174,47 +352,69 @@ private:
         for (auto& plant : powerPlants) {
             plant = PowerPlant();
         }
+        lastEncoderValues.fill(-1);
+        lastActuationTime.fill(0);
+        actuationEventMicros.fill(0);
+        lastActuationCommand.fill(0);
+        memset(actuationLevels.data(), 0, sizeof(actuationLevels));
+        memset(&uploadWindow, 0, sizeof(uploadWindow));
+        serverUrl[0] = '\0';
+        buildingTypeCounts.fill(0);
+        consumptionByBuildingType.fill(0.0f);
+        productionCoefficientByType.fill(0.0f);
+        productionCoefficientMask = 0;
+        memset(&serverTablesSnapshot, 0, sizeof(serverTablesSnapshot));
+        configureUartDebounce();
     }
 
 public:
-    // ESP-API integration and initialization
-    bool initEspApi(const char* serverUrl, const char* boardName, const char* username, const char* password) {
-        if (espApi) {
-            delete espApi;
-        }
-        
+    // ESP-API integration, first half: build an instance and log it in. Runs on the server
+    // boot stage task, so it touches nothing in GameManager; the caller hands the instance to
+    // adoptEspApi() on the loop task. nullptr if login or registration failed.
+    static ESPGameAPI* connectEspApi(const char* serverUrl, const char* boardName, const char* username,
+                                     const char* password) {
         // Configure AsyncRequest with 2 workers for better throughput (can be increased if needed)
         AsyncRequest::configure(2, true);  // 2 workers, allow insecure TLS
-        
-        espApi = new ESPGameAPI(serverUrl, boardName, BOARD_GENERIC, API_UPDATE_INTERVAL_MS, COEFFICIENT_POLL_INTERVAL_MS);
-        
-        // Set up callbacks
-        espApi->setProductionCallback([this]() { return getTotalProduction(); });
-        espApi->setConsumptionCallback([this]() { return getTotalConsumption(); });
-        espApi->setPowerPlantsCallback([this]() { return getConnectedPowerPlants(); });
-        espApi->setConsumersCallback([this]() { return getConnectedConsumers(); });
-        espApi->setBuildingsCallback([this](const std::vector<ConnectedBuilding>& buildings) {
-            restoreConnectedBuildings(buildings);
-        });
-        
+        ESPGameAPI* api = new ESPGameAPI(serverUrl, boardName, BOARD_GENERIC, API_UPDATE_INTERVAL_MS, COEFFICIENT_POLL_INTERVAL_MS);
         
         // Login and register
-        if (espApi->login(username, password) && espApi->registerBoard()) {
-            espApi->printStatus();
-            
-            // Request initial production ranges and coefficients
-            Serial.println("[GameManager] Requesting initial production ranges and coefficients...");
-            requestProductionRanges();
-            requestProductionCoefficients();
-            
-            // Initialize throttling timer
-            unsigned long now = millis();
-            lastRequestTime = now;
-            return true; // Success
-        } else {
+        if (!(api->login(username, password) && api->registerBoard())) {
             Serial.println("[GameManager] ESP-API login or registration failed");
-            return false; // Failed
+            delete api;
+            return nullptr;
+        }
+        api->printStatus();
+        return api;
+    }
+
+    // Second half, on the loop task (same task as update() / updateEspApi()): wire the
+    // callbacks, take ownership of the logged-in instance and request the initial state
+    void adoptEspApi(ESPGameAPI* api, const char* serverUrl) {
+        api->setProductionCallback([this]() { return getUploadWindow().production.mean; });
+        api->setConsumptionCallback([this]() { return getUploadWindow().consumption.mean; });
+        api->setPowerPlantsCallback([this]() { return getConnectedPowerPlants(); });
+        api->setConsumersCallback([this]() { return getConnectedConsumers(); });
+        api->setBuildingsCallback([this](const std::vector<ConnectedBuilding>& buildings) {
+            restoreConnectedBuildings(buildings);
+        });
+
+        if (espApi) {
+            delete espApi;
         }
+        strncpy(this->serverUrl, serverUrl, sizeof(this->serverUrl) - 1);
+        this->serverUrl[sizeof(this->serverUrl) - 1] = '\0';
+        pushedBuildingGeneration = buildingSetGeneration - 1; // new API instance needs the current set
+        pollHandoff.reset();                                   // callbacks of the old instance are gone
+        rangesFingerprint = 0;
+        coefficientsFingerprint = 0;
+        stateResponseOk = false;
+        libraryReportedState = false;
+        espApi = api;
+
+        // Request initial production ranges and coefficients
+        Serial.println("[GameManager] Requesting initial production ranges and coefficients...");
+        rangesRefreshDue = true;
+        startStatePoll(millis());
     }
     
     // Destructor to clean up ESP-API
@@ -224,193 +424,311 @@ public:
         }
     }
     
-    // Update coefficients and ranges from game server
+    // Publish production ranges from the game server (API callback context). The new table is
+    // built in the spare buffer; readers keep using the previous one until the swap, so a type
+    // never reads as disabled in between.
     void updateCoefficientsFromGame() {
         if (!espApi) return;
-        
-        // First, reset all power plants to (0,0) - disabled by default
-        for (size_t i = 0; i < powerPlantCount; i++) {
-            powerPlants[i].minWatts = 0.0f;
-            powerPlants[i].maxWatts = 0.0f;
-        }
-        
-        // Update production ranges (these are now pre-multiplied by the server)
-        // Only power plants that receive ranges from server will be enabled
-        for (const auto &r : espApi->getProductionRanges()) {
-            for (size_t i = 0; i < powerPlantCount; i++) {
-                if (static_cast<uint8_t>(powerPlants[i].plantType) == r.source_id) {
-                    /*Serial.printf("🔄 Updated power plant type %u ranges: %.1fW - %.1fW\n", 
-                                  static_cast<uint8_t>(powerPlants[i].plantType), r.min_power, r.max_power);*/
-                    powerPlants[i].minWatts = r.min_power;
-                    powerPlants[i].maxWatts = r.max_power;
-                    break; // Found the matching plant, no need to continue
+        const auto& ranges = espApi->getProductionRanges();
+        serverTables.publish([&ranges](ServerTables& tables) {
+            // Ranges are pre-multiplied by the server; types without a range stay disabled (0,0)
+            tables.rangeMask = 0;
+            memset(tables.minWatts, 0, sizeof(tables.minWatts));
+            memset(tables.maxWatts, 0, sizeof(tables.maxWatts));
+            for (const auto& r : ranges) {
+                if (r.source_id >= ServerTables::TYPE_SLOTS) {
+                    tables.rejectedIds++;
+                    continue;
                 }
+                tables.minWatts[r.source_id] = r.min_power;
+                tables.maxWatts[r.source_id] = r.max_power;
+                tables.rangeMask |= static_cast<uint16_t>(1u << r.source_id);
             }
-        }
-        
-        // Log any power plants that remain disabled (0,0)
+        });
+    }
+
+    // Publish production and consumption coefficients (API callback context)
+    void publishServerCoefficients() {
+        if (!espApi) return;
+        const auto& production = espApi->getProductionCoefficients();
+        const auto& consumption = espApi->getConsumptionCoefficients();
+        serverTables.publish([&production, &consumption](ServerTables& tables) {
+            tables.coefficientMask = 0;
+            memset(tables.productionCoefficient, 0, sizeof(tables.productionCoefficient));
+            for (const auto& coeff : production) {
+                if (coeff.source_id >= ServerTables::TYPE_SLOTS) {
+                    tables.rejectedIds++;
+                    continue;
+                }
+                tables.productionCoefficient[coeff.source_id] = coeff.coefficient;
+                tables.coefficientMask |= static_cast<uint16_t>(1u << coeff.source_id);
+            }
+            memset(tables.consumption, 0, sizeof(tables.consumption));
+            for (const auto& coeff : consumption) {
+                const size_t buildingType = coeff.building_id;
+                if (buildingType >= ServerTables::BUILDING_TYPE_SLOTS) {
+                    tables.rejectedIds++;
+                    continue;
+                }
+                tables.consumption[buildingType] = coeff.consumption;
+            }
+        });
+    }
+
+    // Mirror a newly published generation into the plants and lookup arrays (loop context):
+    // one atomic load when nothing changed, O(types) otherwise. Changed types are actuated.
+    void applyServerTables() {
+        if (serverTables.getGeneration() == appliedTablesGeneration) return;
+        ServerTables& tables = serverTablesSnapshot;
+        serverTables.read(tables);
+        appliedTablesGeneration = tables.generation;
+
         for (size_t i = 0; i < powerPlantCount; i++) {
-            if (powerPlants[i].minWatts == 0.0f && powerPlants[i].maxWatts == 0.0f) {
-                /*Serial.printf("⚠️  Power plant type %u disabled - no ranges from server\n", 
-                              static_cast<uint8_t>(powerPlants[i].plantType));*/
+            auto& plant = powerPlants[i];
+            const uint8_t type = static_cast<uint8_t>(plant.plantType);
+            const bool hasRange = type < ServerTables::TYPE_SLOTS && (tables.rangeMask & (1u << type));
+            const float minWatts = hasRange ? tables.minWatts[type] : 0.0f;
+            const float maxWatts = hasRange ? tables.maxWatts[type] : 0.0f;
+            if (plant.minWatts != minWatts || plant.maxWatts != maxWatts) {
+                plant.minWatts = minWatts;
+                plant.maxWatts = maxWatts;
+                raiseActuationEvent(type);
             }
         }
+
+        for (uint8_t type = 0; type <= MAX_SLAVE_TYPE; type++) {
+            const uint16_t bit = static_cast<uint16_t>(1u << type);
+            if ((productionCoefficientMask ^ tables.coefficientMask) & bit) {
+                productionCoefficientMask ^= bit;
+                raiseActuationEvent(type); // coefficient appeared or went away
+            }
+            if (productionCoefficientByType[type] != tables.productionCoefficient[type]) {
+                productionCoefficientByType[type] = tables.productionCoefficient[type];
+                raiseActuationEvent(type); // coefficient-driven attractions (wind, solar)
+            }
+        }
+
+        if (memcmp(consumptionByBuildingType.data(), tables.consumption, sizeof(tables.consumption)) != 0) {
+            memcpy(consumptionByBuildingType.data(), tables.consumption, sizeof(tables.consumption));
+            recomputeTotalConsumption();
+        }
+        warmStartDirty = true;
     }
-    
-    // Update consumption from connected buildings
-    void updateConsumptionFromBuildings() {
-        if (!nfcRegistry || !espApi) return;
-        
+
+    // Generation of the published server tables; changes whenever ranges / coefficients change
+    uint32_t getServerTablesGeneration() const { return serverTables.getGeneration(); }
+
+    // Total = sum over building types of count * consumption: O(types)
+    void recomputeTotalConsumption() {
         float consumption = 0.0f;
-        
-        // Get consumption coefficients from server
-        const auto& consumptionCoeffs = espApi->getConsumptionCoefficients();
-        
-        // Get all connected buildings from NFC registry
-        auto connectedBuildings = nfcRegistry->getAllBuildings();
-        
-        // Calculate total consumption based on connected buildings
-        for (const auto& building : connectedBuildings) {
-            uint8_t buildingType = building.second.buildingType;
-            
-            // Find consumption for this building type
-            for (const auto& coeff : consumptionCoeffs) {
-                if (coeff.building_id == buildingType) {
-                    consumption += coeff.consumption;
-                    break;
-                }
+        for (size_t type = 0; type < BUILDING_TYPE_SLOTS; type++) {
+            if (buildingTypeCounts[type]) {
+                consumption += buildingTypeCounts[type] * consumptionByBuildingType[type];
             }
         }
-        
         totalConsumption = consumption;
-        lastConsumptionUpdate = millis();
     }
-    
-    // Check if game is active
+
+    // Recount buildings per type and re-intern their UIDs from the registry (after bulk
+    // changes: restore / clear)
+    void rebuildBuildingCounts() {
+        buildingSetGeneration++;
+        std::array<uint16_t, BUILDING_TYPE_SLOTS> counts;
+        counts.fill(0);
+        if (nfcRegistry) {
+            buildingUids.clear();
+            for (const auto& building : nfcRegistry->getAllBuildings()) {
+                counts[building.second.buildingType]++;
+                buildingUids.intern(building.first.c_str(), building.first.size(), building.second.buildingType);
+            }
+        }
+        {
+            std::lock_guard<std::mutex> lock(telemetryMutex);
+            buildingTypeCounts = counts;
+        }
+        recomputeTotalConsumption();
+    }
+
+    // Number of buildings in the registry (sum of the per-type counts)
+    size_t getConnectedBuildingCount() const {
+        size_t total = 0;
+        for (size_t type = 0; type < BUILDING_TYPE_SLOTS; type++) total += buildingTypeCounts[type];
+        return total;
+    }
+
+    // True when the registry already holds this UID (interned lookup; registry scan only for
+    // UIDs the store cannot represent)
+    bool hasBuilding(const std::string& uid) const {
+        RawUid raw;
+        uint8_t format;
+        if (UidStore::parse(uid.c_str(), uid.size(), raw, format)) {
+            return buildingUids.find(raw) != UidStore::INVALID;
+        }
+        return nfcRegistry && nfcRegistry->getAllBuildings().count(uid) != 0;
+    }
+
+    // Check if game is active (restored warm-start state until the server has answered)
     bool isGameActive() const {
-        return espApi ? espApi->isGameActive() : false;
+        if (espApi && serverStateConfirmed) return espApi->isGameActive();
+        return warmGameActive;
     }
     
     // Update ESP-API (call this in main loop)
     bool updateEspApi() {
-        if (espApi) {
-            // Set connected buildings for sending
-            if (nfcRegistry) {
-                auto buildings = nfcRegistry->getAllBuildings();
-                std::vector<ConnectedBuilding> connectedBuildings;
-                for (const auto& pair : buildings) {
-                    connectedBuildings.push_back({pair.second.uid, pair.second.buildingType});
-                }
-                espApi->setConnectedBuildings(connectedBuildings);
-            }
-        }
-        
+        // Connected buildings are pushed from update() whenever the building set changes.
+        // An update() that asked for the upload lists carried a status exchange: time it.
+        const uint32_t uploadsBefore = statusUploads.load();
+        const unsigned long exchangeStart = millis();
         bool result = espApi ? espApi->update() : false;
+        if (espApi && statusUploads.load() != uploadsBefore) {
+            requestStats.begin(RequestStats::ENDPOINT_STATUS, exchangeStart);
+            requestStats.complete(RequestStats::ENDPOINT_STATUS, millis(), result, "update() failed");
+        }
+
+        // Supersede the warm-start game state only after a state request succeeded and the
+        // library has reported game state; before that espApi->isGameActive() is its default
+        // and would read as a game end
+        if (result) {
+            libraryReportedState = true;
+            noteServerResponse(true, millis());
+        } else if (espApi) {
+            noteServerResponse(false, millis());
+        }
+        if (espApi && pollHandoff.stage() == POLL_ANSWERED) applyPollResponse();
+        if (!serverStateConfirmed && libraryReportedState && stateResponseOk) {
+            serverStateConfirmed = true;
+            Serial.println("[WARM] Server game state confirmed, restored state superseded");
+        }
 
         // Detect game end (transition active -> inactive) and clear building state
         bool currentActive = isGameActive();
         if (lastGameActive && !currentActive) {
             Serial.println("[GameManager] Scenario ended -> clearing buildings");
             clearAllBuildingsOnGameEnd();
+            batteryStorage.reset();
+            hydroStorage.reset();
+        }
+        if (lastGameActive != currentActive) {
+            warmStartDirty = true;
+            rangesRefreshDue = true;  // a new scenario brings new ranges
+            statePollRequested = true;
         }
         lastGameActive = currentActive;
+        pollCadence.setGameActive(currentActive, millis());
         
-        // If connected, request production ranges and coefficients
-        // But throttle the requests to avoid spamming the server
-        if (result && espApi) {
+        // Run the state poll: one request in flight, cycles paced by pollCadence. A lost request
+        // is given up on whatever update() returned; a new cycle only starts while connected.
+        if (espApi) {
             unsigned long now = millis();
             
             // Debug output every 5 seconds
             if (now - lastDebugTime >= 5000) {
-                Serial.printf("[GameManager] API Status - Ranges: %s, Coefficients: %s\n", 
-                    productionRangesRequestInFlight ? "IN_FLIGHT" : "IDLE",
-                    productionCoefficientsRequestInFlight ? "IN_FLIGHT" : "IDLE");
-                
-                if (productionRangesRequestInFlight && rangesRequestStartTime > 0) {
-                    Serial.printf("[GameManager] Ranges request duration: %lu ms\n", now - rangesRequestStartTime);
-                }
-                if (productionCoefficientsRequestInFlight && coefficientsRequestStartTime > 0) {
-                    Serial.printf("[GameManager] Coefficients request duration: %lu ms\n", now - coefficientsRequestStartTime);
+                static const char* const stageNames[] = { "IDLE", "RANGES", "COEFFICIENTS", "RECEIVING", "ANSWERED" };
+                const uint8_t stage = pollHandoff.stage();
+                Serial.printf("[GameManager] API Status - Poll: %s, every %lu ms%s, cycles: %lu, requests: %lu, unchanged: %lu\n",
+                    stageNames[stage], (unsigned long)statePollIntervalMs(now),
+                    pushSubscribed ? " (push)" : (pollCadence.isBursting() ? " (burst)" : ""), (unsigned long)pollCycles,
+                    (unsigned long)pollRequests, (unsigned long)pollUnchanged);
+                if (stage == POLL_RANGES || stage == POLL_COEFFICIENTS) {
+                    Serial.printf("[GameManager] Poll request duration: %lu ms\n", now - pollStageStartTime);
                 }
                 lastDebugTime = now;
             }
-            
-            // Request both ranges and coefficients every 3 seconds, but only if not already in flight
-            if (now - lastRequestTime >= REQUEST_INTERVAL_MS) {
-                bool anyRequestSent = false;
-                
-                if (!productionRangesRequestInFlight) {
-                    requestProductionRanges();
-                    anyRequestSent = true;
-                }
-                
-                if (!productionCoefficientsRequestInFlight) {
-                    requestProductionCoefficients();
-                    anyRequestSent = true;
-                }
-                
-                // Only update the timer if we actually sent a request
-                if (anyRequestSent) {
-                    lastRequestTime = now;
-                }
+
+            if (!expireLostPoll(now) && result && pollHandoff.stage() == POLL_IDLE &&
+                (statePollRequested || now - lastRequestTime >= statePollIntervalMs(now))) {
+                statePollRequested = false;
+                startStatePoll(now);
             }
         }
         
         return result;
     }
-    
-    // Request production ranges from server
-    void requestProductionRanges() {
-        if (!espApi || productionRangesRequestInFlight) return;
-        
-        productionRangesRequestInFlight = true;
-        rangesRequestStartTime = millis();
-        Serial.println("[GameManager] 🚀 Starting production ranges request...");
-        
-        espApi->getProductionRanges([this](bool success, const std::vector<ProductionRange>& ranges, const std::string& error) {
-            unsigned long duration = millis() - rangesRequestStartTime;
-            productionRangesRequestInFlight = false;  // Reset flag when done
-            
-            if (success) {
-                Serial.printf("[GameManager] ✅ Production ranges received in %lu ms\n", duration);
-                static unsigned long lastLogTime = 0;
-                if (millis() - lastLogTime > 10000) { // Log only every 10 seconds
-                    Serial.println("📊 Production ranges received from server");
-                    lastLogTime = millis();
-                }
-                updateCoefficientsFromGame(); // This will update both coefficients and ranges
-            } else {
-                Serial.printf("[GameManager] ❌ Production ranges failed after %lu ms: %s\n", duration, error.c_str());
+
+    // WiFi is down (updateEspApi() is not called): the server counts as failing from now on,
+    // so the outage is journaled, and a request in flight still times out
+    void onWifiDown(unsigned long now) {
+        noteServerResponse(false, now);
+        if (espApi) expireLostPoll(now);
+    }
+
+    // Give up on a state poll request without an answer after POLL_TIMEOUT_MS
+    bool expireLostPoll(unsigned long now) {
+        uint8_t stage;
+        if (!pollHandoff.inFlight() || now - pollStageStartTime < POLL_TIMEOUT_MS || !pollHandoff.abandon(stage)) {
+            return false;
+        }
+        Serial.printf("[GameManager] ⚠️ State poll got no response in %lu ms, restarting\n", now - pollStageStartTime);
+        if (stage == POLL_RANGES) rangesRefreshDue = true;
+        requestStats.lost(stage == POLL_RANGES ? RequestStats::ENDPOINT_RANGES : RequestStats::ENDPOINT_COEFFICIENTS, now);
+        noteServerResponse(false, now);
+        pollCadence.onCycle(false);
+        return true;
+    }
+
+    // Journal backfill step for the upload task (see journal_upload.h): once the server answers
+    // again, hand the oldest journaled records to sink; the live windows keep going out through
+    // the library meanwhile. Returns the records delivered, 0 if none are due, -1 on failure.
+    template <typename Sink>
+    int replayJournal(Sink& sink, unsigned long now) {
+        if (lastServerResponse.load() == 0 || serverFailingSince.load() != 0) return 0; // answering again
+        const int delivered = replayJournalBatch<JOURNAL_UPLOAD_BATCH>(telemetryJournal, telemetryMutex, sink, now);
+        if (delivered > 0) {
+            std::lock_guard<std::mutex> lock(telemetryMutex);
+            journalReplayed += delivered;
+            if (telemetryJournal.empty()) {
+                Serial.printf("[JOURNAL] Caught up: %lu records replayed, %lu dropped\n",
+                              (unsigned long)journalReplayed, (unsigned long)telemetryJournal.getDropped());
+                journalReplayed = 0;
             }
-        });
+        }
+        return delivered;
     }
 
-    // Request production coefficients from server
-    void requestProductionCoefficients() {
-        if (!espApi || productionCoefficientsRequestInFlight) return;
-        
-        productionCoefficientsRequestInFlight = true;
-        coefficientsRequestStartTime = millis();
-        Serial.println("[GameManager] 🚀 Starting production coefficients request...");
-        
-        espApi->pollCoefficients([this](bool success, const std::string& error) {
-            unsigned long duration = millis() - coefficientsRequestStartTime;
-            productionCoefficientsRequestInFlight = false;  // Reset flag when done
-            
-            if (success) {
-                Serial.printf("[GameManager] ✅ Production coefficients received in %lu ms\n", duration);
-                static unsigned long lastLogTime = 0;
-                if (millis() - lastLogTime > 10000) { // Log only every 10 seconds
-                    Serial.println("📊 Production coefficients received from server");
-                    lastLogTime = millis();
-                }
-                // Coefficients are automatically stored in espApi and can be accessed via getProductionCoefficients()
+    // Begin one poll cycle (no-op while a cycle is still running)
+    void startStatePoll(unsigned long now);
+
+    // Feed server-push state in before updateEspApi(): ServerEvents invalidation bits and
+    // whether the stream is up. An invalidation runs a poll cycle at once; "game" and
+    // "buildings" themselves arrive with the library's status exchange every
+    // API_UPDATE_INTERVAL_MS, a new scenario only needs its ranges fetched. The stream says
+    // nothing about API reachability (a proxy can hold it open while the API fails): that
+    // stays with the status exchange and the polls, which keep running.
+    void onServerPush(uint8_t invalidations, bool subscribed) {
+        if (subscribed != pushSubscribed) {
+            if (subscribed) {
+                Serial.printf("[GameManager] Server push up, state poll every %lu ms as a fallback\n",
+                              (unsigned long)SERVER_EVENTS_FALLBACK_POLL_MS);
             } else {
-                Serial.printf("[GameManager] ❌ Production coefficients failed after %lu ms: %s\n", duration, error.c_str());
+                Serial.println("[GameManager] Server push down, adaptive state poll again");
             }
-        });
+            pushSubscribed = subscribed;
+        }
+        if (invalidations & (ServerEvents::INVALIDATE_RANGES | ServerEvents::INVALIDATE_GAME)) rangesRefreshDue = true;
+        if (invalidations & (ServerEvents::INVALIDATE_RANGES | ServerEvents::INVALIDATE_COEFFICIENTS |
+                             ServerEvents::INVALIDATE_GAME)) {
+            statePollRequested = true;
+        }
     }
 
+    // Pause between poll cycles: slow fallback while pushes arrive, adaptive otherwise
+    uint32_t statePollIntervalMs(unsigned long now) {
+        return pushSubscribed ? SERVER_EVENTS_FALLBACK_POLL_MS : pollCadence.intervalMs(now);
+    }
+
+    // Request production ranges from server (first stage of a poll cycle)
+    void requestProductionRanges();
+
+    // Request production coefficients from server (last stage of a poll cycle)
+    void requestProductionCoefficients();
+
+    // Callback side of the poll hand-off (AsyncRequest worker): fill and publish pollResponse
+    // after pollHandoff.claim(ticket) succeeded
+    void answerPoll(PollHandoff::Ticket ticket, RequestStats::Endpoint endpoint, bool success, bool changed,
+                    const std::string& error);
+    // Loop side: count the answer, advance the cycle, send coefficients after ranges
+    void applyPollResponse();
+
     // Delete copy/move constructors and assignment operators
     GameManager(const GameManager&) = delete;
     GameManager& operator=(const GameManager&) = delete;
@@ -427,7 +745,7 @@ public:
     // This doesn't add actual power plants - those are tracked via UART
     // Returns index or -1 if full
     int registerPowerPlantTypeControl(PowerPlantType plantType,
-                                      Encoder* encoder, SegmentDisplay* powerDisplay, Bargraph* powerBargraph) {
+                                      EncoderInput* encoder, SegmentDisplay* powerDisplay, Bargraph* powerBargraph) {
         if (powerPlantCount >= MAX_POWER_PLANTS) {
             return -1; // Array is full
         }
@@ -457,14 +775,21 @@ public:
 
     // Update game state from hardware
     void update() {
-        // Update power plants
-        nfcRegistry->scanForCards();
+        // Pick up ranges / coefficients published by the API callbacks
+        applyServerTables();
+
+        // Update power plants (the NFC reader is polled by its own scheduler job)
         for (size_t i = 0; i < powerPlantCount; i++) {
             auto& plant = powerPlants[i];
             
             if (plant.encoder) {
                 // Regulable source: read encoder value and convert to percentage
-                float newPercentage = plant.encoder->getValue() / 1000.0f;
+                long rawValue = plant.encoder->getValue();
+                if (rawValue != lastEncoderValues[i]) {
+                    lastEncoderValues[i] = rawValue;
+                    raiseActuationEvent(static_cast<uint8_t>(plant.plantType));
+                }
+                float newPercentage = rawValue / 1000.0f;
                 plant.powerPercentage = newPercentage;
                 
                 // For HYDRO_STORAGE sharing encoder with BATTERY, copy the same percentage
@@ -495,20 +820,31 @@ public:
             plant.powerSetting = computePowerPerPlant(plant);
         }
         
-        // Update consumption every 2 seconds
-        if (millis() - lastConsumptionUpdate >= 2000) {
-            updateConsumptionFromBuildings();
-        }
-        
-        // Update connected buildings in ESP-API
-        if (espApi) {
+        // Integrate the storage state of charge from the power settings just computed
+        updateStorage(millis());
+        sampleTelemetry(millis());
+
+        // Push connected buildings to ESP-API only when the building set changed
+        if (espApi && pushedBuildingGeneration != buildingSetGeneration) {
             espApi->setConnectedBuildings(getConnectedBuildingsForAPI());
+            pushedBuildingGeneration = buildingSetGeneration;
         }
         
         // Update attraction states based on power percentages
         updateAttractionStates();
+
+        // Expire the restored game state if the server never answers, then persist changes
+        if (warmGameActive && !serverStateConfirmed && millis() - warmRestoreTime >= WARM_START_TRUST_MS) {
+            warmGameActive = false;
+            Serial.println("[WARM] No server answer, restored game state expired");
+        }
+        persistWarmStartIfDue();
     }
 
+    // Load the last-known state from NVS; call after the power plant controls are registered
+    // and before WiFi comes up. Returns false on a cold start (no / invalid record).
+    bool restoreWarmStart();
+
     // Method for IO task to update displays
     static void updateDisplays() {
         getInstance().updateDisplaysImpl();
@@ -522,17 +858,12 @@ public:
 
     // Setters for game coefficients (called from API callbacks)
     
-    // Get production coefficient for a specific plant type
+    // Get production coefficient for a specific plant type (0 if none was received)
     float getProductionCoefficientForType(uint8_t plantType) const {
-        if (!espApi) return 0.0f;
-        
-        const auto& productionCoeffs = espApi->getProductionCoefficients();
-        for (const auto& coeff : productionCoeffs) {
-            if (coeff.source_id == plantType) {
-                return coeff.coefficient;
-            }
-        }
-        return 0.0f; // No coefficient found for this type
+        return plantType <= MAX_SLAVE_TYPE ? productionCoefficientByType[plantType] : 0.0f;
+    }
+    bool hasProductionCoefficientForType(uint8_t plantType) const {
+        return plantType <= MAX_SLAVE_TYPE && (productionCoefficientMask & (1u << plantType));
     }
     
     // Getters for specific plants by type
@@ -582,9 +913,51 @@ public:
     // Initialize NFC Building Registry
     void initNfcRegistry(NFCBuildingRegistry* registry) {
         nfcRegistry = registry;
+        // Bring back buildings from the warm-start record; the first server snapshot replaces them
+        if (buildingUids.size() > 0 && !buildingsInitializedFromServer) {
+            auto current = nfcRegistry->getAllBuildings();
+            char text[UidStore::MAX_TEXT_LEN + 1];
+            for (UidHandle handle = 0; handle < UidStore::CAPACITY; handle++) {
+                if (!buildingUids.toText(handle, text, sizeof(text))) continue;
+                if (current.find(text) == current.end()) {
+                    nfcRegistry->addBuilding(text, buildingUids.getBuildingType(handle));
+                }
+            }
+            Serial.printf("[WARM] Restored %u buildings into NFC registry\n", buildingUids.size());
+        }
+        rebuildBuildingCounts(); // re-interns from the registry: it decides what survived
         Serial.println("[GameManager] NFC Building Registry initialized");
     }
 
+    // NFC registry events (forwarded from the registry callbacks): O(1) consumption update
+    void onBuildingAdded(uint8_t buildingType, const String& uid) {
+        buildingSetGeneration++;
+        if (buildingUids.intern(uid.c_str(), uid.length(), buildingType) == UidStore::INVALID) {
+            Serial.printf("[GameManager] UID %s not interned (API list falls back to registry)\n", uid.c_str());
+        }
+        {
+            std::lock_guard<std::mutex> lock(telemetryMutex);
+            buildingTypeCounts[buildingType]++;
+        }
+        totalConsumption = totalConsumption.load() + consumptionByBuildingType[buildingType];
+    }
+
+    void onBuildingRemoved(uint8_t buildingType, const String& uid) {
+        buildingSetGeneration++;
+        buildingUids.release(buildingUids.find(uid.c_str(), uid.length()));
+        if (buildingTypeCounts[buildingType] == 0) return;
+        {
+            std::lock_guard<std::mutex> lock(telemetryMutex);
+            buildingTypeCounts[buildingType]--;
+        }
+        if (buildingTypeCounts[buildingType] == 0 && totalConsumption.load() != 0.0f) {
+            // Re-sum to drop accumulated float error once a type empties out
+            recomputeTotalConsumption();
+        } else {
+            totalConsumption = totalConsumption.load() - consumptionByBuildingType[buildingType];
+        }
+    }
+
     // Restore connected buildings from server
     void restoreConnectedBuildings(const std::vector<ConnectedBuilding>& buildings) {
         if (!nfcRegistry) return;
@@ -600,16 +973,14 @@ public:
                               building.uid.c_str(), building.building_type);
             }
             buildingsInitializedFromServer = true;
+            rebuildBuildingCounts();
             return;
         }
         
         // Subsequent callbacks: merge only (do NOT clear). Avoid wiping freshly scanned local buildings
-        // Build a set of existing UIDs
-        auto current = nfcRegistry->getAllBuildings();
         size_t added = 0;
         for (const auto& building : buildings) {
-            bool exists = current.find(building.uid) != current.end();
-            if (!exists) {
+            if (!hasBuilding(building.uid)) {
                 nfcRegistry->addBuilding(building.uid, building.building_type);
                 Serial.printf("[GameManager] (merge) Added new server building UID:%s Type:%u\n", 
                               building.uid.c_str(), building.building_type);
@@ -618,21 +989,43 @@ public:
         }
         if (added == 0) {
             Serial.println("[GameManager] (merge) No new buildings from server; local scan preserved");
+        } else {
+            rebuildBuildingCounts();
         }
     }
 
-    // Get connected buildings with UIDs for sending to server
-    std::vector<ConnectedBuilding> getConnectedBuildingsForAPI() {
-        std::vector<ConnectedBuilding> buildings;
-        if (nfcRegistry) {
-            auto nfcBuildings = nfcRegistry->getAllBuildings();
-            for (const auto& pair : nfcBuildings) {
-                buildings.push_back({pair.second.uid, pair.second.buildingType});
+    // Get connected buildings with UIDs for sending to server (rebuilt only when the set changed)
+    const std::vector<ConnectedBuilding>& getConnectedBuildingsForAPI() {
+        if (apiBuildingsGeneration != buildingSetGeneration) {
+            if (!nfcRegistry) {
+                apiBuildings.clear();
+            } else if (buildingUids.size() == getConnectedBuildingCount()) {
+                // Format from the interned UIDs; existing strings keep their capacity
+                char text[UidStore::MAX_TEXT_LEN + 1];
+                size_t count = 0;
+                apiBuildings.resize(buildingUids.size());
+                for (UidHandle handle = 0; handle < UidStore::CAPACITY; handle++) {
+                    size_t length = buildingUids.toText(handle, text, sizeof(text));
+                    if (length == 0) continue;
+                    apiBuildings[count].uid.assign(text, length);
+                    apiBuildings[count].building_type = buildingUids.getBuildingType(handle);
+                    count++;
+                }
+            } else {
+                // Some UID could not be interned (unusual format or store full): copy the registry
+                apiBuildings.clear();
+                for (const auto& pair : nfcRegistry->getAllBuildings()) {
+                    apiBuildings.push_back({pair.second.uid, pair.second.buildingType});
+                }
             }
+            apiBuildingsGeneration = buildingSetGeneration;
         }
-        return buildings;
+        return apiBuildings;
     }
 
+    // Generation of the building set; changes on every add / remove / bulk update
+    uint32_t getBuildingSetGeneration() const { return buildingSetGeneration; }
+
     // Set total displays for production and consumption
     void setTotalDisplays(SegmentDisplay* productionDisplay, SegmentDisplay* consumptionDisplay) {
         productionTotalDisplay = productionDisplay;
@@ -644,6 +1037,10 @@ public:
     bool isRetranslationStationAlive() const { return retranslationConnected; }
     void onRetranslationPingReceived();
     void updateRetranslationStatus();
+
+    // Periodic hooks driven by the main loop scheduler
+    void toggleDisplayBlink() { displayBlinkState = !displayBlinkState; }
+    void requestPowerTrace() { powerTraceDue = true; }
     void requestRetranslationStatus();
 
     // Get count of power plants
@@ -654,33 +1051,71 @@ public:
         return powerPlants[index];
     }
 
-    // ESP-API callback helpers
+    // Feed the telemetry aggregators with the current totals (called from update())
+    void sampleTelemetry(unsigned long now);
+
+    // Window for the upload in progress: closes the running window unless one was closed
+    // within TELEMETRY_WINDOW_MIN_MS, so every callback of one upload reports the same window
+    TelemetryWindow getUploadWindow();
+
+
+    // Game side of a live-telemetry frame: power, settings, inventory, storage and link
+    // flags (the caller adds WiFi and loop timing). Instantaneous values, no logging.
+    void fillLiveTelemetry(TelemetrySnapshot& out, unsigned long now) const;
+
+    // Refill the telemetry lists; heap-free, O(types). Plants read the upload window, so the
+    // caller holds telemetryMutex.
+    void fillConnectedPowerPlants(UploadList<ConnectedPowerPlant>& out) const;
+    void fillConnectedConsumers(UploadList<ConnectedConsumer>& out) const;
+
+    // ESP-API callback helpers (library signature returns by value: one exact-size copy)
     std::vector<ConnectedPowerPlant> getConnectedPowerPlants();
     std::vector<ConnectedConsumer> getConnectedConsumers();
     
     // UART Powerplant management
     void updateUartPowerplants(const std::vector<UartSlaveInfo>& powerplants);
     void updateAttractionStates();
+    // Request an immediate (rate-limited) attraction evaluation for one slave type. The frame is
+    // only sent when the command changed, unless forceFrame (e.g. newly connected plants).
+    // Loop task only; API callbacks reach it through the server tables (applyServerTables()).
+    void raiseActuationEvent(uint8_t slaveType, bool forceFrame = false);
+    const LatencyHistogram& getActuationLatency() const { return actuationLatencyUs; }
+    const RequestStats& getRequestStats() const { return requestStats; }
+    const char* getServerUrl() const { return serverUrl; }
     float calculateTotalPowerForType(uint8_t slaveType) const;
+    // Current power of amount plants of a type, as calculateTotalPowerForType without logging
+    float currentPowerForType(uint8_t slaveType, uint8_t amount) const;
     // Compute power per plant with center snap for symmetric ranges
     float computePowerPerPlant(const PowerPlant& plant) const;
-    // Apply any pending decreases whose grace timeout expired
-    void applyPendingDecreases();
+    // Commit any staged amount changes whose grace deadline passed
+    void applyExpiredAmountChanges();
+    // State of charge integrator of a storage type (nullptr for other types)
+    StorageIntegrator* storageForType(uint8_t slaveType);
+    const StorageIntegrator* storageForType(uint8_t slaveType) const;
+    // Advance both storage integrators; raises actuation events when a storage hits a limit
+    // or its fill level moves. Constant time per call.
+    void updateStorage(unsigned long now);
     // Helper to validate recognized UART slave type (1..8) matching PowerPlantType enum values
     static inline bool isValidSlaveType(uint8_t t) { return t >= PHOTOVOLTAIC && t <= BATTERY; }
     // Purge any invalid entries from uartPowerplants
     void purgeInvalidUartPowerplants();
 
 private:
-    // Per-type periodic update hooks (called from updateAttractionStates)
-    void updatePhotovoltaic(uint8_t slaveType, const PowerPlant& plant);
-    void updateWind(uint8_t slaveType, const PowerPlant& plant);
-    void updateNuclear(uint8_t slaveType, const PowerPlant& plant);
-    void updateGas(uint8_t slaveType, const PowerPlant& plant);
-    void updateHydro(uint8_t slaveType, const PowerPlant& plant);
-    void updateHydroStorage(uint8_t slaveType, const PowerPlant& plant);
-    void updateCoal(uint8_t slaveType, const PowerPlant& plant);
-    void updateBattery(uint8_t slaveType, const PowerPlant& plant);
+    // Load per-type grace periods into uartDebouncer
+    void configureUartDebounce();
+    // Feed one reported amount through the debouncer and apply the result
+    void observeUartAmount(uint8_t slaveType, uint8_t amount, unsigned long now);
+    // Write a committed amount into uartPowerplants
+    void setUartAmount(uint8_t slaveType, uint8_t amount);
+
+    // Snapshot persisted state into a warm-start record / save it when dirty and allowed
+    void captureWarmStart(WarmStartState& state);
+    void persistWarmStartIfDue();
+
+    // Evaluate the ActuationPolicy for one slave type and send its command. With sendAlways
+    // false the frame is skipped when the command did not change. Returns true while a level
+    // change is waiting for the policy's minimum dwell time.
+    bool emitAttractionForType(uint8_t slaveType, unsigned long now, bool sendAlways);
 
     // Debug output (instance implementation)
     void printDebugInfoImpl() {
@@ -688,6 +1123,37 @@ private:
         Serial.printf("[PLANTS] Total: %.1fW | Consumption: %.1fW | Game %s | Local: %zu | UART Types: %zu\n",
                       getTotalProduction(), getTotalConsumption(), gameActive ? "ON" : "OFF", 
                       powerPlantCount, uartPowerplants.size());
+        {
+            std::lock_guard<std::mutex> lock(telemetryMutex);
+            if (uploadWindow.sequence > 0) {
+                const WindowStats& p = uploadWindow.production;
+                Serial.printf("[TELEMETRY] Window #%lu %lums n=%lu production min/mean/max %.1f/%.1f/%.1fW %.4fWh"
+                              " consumption mean %.1fW\n",
+                              (unsigned long)uploadWindow.sequence, (unsigned long)p.durationMs, (unsigned long)p.samples,
+                              p.min, p.mean, p.max, p.energyWh, uploadWindow.consumption.mean);
+            }
+            if (!telemetryJournal.empty()) {
+                Serial.printf("[JOURNAL] %u/%u records waiting, %lu dropped\n", telemetryJournal.size(),
+                              telemetryJournal.capacity(), (unsigned long)telemetryJournal.getDropped());
+            }
+            if (connectedPlants.getDropped() || connectedConsumers.getDropped()) {
+                Serial.printf("[UPLOAD] Entries past the list limits: plants %lu, consumers %lu (last upload %lu)\n",
+                              (unsigned long)connectedPlants.getDropped(),
+                              (unsigned long)connectedConsumers.getDropped(),
+                              (unsigned long)connectedConsumers.getFillDropped());
+            }
+        }
+        requestStats.printSummary();
+        if (actuationLatencyUs.getCount() > 0) {
+            Serial.printf("[ACTUATION] Event->frame latency n=%lu p50=%.1fms p99=%.1fms max=%.1fms\n",
+                          (unsigned long)actuationLatencyUs.getCount(),
+                          actuationLatencyUs.percentile(50) / 1000.0f,
+                          actuationLatencyUs.percentile(99) / 1000.0f,
+                          actuationLatencyUs.getMax() / 1000.0f);
+        }
+        if (suppressedActuationFrames) {
+            Serial.printf("[ACTUATION] Unchanged event frames skipped: %lu\n", (unsigned long)suppressedActuationFrames);
+        }
         
         // Print local encoder-controlled power plant types
         for (size_t i = 0; i < powerPlantCount; i++) {
@@ -717,19 +1183,28 @@ private:
                 powerPerPlant = computePowerPerPlant(plant);
             }
             
-            Serial.printf("  [%zu] Type:%u %.0f%% → %.1fW×%u = %.1fW (%.1f-%.1fW) %s\n",
-                          i, static_cast<uint8_t>(plant.plantType), plant.powerPercentage.load() * 100,
+            uint8_t typeId = static_cast<uint8_t>(plant.plantType);
+            const auto& levelState = actuationLevels[typeId <= MAX_SLAVE_TYPE ? typeId : 0];
+            Serial.printf("  [%zu] Type:%u %.0f%% → %.1fW×%u = %.1fW (%.1f-%.1fW) %s flaps:%u lvl:%u tr:%lu hold:%lu\n",
+                          i, typeId, plant.powerPercentage.load() * 100,
                           powerPerPlant, uartCount, totalForType,
-                          plant.minWatts, plant.maxWatts, status);
+                          plant.minWatts, plant.maxWatts, status,
+                          uartDebouncer.getFlapCount(typeId), levelState.level,
+                          (unsigned long)levelState.transitions, (unsigned long)levelState.dwellHolds);
+            if (const StorageIntegrator* storage = storageForType(typeId)) {
+                Serial.printf("      SoC:%.1f%% %.2f/%.2fWh\n", storage->getSoc() * 100.0f,
+                              storage->getEnergyWh(), storage->getCapacityWh());
+            }
         }
         
         // Print connected buildings info
         if (nfcRegistry) {
-            auto buildings = nfcRegistry->getAllBuildings();
-            Serial.printf("[BUILDINGS] Connected: %zu\n", buildings.size());
-            for (const auto& building : buildings) {
-                Serial.printf("  UID:%s Type:%u\n", 
-                             building.second.uid.c_str(), building.second.buildingType);
+            Serial.printf("[BUILDINGS] Connected: %zu (interned %u, rejected %lu)\n", getConnectedBuildingCount(),
+                          buildingUids.size(), (unsigned long)buildingUids.getRejectedCount());
+            char text[UidStore::MAX_TEXT_LEN + 1];
+            for (UidHandle handle = 0; handle < UidStore::CAPACITY; handle++) {
+                if (!buildingUids.toText(handle, text, sizeof(text))) continue;
+                Serial.printf("  #%u UID:%s Type:%u\n", handle, text, buildingUids.getBuildingType(handle));
             }
         }
     }
@@ -760,6 +1235,13 @@ private:
             }
             Serial.printf("  %s (ID:%u): %.3f\n", typeName, coeff.source_id, coeff.coefficient);
         }
+        if (serverTablesSnapshot.rejectedIds) {
+            Serial.printf("[COEFFICIENTS] Server entries skipped (id out of range): %lu\n",
+                          (unsigned long)serverTablesSnapshot.rejectedIds);
+        }
+        Serial.printf("[WARM] NVS record %zu bytes, writes: %lu, unchanged skips: %lu\n",
+                      warmStart.getLastRecordSize(), (unsigned long)warmStart.getWriteCount(),
+                      (unsigned long)warmStart.getUnchangedCount());
         
         // Print power production for each type
         Serial.println("[POWER] Current power production:");
@@ -806,6 +1288,7 @@ public:
             nfcRegistry->clearDatabase();
             Serial.println("[GameManager] Cleared building database on game end");
         }
+        rebuildBuildingCounts();
         buildingsInitializedFromServer = false;
     }
 };
@@ -0,0 +1,202 @@
+#pragma once
+#include <stdint.h>
+#include <float.h>
+#include "power_plant_config.h"
+#include "uart_protocol_constants.h"
+
+// Compile-time actuation policies for UART attractions.
+//
+// Each slave type is described by data only: which input drives it, the ascending
+// thresholds that split the input into levels and the command sent for every level.
+// A single kernel (evaluate) turns the inputs into a 4-bit command for any type, so a new
+// plant type is a new table row. Every row also carries a hysteresis band and a minimum
+// dwell time; the stateful evaluate() overload applies them through one shared quantizer
+// so inputs sitting on a threshold do not bounce the command. The header has no Arduino
+// dependencies and can be compiled on the host to check every policy exhaustively.
+namespace ActuationPolicy {
+
+    enum InputSource : uint8_t {
+        INPUT_NONE = 0,            // always level 0
+        INPUT_ENCODER_PERCENT = 1, // local encoder 0.0 .. 1.0
+        INPUT_COEFFICIENT = 2,     // server production coefficient for the type
+        INPUT_SIGNED_POWER = 3,    // power per plant normalized to -1.0 .. +1.0 of half the range
+        INPUT_STATE_OF_CHARGE = 4, // storage state of charge 0.0 (empty) .. 1.0 (full)
+        INPUT_SOURCE_COUNT
+    };
+
+    // Ends of every input's range, indexed by InputSource
+    struct InputRange {
+        float min;
+        float max;
+    };
+    static constexpr InputRange INPUT_RANGES[INPUT_SOURCE_COUNT] = {
+        {0.0f, 0.0f},          // INPUT_NONE
+        {0.0f, 1.0f},          // INPUT_ENCODER_PERCENT
+        {-FLT_MAX, FLT_MAX},   // INPUT_COEFFICIENT
+        {-1.0f, 1.0f},         // INPUT_SIGNED_POWER
+        {0.0f, 1.0f},          // INPUT_STATE_OF_CHARGE
+    };
+
+    static constexpr uint8_t MAX_THRESHOLDS = 10;
+
+    struct Policy {
+        const char* name;
+        InputSource source;
+        bool requiresRange;        // type disabled (no server range) -> disabledCommand
+        uint8_t disabledCommand;   // also sent by INPUT_COEFFICIENT rows without a coefficient
+        uint8_t thresholdCount;
+        uint16_t strictMask;       // bit i set: level advances only when input > thresholds[i] (else >=)
+        float thresholds[MAX_THRESHOLDS];
+        uint8_t commands[MAX_THRESHOLDS + 1]; // commands[level], level = thresholds passed
+        float hysteresis;          // input must pass a threshold by this much to change level
+        uint16_t minDwellMs;       // minimum time a level is held before the next change
+    };
+
+    // Per-type quantizer state
+    struct LevelState {
+        uint8_t level;             // current level (index into commands)
+        bool valid;                // false until the first evaluation / after disable
+        bool held;                 // a level change is waiting for the dwell time
+        unsigned long since;       // millis() when the current level was entered
+        uint32_t transitions;      // level changes
+        uint32_t dwellHolds;       // changes delayed by the minimum dwell
+    };
+
+    // Values gathered once per evaluation
+    struct Inputs {
+        bool rangeValid;           // maxWatts > 0
+        bool coefficientValid;     // the server tables hold a production coefficient for the type
+        float values[INPUT_SOURCE_COUNT];
+    };
+
+    using namespace UartProtocol;
+
+    // Indexed by slave type (PowerPlantType values 1..8); index 0 covers unknown types
+    static constexpr Policy POLICIES[] = {
+        // 0: unknown type -> OFF
+        {"UNKNOWN", INPUT_NONE, false, CMD_OFF, 0, 0x0000,
+            {}, {CMD_OFF}, 0.0f, 0},
+        // 1: PHOTOVOLTAIC - server solar coefficient, ON while <= threshold, idle above and
+        //    while there is no coefficient
+        {"SOLAR", INPUT_COEFFICIENT, false, CMD_BATTERY_IDLE, 1, 0x0001,
+            {SOLAR_ACTIVE_THRESHOLD}, {CMD_ON, CMD_BATTERY_IDLE},
+            ACTUATION_COEFFICIENT_HYSTERESIS, ACTUATION_MIN_DWELL_MS},
+        // 2: WIND - turbines spin while the wind coefficient is above the threshold, OFF without one
+        {"WIND", INPUT_COEFFICIENT, false, CMD_OFF, 1, 0x0001,
+            {WIND_COEFFICIENT_THRESHOLD}, {CMD_OFF, CMD_ON},
+            ACTUATION_COEFFICIENT_HYSTERESIS, ACTUATION_MIN_DWELL_MS},
+        // 3: NUCLEAR - ON above 50% encoder
+        {"NUCLEAR", INPUT_ENCODER_PERCENT, true, CMD_OFF, 1, 0x0001,
+            {0.5f}, {CMD_OFF, CMD_ON},
+            ACTUATION_ENCODER_HYSTERESIS, ACTUATION_MIN_DWELL_MS},
+        // 4: GAS - OFF below 5%, then 10 flame levels in 10% bands
+        {"GAS", INPUT_ENCODER_PERCENT, true, CMD_OFF, 10, 0x0000,
+            {0.05f, 0.2f, 0.3f, 0.4f, 0.5f, 0.6f, 0.7f, 0.8f, 0.9f, 1.0f},
+            {CMD_OFF, CMD_GAS_LEVEL_1, CMD_GAS_LEVEL_1 + 1, CMD_GAS_LEVEL_1 + 2, CMD_GAS_LEVEL_1 + 3,
+             CMD_GAS_LEVEL_1 + 4, CMD_GAS_LEVEL_1 + 5, CMD_GAS_LEVEL_1 + 6, CMD_GAS_LEVEL_1 + 7,
+             CMD_GAS_LEVEL_1 + 8, CMD_GAS_LEVEL_10},
+            ACTUATION_ENCODER_HYSTERESIS, ACTUATION_MIN_DWELL_MS},
+        // 5: HYDRO - ON above 50% encoder
+        {"HYDRO", INPUT_ENCODER_PERCENT, true, CMD_OFF, 1, 0x0001,
+            {0.5f}, {CMD_OFF, CMD_ON},
+            ACTUATION_ENCODER_HYSTERESIS, ACTUATION_MIN_DWELL_MS},
+        // 6: HYDRO_STORAGE - 5 fill levels from the integrated state of charge: empty (< 12.5%),
+        //    25%, 50%, 75%, full (>= 87.5%)
+        {"HYDRO_STORAGE", INPUT_STATE_OF_CHARGE, true, CMD_OFF, 4, 0x0000,
+            {0.125f, 0.375f, 0.625f, 0.875f},
+            {CMD_HYDRO_STORAGE_LEVEL_5, CMD_HYDRO_STORAGE_LEVEL_4, CMD_HYDRO_STORAGE_LEVEL_3,
+             CMD_HYDRO_STORAGE_LEVEL_2, CMD_HYDRO_STORAGE_LEVEL_1},
+            ACTUATION_SOC_HYSTERESIS, ACTUATION_MIN_DWELL_MS},
+        // 7: COAL - ON above 50% encoder
+        {"COAL", INPUT_ENCODER_PERCENT, true, CMD_OFF, 1, 0x0001,
+            {0.5f}, {CMD_OFF, CMD_ON},
+            ACTUATION_ENCODER_HYSTERESIS, ACTUATION_MIN_DWELL_MS},
+        // 8: BATTERY - charge below zero, idle at exactly zero, discharge above. No hysteresis:
+        //    idle is a single point, the center snap in computePowerPerPlant is its deadband.
+        //    An empty / full battery is limited to zero power and idles
+        {"BATTERY", INPUT_SIGNED_POWER, false, CMD_OFF, 2, 0x0002,
+            {0.0f, 0.0f}, {CMD_BATTERY_CHARGE, CMD_BATTERY_IDLE, CMD_BATTERY_DISCHARGE},
+            0.0f, ACTUATION_MIN_DWELL_MS},
+    };
+
+    static constexpr uint8_t POLICY_COUNT = sizeof(POLICIES) / sizeof(POLICIES[0]);
+
+    static inline const Policy& forType(uint8_t slaveType) {
+        return POLICIES[slaveType < POLICY_COUNT ? slaveType : 0];
+    }
+
+    // Number of thresholds passed by x (0 .. thresholdCount)
+    static inline uint8_t quantize(const Policy& policy, float x) {
+        uint8_t level = 0;
+        for (uint8_t i = 0; i < policy.thresholdCount; i++) {
+            const bool strict = (policy.strictMask >> i) & 1u;
+            const float t = policy.thresholds[i];
+            level += static_cast<uint8_t>((x > t) | (!strict & (x == t)));
+        }
+        return level;
+    }
+
+    // Select the policy's input value
+    static inline float selectInput(const Policy& policy, const Inputs& inputs) {
+        return inputs.values[policy.source];
+    }
+
+    // Level for x starting from the current level: moving up needs x - hysteresis to reach the
+    // higher level, moving down needs x + hysteresis to fall below; otherwise keep the level.
+    // An input at the end of its range is taken as is, so a threshold sitting on that end
+    // (gas level 10 at a full encoder) stays reachable.
+    static inline uint8_t quantizeFrom(const Policy& policy, float x, uint8_t current) {
+        const InputRange& range = INPUT_RANGES[policy.source];
+        const uint8_t up = quantize(policy, x >= range.max ? x : x - policy.hysteresis);
+        const uint8_t down = quantize(policy, x <= range.min ? x : x + policy.hysteresis);
+        return up > current ? up : (down < current ? down : current);
+    }
+
+    // Advance the level state for input x at time now; returns the level to actuate
+    static inline uint8_t track(const Policy& policy, LevelState& state, float x, unsigned long now) {
+        if (!state.valid) {
+            state.level = quantize(policy, x);
+            state.valid = true;
+            state.held = false;
+            state.since = now;
+            return state.level;
+        }
+        const uint8_t wanted = quantizeFrom(policy, x, state.level);
+        if (wanted == state.level) {
+            state.held = false;
+        } else if (now - state.since < policy.minDwellMs) {
+            if (!state.held) state.dwellHolds++;
+            state.held = true;
+        } else {
+            state.level = wanted;
+            state.since = now;
+            state.held = false;
+            state.transitions++;
+        }
+        return state.level;
+    }
+
+    // True when the type sends its disabledCommand: no server range for a type that needs one,
+    // or no server coefficient to drive a coefficient row
+    static inline bool isDisabled(const Policy& policy, const Inputs& inputs) {
+        return (policy.requiresRange && !inputs.rangeValid) ||
+               (policy.source == INPUT_COEFFICIENT && !inputs.coefficientValid);
+    }
+
+    // Command for the given inputs (stateless reference: no hysteresis, no dwell)
+    static inline uint8_t evaluate(const Policy& policy, const Inputs& inputs) {
+        if (isDisabled(policy, inputs)) return policy.disabledCommand;
+        return policy.commands[quantize(policy, selectInput(policy, inputs))];
+    }
+
+    // Command for the given inputs with hysteresis and minimum dwell applied through state.
+    // A disabled type forgets its level so re-enabling applies the input immediately.
+    static inline uint8_t evaluate(const Policy& policy, const Inputs& inputs, LevelState& state, unsigned long now) {
+        if (isDisabled(policy, inputs)) {
+            state.valid = false;
+            state.held = false;
+            return policy.disabledCommand;
+        }
+        return policy.commands[track(policy, state, selectInput(policy, inputs), now)];
+    }
+}
@@ -0,0 +1,79 @@
+#pragma once
+#include <stdint.h>
+
+// Per-type debounce state machine for plant amounts reported by the retranslation station.
+//
+// Each slave type owns one fixed slot: the committed amount, an optional staged target and
+// the deadline at which that target is committed. Every observation is an O(1) transition;
+// expiry only walks the pending types once the earliest deadline has actually passed.
+//
+// Decreases and increases have independent grace periods per type (0 = apply immediately),
+// so a flaky contact can be hidden without delaying plants that are being plugged in.
+// A staged change that is abandoned before its deadline counts as a "flap".
+class AmountDebouncer {
+public:
+    static constexpr uint8_t MAX_TYPES = 16;
+
+    enum State : uint8_t {
+        STABLE,
+        PENDING_DECREASE,
+        PENDING_INCREASE
+    };
+
+    enum Result : uint8_t {
+        NO_CHANGE,   // nothing to do
+        COMMITTED,   // committed amount changed right away
+        STAGED,      // new pending change, committed after grace
+        RESTAGED,    // pending target changed, deadline restarted
+        CANCELLED    // pending change abandoned (amount returned) -> flap
+    };
+
+    AmountDebouncer();
+
+    // Grace periods for one type, in milliseconds
+    void configure(uint8_t type, uint16_t decreaseGraceMs, uint16_t increaseGraceMs);
+
+    // Feed one reported amount; returns what happened to the type's state
+    Result observe(uint8_t type, uint8_t amount, unsigned long now);
+
+    // True when at least one staged change has reached its deadline
+    bool hasExpired(unsigned long now) const {
+        return pendingMask != 0 && static_cast<long>(now - nextDeadline) >= 0;
+    }
+
+    // Commit every staged change whose deadline passed; returns bitmask of committed types
+    uint16_t expire(unsigned long now);
+
+    bool isKnown(uint8_t type) const { return type < MAX_TYPES && slots[type].known; }
+    uint8_t getCommitted(uint8_t type) const { return type < MAX_TYPES ? slots[type].committed : 0; }
+    uint8_t getTarget(uint8_t type) const { return type < MAX_TYPES ? slots[type].target : 0; }
+    State getState(uint8_t type) const { return type < MAX_TYPES ? slots[type].state : STABLE; }
+    uint16_t getFlapCount(uint8_t type) const { return type < MAX_TYPES ? slots[type].flapCount : 0; }
+    uint16_t getCommitCount(uint8_t type) const { return type < MAX_TYPES ? slots[type].commitCount : 0; }
+    uint16_t getPendingMask() const { return pendingMask; }
+
+    // Force a committed amount without debounce (e.g. restored state)
+    void setCommitted(uint8_t type, uint8_t amount);
+
+private:
+    struct Slot {
+        uint8_t committed;
+        uint8_t target;
+        State state;
+        bool known;
+        uint16_t decreaseGraceMs;
+        uint16_t increaseGraceMs;
+        unsigned long deadline;
+        uint16_t flapCount;
+        uint16_t commitCount;
+    };
+
+    Slot slots[MAX_TYPES];
+    uint16_t pendingMask;          // bit N = type N has a staged change
+    unsigned long nextDeadline;    // earliest deadline among pending types
+
+    void commit(uint8_t type, uint8_t amount);
+    void stage(uint8_t type, State state, uint8_t amount, uint16_t graceMs, unsigned long now);
+    void clearPending(uint8_t type);
+    void recomputeNextDeadline();
+};
@@ -36,5 +36,52 @@
 // Timing configurations (in milliseconds)
 #define API_UPDATE_INTERVAL_MS 500          // How often to send data to server
 #define COEFFICIENT_POLL_INTERVAL_MS 2000   // How often to request coefficients
+#define TELEMETRY_WINDOW_MIN_MS (API_UPDATE_INTERVAL_MS / 2) // callbacks of one upload share a window
+
+// Adaptive server state poll (ranges + coefficients), see poll_cadence.h
+#define STATE_POLL_MIN_MS 1000          // fastest: round transitions, values changing every cycle
+#define STATE_POLL_BASE_MS 3000         // cadence when a game starts
+#define STATE_POLL_MAX_ACTIVE_MS 15000  // slowest during a game with steady values
+#define STATE_POLL_STEP_MS 1000         // back-off per unchanged cycle
+#define STATE_POLL_IDLE_MS 30000        // no game running
+#define STATE_POLL_BURST_MS 15000       // fast polling after a game starts or ends
+
+// Offline telemetry journal, see telemetry_journal.h
+#define JOURNAL_OFFLINE_AFTER_MS 35000  // requests failing with no answer for this long = unreachable
+#define JOURNAL_RECORD_INTERVAL_MS 10000 // one journal record per 10s of outage
+#define JOURNAL_CAPACITY 360            // 1h of records, 20 bytes each
+#define JOURNAL_UPLOAD_PATH "/telemetry/journal" // backfill endpoint on the API server, see journal_upload.h
+#define JOURNAL_UPLOAD_BATCH 10          // records per backfill request
+#define JOURNAL_UPLOAD_CHECK_MS 2000     // journal check while there is nothing to send
+#define JOURNAL_UPLOAD_RETRY_MAX_MS 30000 // back-off cap after failed backfill requests
+
+// LAN server discovery (builds without PRODUCTION_SERVER_URL), see server_discovery.h
+#define DISCOVERY_TIMEOUT_MS 8000
+#define DISCOVERY_UDP_PORT 80
+#define DISCOVERY_BROADCAST_INTERVAL_MS 500
+#define DISCOVERY_CONNECT_TIMEOUT_MS 300   // per host; absent LAN hosts never answer the SYN
+#define DISCOVERY_CANDIDATE_GRACE_MS 150   // wait for a confirmation before taking an open port
+#define DISCOVERY_CACHE_PROBE_MS 300       // check of the remembered server before a full search
+#define DISCOVERY_REPLY_TOKEN "POWERPLANT-SERVER"  // the server's UDP reply and discovery page, see discovery_reply.h
+#define DISCOVERY_VERIFY_PATH "/discovery"
+#define DISCOVERY_VERIFY_TIMEOUT_MS 500    // HTTP check of a candidate before it is taken
+
+// Local live-telemetry WebSocket (ws://<board>:LIVE_TELEMETRY_PORT/live), see live_telemetry.h
+#define LIVE_TELEMETRY_PORT 8080           // not 80: boards must not look like a server to discovery
+#define LIVE_TELEMETRY_PATH "/live"
+#define LIVE_TELEMETRY_MAX_CLIENTS 4
+#define LIVE_TELEMETRY_DEFAULT_HZ 10
+#define LIVE_TELEMETRY_MAX_HZ 50           // = LIVE_TELEMETRY_TICK_MS
+#define LIVE_TELEMETRY_HEARTBEAT_MS 1000   // empty delta when nothing changed
+#define LIVE_TELEMETRY_KEYFRAME_MS 5000    // full frame this often, resyncs a client after a lost message
+#define LIVE_TELEMETRY_STALL_MS 2000       // drop a client whose send queue stays full this long
+
+// Server-push subscription (Server-Sent Events on the API server), see server_events.h
+#define SERVER_EVENTS_PATH "/events"
+#define SERVER_EVENTS_FALLBACK_POLL_MS 30000  // state poll interval while the stream is up
+#define SERVER_EVENTS_IDLE_TIMEOUT_MS 45000   // reconnect after this long without a byte (keepalives included)
+#define SERVER_EVENTS_RETRY_MIN_MS 1000
+#define SERVER_EVENTS_RETRY_MAX_MS 30000
+#define SERVER_EVENTS_STABLE_MS 10000         // a stream up this long resets the reconnect back-off
 
 #endif // BOARD_CONFIG_H
@@ -0,0 +1,68 @@
+#pragma once
+#include <stdint.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/event_groups.h>
+
+// Boot as a dependency graph of init stages.
+//
+// A stage either runs inline on the calling task (run()) or on its own FreeRTOS task
+// (start()), which first waits until all stages in its dependency mask are done. Completion
+// is an event-group bit, so dependants and the main loop (isDone()) see it without polling
+// locks. Every stage records when it started and finished relative to boot; once the last
+// stage is done the report is printed: per-stage timings plus time to first display, UART
+// ready and server ready.
+class BootPipeline {
+public:
+    enum Stage : uint8_t {
+        STAGE_PERIPHERALS,
+        STAGE_WARM_START,
+        STAGE_DISPLAY,      // first frame on the displays, refresh timer running
+        STAGE_UART,
+        STAGE_NFC,          // reader initialised and self-tested
+        STAGE_WIFI,
+        STAGE_SERVER,       // discovered, logged in and registered
+        STAGE_COUNT
+    };
+
+    typedef bool (*StageFn)();
+
+    static constexpr uint32_t bit(Stage stage) { return 1u << stage; }
+
+    BootPipeline();
+
+    // Create the completion event group (call first thing in setup)
+    void begin();
+
+    // Run a stage on the calling task; returns the stage result
+    bool run(Stage stage, StageFn fn);
+
+    // Run a stage on a new task once every stage in dependsOn is done
+    bool start(Stage stage, StageFn fn, uint32_t dependsOn, uint32_t stackSize, uint8_t priority = 1);
+
+    bool isDone(Stage stage) const { return doneBits && (xEventGroupGetBits(doneBits) & bit(stage)) != 0; }
+    bool succeeded(Stage stage) const { return timings[stage].ok; }
+
+    void printReport() const;
+
+private:
+    struct Timing {
+        uint32_t startMs;
+        uint32_t endMs;
+        bool ok;
+    };
+
+    struct TaskArgs {
+        BootPipeline* pipeline;
+        Stage stage;
+        StageFn fn;
+        uint32_t dependsOn;
+    };
+
+    EventGroupHandle_t doneBits;
+    Timing timings[STAGE_COUNT];
+    TaskArgs taskArgs[STAGE_COUNT];
+
+    bool execute(Stage stage, StageFn fn);
+    static void taskEntry(void* arg);
+    static const char* stageName(Stage stage);
+};
@@ -0,0 +1,29 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+// What the game server has to say before discovery takes an address (see server_discovery.h).
+//
+// Open ports and UDP senders alone prove nothing: every board on the LAN broadcasts the
+// DISCOVER request to the same port, and routers and printers serve port 80. So the server
+// answers the broadcast with a datagram that starts with its reply token, and the discovery
+// HTTP path returns 2xx with the token in the body. Only the token is checked, anything may
+// follow it (a version, a name). No Arduino dependencies.
+
+// A datagram that starts with token; a copy of the request or anything else is not a reply
+inline bool isDiscoveryReply(const uint8_t* data, size_t len, const char* token) {
+    const size_t tokenLen = strlen(token);
+    return tokenLen > 0 && len >= tokenLen && memcmp(data, token, tokenLen) == 0;
+}
+
+// A complete HTTP response (NUL-terminated, possibly cut short) to the discovery path: status
+// 2xx and token in the body
+inline bool isDiscoveryAnswer(const char* response, const char* token) {
+    if (strncmp(response, "HTTP/1.", 7) != 0 || !response[7] || response[8] != ' ') return false;
+    const long status = strtol(response + 9, nullptr, 10);
+    if (status < 200 || status >= 300) return false;
+    const char* body = strstr(response, "\r\n\r\n");
+    return body && *token && strstr(body + 4, token) != nullptr;
+}
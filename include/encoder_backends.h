@@ -0,0 +1,59 @@
+#pragma once
+#include <stdint.h>
+#include <driver/pcnt.h>
+#include "encoder_input.h"
+#include "PeripheralFactory.h"
+
+// Quadrature edges per value step for hardware-decoded encoders (1 = every edge, like the
+// library encoders created with steps = 1)
+#ifndef ENCODER_EDGES_PER_STEP
+#define ENCODER_EDGES_PER_STEP 1
+#endif
+
+// PCNT glitch filter in APB clock cycles (80 MHz): pulses shorter than this are ignored.
+// 1000 cycles = 12.5 us, the hardware maximum is 1023.
+#ifndef ENCODER_PCNT_FILTER_CYCLES
+#define ENCODER_PCNT_FILTER_CYCLES 1000
+#endif
+
+// Encoder decoded by the pulse counter peripheral: both channels of one PCNT unit count
+// every A and B edge (x4) with the other line as direction control, so rotation costs no
+// CPU and no interrupts at all. The hardware counter restarts from 0 at +/-PCNT_LIMIT;
+// readCount() unwraps it into a 32-bit count, which is exact as long as fewer than
+// PCNT_LIMIT / 2 edges happen between two reads (the loop reads every few ms).
+// The ESP32-S3 has four units -> four encoders.
+class PcntEncoder : public QuadratureEncoder {
+public:
+    // Claim the next free PCNT unit; returns nullptr when none is left or setup failed
+    static PcntEncoder* create(int pinA, int pinB, long minValue, long maxValue,
+                               uint8_t edgesPerStep = ENCODER_EDGES_PER_STEP);
+
+    pcnt_unit_t getUnit() const { return unit; }
+
+protected:
+    int32_t readCount() override;
+
+private:
+    static constexpr int16_t PCNT_LIMIT = 10000;
+
+    pcnt_unit_t unit;
+    int16_t lastRaw;      // hardware counter at the previous read
+    int32_t extended;     // unwrapped edge count
+
+    PcntEncoder(pcnt_unit_t unit, long minValue, long maxValue, uint8_t edgesPerStep)
+        : QuadratureEncoder(minValue, maxValue, edgesPerStep), unit(unit), lastRaw(0), extended(0) {}
+
+    bool begin(int pinA, int pinB);
+};
+
+// Interrupt-driven library encoder behind the same interface (fallback when no PCNT unit
+// is left, or with DISABLE_PCNT_ENCODERS)
+class GpioEncoderInput : public EncoderInput {
+public:
+    explicit GpioEncoderInput(Encoder* encoder) : encoder(encoder) {}
+    long getValue() override { return encoder->getValue(); }
+    void setValue(long value) override { encoder->setValue(value); }
+
+private:
+    Encoder* encoder;
+};
@@ -0,0 +1,113 @@
+#pragma once
+#include <stdint.h>
+
+// Value interface GameManager uses for every rotary encoder (0..1000 for the plant controls).
+// Backends: PcntEncoder (hardware pulse counter), GpioEncoderInput (interrupt-driven library
+// encoder) and SyntheticQuadratureEncoder (host stand-in fed with generated A/B levels).
+class EncoderInput {
+public:
+    virtual ~EncoderInput() {}
+    virtual long getValue() = 0;
+    virtual void setValue(long value) = 0;
+};
+
+// Turns a free-running signed edge counter into a clamped value.
+//
+// Subclasses only provide readCount(); the counter may wrap, deltas are taken modulo 2^32.
+// edgesPerStep quadrature edges make one value step (4 = one step per detent on most
+// encoders, 1 = every edge counts). Sub-step remainders are kept, so slow turning never
+// loses edges, and turning past either end does not wind up: reversing moves immediately.
+class QuadratureEncoder : public EncoderInput {
+public:
+    QuadratureEncoder(long minValue, long maxValue, uint8_t edgesPerStep)
+        : minValue(minValue), maxValue(maxValue),
+          edgesPerStep(edgesPerStep ? edgesPerStep : 1),
+          value(minValue), lastCount(0), residual(0), totalEdges(0) {}
+
+    long getValue() override {
+        sync();
+        return value;
+    }
+
+    void setValue(long newValue) override {
+        lastCount = readCount();
+        residual = 0;
+        value = clamp(newValue);
+    }
+
+    // Edges seen since construction (both directions)
+    uint32_t getTotalEdges() const { return totalEdges; }
+
+protected:
+    // Current hardware / simulated edge count
+    virtual int32_t readCount() = 0;
+
+    // Take the current count as the reference (call once the counter is running)
+    void resetReference() { lastCount = readCount(); residual = 0; }
+
+private:
+    long minValue;
+    long maxValue;
+    int32_t edgesPerStep;
+    long value;
+    int32_t lastCount;
+    int32_t residual;      // edges not yet worth a full step (|residual| < edgesPerStep)
+    uint32_t totalEdges;
+
+    long clamp(long v) const { return v < minValue ? minValue : (v > maxValue ? maxValue : v); }
+
+    void sync() {
+        const int32_t count = readCount();
+        const int32_t delta = static_cast<int32_t>(static_cast<uint32_t>(count) - static_cast<uint32_t>(lastCount));
+        if (delta == 0) return;
+        lastCount = count;
+        totalEdges += static_cast<uint32_t>(delta < 0 ? -delta : delta);
+        residual += delta;
+        const int32_t steps = residual / edgesPerStep; // truncates toward zero in both directions
+        residual -= steps * edgesPerStep;
+        value = clamp(value + steps);
+    }
+};
+
+// Software x4 quadrature decoder with the same direction and counting rules as the PCNT
+// channel setup: A leading B counts up, every valid edge counts once, a transition where
+// both lines change at once (missed edge / glitch) is ignored and counted as invalid.
+// Used on the host to drive QuadratureEncoder with synthetic A/B sequences.
+class SyntheticQuadratureEncoder : public QuadratureEncoder {
+public:
+    SyntheticQuadratureEncoder(long minValue, long maxValue, uint8_t edgesPerStep)
+        : QuadratureEncoder(minValue, maxValue, edgesPerStep), levels(0), count(0), invalid(0) {}
+
+    // Present new A/B line levels to the decoder
+    void setLevels(bool a, bool b) {
+        // [previous AB << 2 | next AB] -> -1 / 0 / +1
+        static const int8_t TRANSITIONS[16] = {0, -1, 1, 0, 1, 0, 0, -1, -1, 0, 0, 1, 0, 1, -1, 0};
+        const uint8_t next = static_cast<uint8_t>((a ? 2 : 0) | (b ? 1 : 0));
+        const int8_t step = TRANSITIONS[(levels << 2) | next];
+        if (step == 0 && next != levels) invalid++;
+        count += step;
+        levels = next;
+    }
+
+    // Generate |edges| Gray-code edges; positive = A leads B (counts up)
+    void rotate(long edges) {
+        static const uint8_t SEQUENCE[4] = {0x0, 0x2, 0x3, 0x1}; // AB: 00 -> 10 -> 11 -> 01
+        uint8_t pos = 0;
+        while (SEQUENCE[pos] != levels) pos++;
+        const long n = edges < 0 ? -edges : edges;
+        for (long i = 0; i < n; i++) {
+            pos = static_cast<uint8_t>((pos + (edges > 0 ? 1 : 3)) & 3);
+            setLevels(SEQUENCE[pos] & 2, SEQUENCE[pos] & 1);
+        }
+    }
+
+    uint32_t getInvalidTransitions() const { return invalid; }
+
+protected:
+    int32_t readCount() override { return count; }
+
+private:
+    uint8_t levels;
+    int32_t count;
+    uint32_t invalid;
+};
@@ -0,0 +1,54 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+// FNV-1a fingerprint of server poll responses.
+//
+// The state poll keeps only the fingerprint of the last ranges / coefficients response and
+// compares the next one against it, so an unchanged table costs no publish and no
+// actuation. Fields are hashed one by one (never whole structs, whose padding is undefined).
+// Templated on the record types so it compiles on the host without ESPGameAPI.
+class Fingerprint {
+public:
+    static constexpr uint32_t OFFSET_BASIS = 2166136261u;
+    static constexpr uint32_t PRIME = 16777619u;
+
+    Fingerprint() : hash(OFFSET_BASIS) {}
+
+    Fingerprint& addBytes(const void* data, size_t len) {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < len; i++) {
+            hash ^= bytes[i];
+            hash *= PRIME;
+        }
+        return *this;
+    }
+
+    template <typename T>
+    Fingerprint& add(const T& value) { return addBytes(&value, sizeof(value)); }
+
+    uint32_t get() const { return hash; }
+
+    // Production ranges: source_id, min_power, max_power
+    template <typename Range>
+    static uint32_t ofRanges(const std::vector<Range>& ranges) {
+        Fingerprint fp;
+        for (const auto& range : ranges) fp.add(range.source_id).add(range.min_power).add(range.max_power);
+        return fp.get();
+    }
+
+    // Production (source_id, coefficient) and consumption (building_id, consumption) tables
+    template <typename Production, typename Consumption>
+    static uint32_t ofCoefficients(const std::vector<Production>& production,
+                                   const std::vector<Consumption>& consumption) {
+        Fingerprint fp;
+        for (const auto& coeff : production) fp.add(coeff.source_id).add(coeff.coefficient);
+        fp.addBytes("|", 1);  // production and consumption tables never alias
+        for (const auto& coeff : consumption) fp.add(coeff.building_id).add(coeff.consumption);
+        return fp.get();
+    }
+
+private:
+    uint32_t hash;
+};
@@ -0,0 +1,49 @@
+#pragma once
+#include <stdint.h>
+#include <atomic>
+#include "board_config.h"
+#include "telemetry_journal.h"
+#include "tls_session_client.h"
+
+// Backfill of the offline telemetry journal (see GameManager, telemetry_journal.h).
+//
+// ESPGameAPI only uploads the current production and consumption, without a time, so a
+// journaled window cannot go through it without overwriting the live values. Instead this
+// task POSTs the journal in batches of JOURNAL_UPLOAD_BATCH records (formatJournalBatch(): every
+// record with its age) to JOURNAL_UPLOAD_PATH on the API server, identified by board id like
+// the server-push stream, while the live windows keep going through the library. A batch
+// leaves the journal only on a 2xx answer; failures back off up to JOURNAL_UPLOAD_RETRY_MAX_MS.
+// Every batch is its own HTTP/1.0 request; over https:// its handshake resumes the last session.
+class JournalUpload {
+public:
+    static constexpr uint32_t TASK_STACK = 8192;   // TLS when the server URL is https://
+    static constexpr int32_t TIMEOUT_MS = 5000;
+
+    // One backfill step (GameManager::replayJournal with this uploader as the sink): records
+    // delivered, 0 if nothing is due, -1 if the request failed
+    typedef int (*Pump)(JournalUpload& upload, unsigned long now);
+
+    JournalUpload();
+
+    // Start the upload task for the API server at serverUrl (once)
+    bool begin(const char* serverUrl, Pump pump);
+
+    // Sink side: POST one batch, true when the server accepted it (task context only)
+    bool send(const JournalRecord* records, uint16_t count, uint32_t now);
+
+    void print() const;
+
+private:
+    char url[96];
+    Pump pump;
+    std::atomic<bool> started;
+    std::atomic<uint32_t> batches;
+    std::atomic<uint32_t> records;
+    std::atomic<uint32_t> failures;
+    std::atomic<uint16_t> lastStatus;   // HTTP status of the last request, 0 = no answer
+    char body[JOURNAL_UPLOAD_BATCH * 200 + 32];
+    TlsSessionClient tls;       // resumes its session across batches, see tls_session_client.h
+
+    static void taskEntry(void* arg);
+    void run();
+};
@@ -0,0 +1,80 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+
+// Fixed-size latency histogram with logarithmic buckets (4 sub-buckets per power of two).
+// Units are whatever the caller records (us, ms, CPU cycles). Recording is O(1) and
+// allocation free, so it can sit on hot paths; percentiles are resolved to the upper
+// edge of the matching bucket (<= 25% relative error).
+class LatencyHistogram {
+public:
+    static constexpr uint8_t SUB_BUCKET_BITS = 2;
+    static constexpr uint8_t SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static constexpr uint8_t OCTAVES = 31;
+    static constexpr uint8_t BUCKET_COUNT = OCTAVES * SUB_BUCKETS;
+
+    LatencyHistogram() { reset(); }
+
+    void reset() {
+        memset(buckets, 0, sizeof(buckets));
+        count = 0;
+        sum = 0;
+        minValue = UINT32_MAX;
+        maxValue = 0;
+    }
+
+    void record(uint32_t value) {
+        buckets[bucketIndex(value)]++;
+        count++;
+        sum += value;
+        if (value < minValue) minValue = value;
+        if (value > maxValue) maxValue = value;
+    }
+
+    // Upper bound of the bucket holding the given percentile (0..100)
+    uint32_t percentile(uint8_t pct) const {
+        if (count == 0) return 0;
+        uint32_t rank = (uint32_t)(((uint64_t)count * pct + 99) / 100);
+        if (rank == 0) rank = 1;
+        uint32_t seen = 0;
+        for (uint8_t i = 0; i < BUCKET_COUNT; i++) {
+            seen += buckets[i];
+            if (seen >= rank) {
+                uint32_t upper = bucketUpperBound(i);
+                return upper < maxValue ? upper : maxValue;
+            }
+        }
+        return maxValue;
+    }
+
+    uint32_t getCount() const { return count; }
+    uint32_t getMin() const { return count ? minValue : 0; }
+    uint32_t getMax() const { return maxValue; }
+    uint32_t getAverage() const { return count ? (uint32_t)(sum / count) : 0; }
+
+private:
+    uint32_t buckets[BUCKET_COUNT];
+    uint32_t count;
+    uint64_t sum;
+    uint32_t minValue;
+    uint32_t maxValue;
+
+    // Values below SUB_BUCKETS map linearly; above, bucket = octave * 4 + next two bits after the MSB
+    static uint8_t bucketIndex(uint32_t value) {
+        if (value < SUB_BUCKETS) return (uint8_t)value;
+        uint8_t msb = 31 - __builtin_clz(value);
+        uint8_t sub = (value >> (msb - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1);
+        uint16_t index = (uint16_t)(msb - SUB_BUCKET_BITS + 1) * SUB_BUCKETS + sub;
+        return index < BUCKET_COUNT ? (uint8_t)index : (uint8_t)(BUCKET_COUNT - 1);
+    }
+
+    static uint32_t bucketUpperBound(uint8_t index) {
+        if (index < SUB_BUCKETS) return index;
+        uint8_t msb = index / SUB_BUCKETS + SUB_BUCKET_BITS - 1;
+        uint8_t sub = index % SUB_BUCKETS;
+        uint64_t lower = ((uint64_t)(SUB_BUCKETS + sub)) << (msb - SUB_BUCKET_BITS);
+        uint64_t width = 1ULL << (msb - SUB_BUCKET_BITS);
+        uint64_t upper = lower + width - 1;
+        return upper > UINT32_MAX ? UINT32_MAX : (uint32_t)upper;
+    }
+};
@@ -0,0 +1,70 @@
+#pragma once
+#include <stdint.h>
+#include <mutex>
+#include "board_config.h"
+#include "telemetry_frame.h"
+
+class AsyncWebServer;
+class AsyncWebSocket;
+class AsyncWebSocketClient;
+
+// Local WebSocket endpoint streaming TelemetryFrames to LAN dashboards.
+//
+// Every subscriber gets a key frame when it connects and every LIVE_TELEMETRY_KEYFRAME_MS,
+// in between deltas against the last frame queued to it, at its own rate: LIVE_TELEMETRY_DEFAULT_HZ, or whatever it asks for by
+// sending one byte with a rate in Hz (1..LIVE_TELEMETRY_MAX_HZ). Unchanged state costs a
+// heartbeat (empty delta) every LIVE_TELEMETRY_HEARTBEAT_MS.
+//
+// Nothing ever waits for a client: when a subscriber's send queue is full (or it is closing)
+// its frame is skipped and the baseline stays, so the next delta still covers everything
+// since the last frame it got; a client that stays full for LIVE_TELEMETRY_STALL_MS is
+// disconnected. binary() reports no failure, so the periodic key frame bounds how long a
+// message the library dropped anyway can leave a dashboard wrong. The server is created by
+// begin(), once WiFi is up; before that the endpoint costs no memory.
+class LiveTelemetry {
+public:
+    LiveTelemetry();
+
+    void begin();
+    bool isRunning() const { return socket != nullptr; }
+
+    // True when at least one subscriber is due for a frame (snapshot only then)
+    bool wantsFrame(unsigned long now);
+    // Send the snapshot to every due subscriber
+    void publish(const TelemetrySnapshot& snapshot, unsigned long now);
+
+    void print() const;
+
+private:
+    struct Subscriber {
+        uint32_t clientId;          // 0 = free slot
+        uint16_t intervalMs;
+        bool keyed;                 // baseline holds what the client has
+        uint32_t sequence;
+        unsigned long lastCheckAt;  // last time a frame was due (sent or unchanged)
+        unsigned long lastSentAt;
+        unsigned long lastKeyAt;
+        unsigned long stalledSince; // 0 = queue accepted the last frame
+        TelemetrySnapshot baseline;
+    };
+
+    AsyncWebServer* server;
+    AsyncWebSocket* socket;
+    // Held by publish() and by the socket event handler (AsyncTCP task), so a client cannot
+    // be freed while a frame is queued to it
+    std::mutex subscribersMutex;
+    Subscriber subscribers[LIVE_TELEMETRY_MAX_CLIENTS];
+
+    uint32_t framesSent;
+    uint32_t keyFramesSent;
+    uint32_t bytesSent;
+    uint32_t framesSkipped;     // queue full
+    uint32_t clientsDropped;    // stalled too long
+    uint32_t clientsRejected;   // no free slot
+
+    void onConnect(AsyncWebSocketClient* client);
+    void onDisconnect(uint32_t clientId);
+    void onRateRequest(uint32_t clientId, const uint8_t* data, size_t len);
+    Subscriber* find(uint32_t clientId);
+    bool isDue(const Subscriber& sub, unsigned long now) const;
+};
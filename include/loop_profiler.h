@@ -0,0 +1,69 @@
+#pragma once
+#include <stdint.h>
+#include "latency_histogram.h"
+
+// Build with -DLOOP_PROFILER_ENABLED=0 to compile the profiler out (all calls become no-ops)
+#ifndef LOOP_PROFILER_ENABLED
+#define LOOP_PROFILER_ENABLED 1
+#endif
+
+#if LOOP_PROFILER_ENABLED
+#include <esp_cpu.h>
+
+// Per-stage main loop profiler on the CPU cycle counter.
+//
+// The scheduler brackets every job it runs with cycles() and records the difference under the
+// job's stage id; one runDue() pass is one iteration. Each stage keeps a LatencyHistogram in
+// cycles (min / avg / p99 / max), and the breakdown of the slowest iteration seen is kept so a
+// single long stall can be attributed. Recording is a few adds, no allocation, no locks (the
+// loop task is the only writer). The cycle counter is per core and wraps after ~17 s at
+// 240 MHz; only differences within one iteration are taken.
+class LoopProfiler {
+public:
+    static constexpr uint8_t MAX_STAGES = 16;
+
+    static inline uint32_t cycles() { return esp_cpu_get_ccount(); }
+
+    LoopProfiler();
+
+    void setStageName(uint8_t stage, const char* name);
+
+    void beginIteration();
+    void record(uint8_t stage, uint32_t elapsedCycles);
+    void endIteration();
+
+    void reset();
+
+    // Dump per-stage statistics and the worst iteration, converted to microseconds
+    void print() const;
+
+private:
+    const char* names[MAX_STAGES];
+    LatencyHistogram stages[MAX_STAGES];
+    LatencyHistogram iterations;
+    uint8_t stageCount;
+
+    uint32_t iterationStart;
+    uint32_t current[MAX_STAGES];      // cycles per stage in the running iteration
+    uint16_t currentMask;              // stages that ran in the running iteration
+
+    uint32_t worstTotal;               // slowest iteration and its breakdown
+    uint32_t worst[MAX_STAGES];
+    uint16_t worstMask;
+};
+
+#else
+
+class LoopProfiler {
+public:
+    static constexpr uint8_t MAX_STAGES = 16;
+    static inline uint32_t cycles() { return 0; }
+    void setStageName(uint8_t, const char*) {}
+    void beginIteration() {}
+    void record(uint8_t, uint32_t) {}
+    void endIteration() {}
+    void reset() {}
+    void print() const;
+};
+
+#endif
@@ -0,0 +1,64 @@
+#pragma once
+#include <stdint.h>
+
+// Interval between server state polls, adapted to the game and to how often the server
+// values actually change.
+//
+//  - no game running: idleMs (the library's own status upload still notices a game start)
+//  - for burstMs after a game starts or ends: minMs, the new round's tables arrive quickly
+//  - during a game: starts at baseMs; a cycle that brought a change halves the interval
+//    (down to minMs), a cycle without one adds stepMs (up to maxActiveMs). Failed cycles count
+//    as unchanged, so a struggling server is polled less rather than more.
+//
+// No Arduino dependencies.
+class PollCadence {
+public:
+    PollCadence(uint32_t minMs, uint32_t baseMs, uint32_t maxActiveMs, uint32_t stepMs,
+                uint32_t idleMs, uint32_t burstMs)
+        : minMs(minMs), baseMs(baseMs), maxActiveMs(maxActiveMs), stepMs(stepMs),
+          idleMs(idleMs), burstMs(burstMs), activeMs(baseMs), gameActive(false),
+          burstUntil(0), bursting(false) {}
+
+    // Call on every game state observation; a flip starts a burst
+    void setGameActive(bool active, unsigned long now) {
+        if (active == gameActive) return;
+        gameActive = active;
+        if (active) activeMs = baseMs;
+        burstUntil = now + burstMs;
+        bursting = true;
+    }
+
+    // Outcome of one complete poll cycle
+    void onCycle(bool changed) {
+        if (changed) {
+            activeMs /= 2;
+            if (activeMs < minMs) activeMs = minMs;
+        } else {
+            activeMs += stepMs;
+            if (activeMs > maxActiveMs) activeMs = maxActiveMs;
+        }
+    }
+
+    uint32_t intervalMs(unsigned long now) {
+        if (bursting) {
+            if (static_cast<long>(now - burstUntil) < 0) return minMs;
+            bursting = false;
+        }
+        return gameActive ? activeMs : idleMs;
+    }
+
+    bool isBursting() const { return bursting; }
+    uint32_t getActiveIntervalMs() const { return activeMs; }
+
+private:
+    uint32_t minMs;
+    uint32_t baseMs;
+    uint32_t maxActiveMs;
+    uint32_t stepMs;
+    uint32_t idleMs;
+    uint32_t burstMs;
+    uint32_t activeMs;        // current in-game interval
+    bool gameActive;
+    unsigned long burstUntil;
+    bool bursting;
+};
@@ -0,0 +1,67 @@
+#pragma once
+#include <stdint.h>
+#include <atomic>
+
+enum PollStage : uint8_t {
+    POLL_IDLE,
+    POLL_RANGES,                // ranges request in flight
+    POLL_COEFFICIENTS,          // coefficients request in flight
+    POLL_RECEIVING,             // a callback is filling the response
+    POLL_ANSWERED               // response ready for the loop task
+};
+
+// Hand-off of the one in-flight state poll request between the loop task and the request
+// callback (AsyncRequest worker).
+//
+// The state word carries the stage in its low byte and a request sequence above it. begin()
+// hands out a ticket (sequence + in-flight stage) that the callback presents to claim(); the
+// compare-exchange only succeeds for that exact request. A callback that arrives after the
+// loop gave up on its request therefore fails even when a newer request of the same stage
+// is in flight by then (no ABA on the stage alone). No Arduino dependencies.
+class PollHandoff {
+public:
+    typedef uint32_t Ticket;
+
+    PollHandoff() : state(POLL_IDLE) {}
+
+    uint8_t stage() const { return stageOf(state.load()); }
+    bool inFlight() const { return isInFlight(stage()); }
+
+    // Loop: send a new request; the callback must present the returned ticket
+    Ticket begin(uint8_t inFlightStage) {
+        const Ticket ticket = pack(sequenceOf(state.load()) + 1, inFlightStage);
+        state.store(ticket);
+        return ticket;
+    }
+
+    // Callback: claim the response slot for its own request
+    bool claim(Ticket ticket) {
+        return state.compare_exchange_strong(ticket, pack(sequenceOf(ticket), POLL_RECEIVING));
+    }
+
+    // Callback: release the filled response to the loop task
+    void publish(Ticket ticket) { state.store(pack(sequenceOf(ticket), POLL_ANSWERED)); }
+
+    // Loop: give up on the request in flight. Returns false when none is in flight or its
+    // callback claimed it first; abandonedStage receives the stage given up on.
+    bool abandon(uint8_t& abandonedStage) {
+        uint32_t current = state.load();
+        abandonedStage = stageOf(current);
+        if (!isInFlight(abandonedStage)) return false;
+        return state.compare_exchange_strong(current, pack(sequenceOf(current), POLL_IDLE));
+    }
+
+    // Loop: the answered response was applied
+    void finish() { state.store(pack(sequenceOf(state.load()), POLL_IDLE)); }
+
+    // Loop: drop whatever is in flight (new API instance); old tickets stay invalid
+    void reset() { state.store(pack(sequenceOf(state.load()) + 1, POLL_IDLE)); }
+
+private:
+    std::atomic<uint32_t> state;
+
+    static uint32_t pack(uint32_t sequence, uint8_t stage) { return (sequence << 8) | stage; }
+    static uint32_t sequenceOf(uint32_t word) { return word >> 8; }
+    static uint8_t stageOf(uint32_t word) { return static_cast<uint8_t>(word & 0xFF); }
+    static bool isInFlight(uint8_t stage) { return stage == POLL_RANGES || stage == POLL_COEFFICIENTS; }
+};
@@ -41,8 +41,44 @@
 #define HYDRO_COEFFICIENT_THRESHOLD 0.5f   // Minimum hydro coefficient to start turbines  
 #define TYPICAL_HYDRO_MAX_POWER 1200.0f    // Typical maximum hydro power for coefficient calculation
 
-// Update intervals (in milliseconds)
-#define DISPLAY_UPDATE_INTERVAL_MS   100  // How often to update displays
-#define POWER_PLANT_DEBUG_INTERVAL   1000 // How often to print debug info
+// Photovoltaic configuration
+// Solar attractions get CMD_ON (orange) while the server solar coefficient stays at or
+// below this threshold and CMD_BATTERY_IDLE (green) above it.
+#ifndef SOLAR_ACTIVE_THRESHOLD
+#define SOLAR_ACTIVE_THRESHOLD 0.5f
+#endif
+
+// UART inventory debounce defaults (grace before a reported amount change is committed)
+// Per-type overrides live in the UART_DEBOUNCE_TIMING table in GameManager.cpp
+#define UART_DECREASE_GRACE_MS 500   // decreases / disconnects
+#define UART_INCREASE_GRACE_MS 0     // increases (0 = apply immediately)
+
+// Actuation level hysteresis (in policy input units) and minimum time a level is held.
+// A level only changes once the input moved past the threshold by the hysteresis and the
+// current level has been held for the dwell time. Per-type values live in actuation_policy.h
+#define ACTUATION_ENCODER_HYSTERESIS     0.01f  // encoder fraction (0.01 = 10 encoder steps)
+#define ACTUATION_COEFFICIENT_HYSTERESIS 0.02f  // server coefficient
+#define ACTUATION_MIN_DWELL_MS           150    // minimum time between level changes
+#define ACTUATION_SOC_HYSTERESIS         0.02f  // storage state of charge (0 .. 1)
+
+// Storage state of charge: time one unit takes to go from full to empty at maximum power
+#define BATTERY_FULL_POWER_SECONDS        180
+#define HYDRO_STORAGE_FULL_POWER_SECONDS  300
+#define STORAGE_INITIAL_SOC               0.5f
+
+// Update intervals (in milliseconds), one main loop scheduler job each
+#define UART_POLL_INTERVAL_MS        5     // drain the retranslation UART
+#define GAME_UPDATE_INTERVAL_MS      10    // encoders, server tables, actuation
+#define ESP_API_UPDATE_INTERVAL_MS   10    // ESP-API request / response processing
+#define DISPLAY_UPDATE_INTERVAL_MS   30    // How often to update displays
+#define DISPLAY_BLINK_INTERVAL_MS    500   // total displays blink while the station is offline
+#define NFC_SCAN_INTERVAL_MS         100   // NFC card poll
+#define POWER_PLANT_DEBUG_INTERVAL   1000  // How often to print debug info
+#define POWER_TRACE_INTERVAL_MS      5000  // per-type [POWER] log lines
+#define COEFFICIENT_DEBUG_INTERVAL_MS 10000
+#define UART_STATS_INTERVAL_MS       10000
+#define SCHEDULER_STATS_INTERVAL_MS  60000
+#define CONSOLE_POLL_INTERVAL_MS     50    // single-key serial commands
+#define LIVE_TELEMETRY_TICK_MS       20    // live WebSocket subscribers are served at up to 50 Hz
 
 #endif // POWER_PLANT_CONFIG_H
@@ -3,39 +3,26 @@
 #include <Arduino.h>
 #include <map>
 #include <vector>
+#include "uid_store.h"
 //needs to be singleton
 
 
-uint32_t hashString(const String& s)
-{
-  const uint32_t FNV_PRIME   = 0x01000193UL; // 16777619
-  uint32_t       hash        = 0x811C9DC5UL; // offset basis
-
-  for (size_t i = 0; i < s.length(); ++i) {
-    hash ^= (uint8_t)s[i];   // XOR byte into the low 8 bits
-    hash *= FNV_PRIME;       // multiply by prime (wrap-around is intentional)
-  }
-  return hash;               // 0…4 294 967 295
-}
-
 class PowerTracker {
 private:
     std::map<uint8_t, int32_t> buildingConsumption; // Maps building id to power consumption
     std::map<uint8_t, int32_t> powerPlantConsumption; // Maps power plant id to power consumption
 
-    std::map<uint32_t, uint8_t> buildings; // uid hash to building type
-    std::map<uint32_t, uint8_t> powerPlants; // uid hash to power plant type
+    UidStore buildings; // interned uid to building type
+    UidStore powerPlants; // interned uid to power plant type
 
     void addBuilding(const String& uid, uint8_t buildingType) {
         // Add building to the list and initialize its consumption
-        uint32_t id = hashString(uid);
-        buildings[id] = buildingType;
+        buildings.intern(uid.c_str(), uid.length(), buildingType);
     }
 
     void removeBuilding(const String& uid) {
         // Remove building from the list
-        uint32_t id = hashString(uid);
-        buildings.erase(id);
+        buildings.release(buildings.find(uid.c_str(), uid.length()));
     }
 
 public:
@@ -0,0 +1,72 @@
+#pragma once
+#include <stdint.h>
+#include "latency_histogram.h"
+
+// Outcome and latency statistics for the ESP-API requests the board issues itself.
+//
+// Latency is measured from the call into ESPGameAPI to the completion callback (ms), so it
+// covers queueing in the AsyncRequest worker pool plus the whole HTTP exchange; successes and
+// failures go into separate histograms so slow timeouts do not hide in the success figures.
+// Failures are sorted by cause from the library's error text. A request the board gave up on
+// (no callback within its watchdog) is counted as LOST. ENDPOINT_STATUS is the library's own
+// status exchange: the duration of an update() call that carried an upload.
+class RequestStats {
+public:
+    enum Endpoint : uint8_t {
+        ENDPOINT_RANGES,
+        ENDPOINT_COEFFICIENTS,
+        ENDPOINT_STATUS,
+        ENDPOINT_COUNT
+    };
+
+    enum Failure : uint8_t {
+        FAIL_TIMEOUT,
+        FAIL_CONNECT,       // DNS, refused, no route
+        FAIL_TLS,
+        FAIL_HTTP_STATUS,   // server answered with an error status
+        FAIL_PARSE,         // body did not parse
+        FAIL_LOST,          // no completion callback at all
+        FAIL_OTHER,
+        FAIL_COUNT
+    };
+
+    static constexpr uint8_t MAX_ERROR_TEXT = 48;
+
+    RequestStats() { reset(); }
+
+    static Failure classify(const char* error);
+    static const char* endpointName(Endpoint endpoint);
+    static const char* failureName(Failure failure);
+
+    void begin(Endpoint endpoint, unsigned long now);
+    void complete(Endpoint endpoint, unsigned long now, bool success, const char* error);
+    void lost(Endpoint endpoint, unsigned long now);
+
+    void reset();
+    void print() const;
+    void printSummary() const;   // one line for the periodic debug output
+
+    uint32_t getFailures(Endpoint endpoint, Failure failure) const { return stats[endpoint].failures[failure]; }
+    uint32_t getFailureTotal() const;                    // every endpoint and cause, lost included
+    uint32_t getLastMs(Endpoint endpoint) const { return stats[endpoint].lastMs; }
+    uint32_t getSuccessPercentile(Endpoint endpoint, uint8_t pct) const {
+        return stats[endpoint].successMs.getCount() ? stats[endpoint].successMs.percentile(pct) : 0;
+    }
+
+private:
+    struct EndpointStats {
+        LatencyHistogram successMs;
+        LatencyHistogram failureMs;
+        uint32_t sent;
+        uint32_t succeeded;
+        uint32_t failures[FAIL_COUNT];
+        uint16_t lastHttpStatus;            // last error status seen, 0 = none
+        uint32_t lastMs;                    // duration of the last completed request
+        unsigned long startedAt;
+        char lastError[MAX_ERROR_TEXT];
+    };
+
+    EndpointStats stats[ENDPOINT_COUNT];
+
+    void fail(Endpoint endpoint, Failure failure, uint32_t elapsedMs, const char* error);
+};
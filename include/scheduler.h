@@ -0,0 +1,91 @@
+#pragma once
+#include <stdint.h>
+#include "loop_profiler.h"
+
+// Deadline-driven cooperative scheduler for the main loop.
+//
+// Every periodic job is registered once with a period and a priority. Jobs sit in a hashed
+// timer wheel (1 ms ticks, slot = deadline mod WHEEL_SLOTS), so runDue() only looks at the
+// slots the clock moved over since the previous call instead of polling every job; jobs
+// further away than one wheel turn just stay in their slot until their deadline comes round.
+// Jobs that are due together run in priority order. A job that runs more than one period
+// late skips the missed runs (no catch-up burst), keeps its phase and counts them as missed.
+// sleepUntilNext() blocks the calling task until the earliest deadline. With a LoopProfiler
+// attached every job is a profiler stage and every runDue() pass an iteration.
+class Scheduler {
+public:
+    typedef void (*JobFn)();
+
+    enum Priority : uint8_t {
+        PRIORITY_LOW,
+        PRIORITY_NORMAL,
+        PRIORITY_HIGH
+    };
+
+    static constexpr uint8_t MAX_JOBS = 16;
+    static constexpr uint8_t WHEEL_SLOTS = 64;       // power of two, 1 ms per slot
+    static constexpr int8_t INVALID_JOB = -1;
+    static_assert(MAX_JOBS <= LoopProfiler::MAX_STAGES, "one profiler stage per job");
+
+    struct JobStats {
+        const char* name;
+        uint32_t periodMs;
+        Priority priority;
+        uint32_t runs;
+        uint32_t missed;          // periods skipped because the job ran too late
+        uint32_t maxLateMs;       // worst start delay after the deadline
+        uint32_t lastRunUs;
+        uint32_t maxRunUs;
+        uint64_t totalRunUs;
+    };
+
+    Scheduler();
+
+    // Register a periodic job; first run after firstDelayMs. Returns the job id or INVALID_JOB.
+    int8_t add(const char* name, uint32_t periodMs, Priority priority, JobFn fn,
+               unsigned long now, uint32_t firstDelayMs = 0);
+
+    // Profile every job run (stage id = job id); nullptr detaches
+    void setProfiler(LoopProfiler* loopProfiler);
+
+    // Run every job whose deadline has passed; returns how many ran
+    uint8_t runDue(unsigned long now);
+
+    // Milliseconds until the earliest deadline (0 = something is due)
+    uint32_t msUntilNext(unsigned long now) const;
+
+    // Block the calling task until the next deadline, at most maxSleepMs
+    void sleepUntilNext(unsigned long now, uint32_t maxSleepMs = WHEEL_SLOTS);
+
+    uint8_t getJobCount() const { return jobCount; }
+    const JobStats& getStats(uint8_t id) const { return jobs[id].stats; }
+    uint32_t getSleepCount() const { return sleeps; }
+    uint64_t getSleptMs() const { return sleptMs; }
+
+    void printStats() const;
+
+private:
+    struct Job {
+        JobFn fn;
+        unsigned long deadline;
+        int8_t next;              // next job in the same wheel slot
+        JobStats stats;
+    };
+
+    Job jobs[MAX_JOBS];
+    int8_t slots[WHEEL_SLOTS];
+    uint8_t jobCount;
+    unsigned long cursor;         // last tick runDue() looked at
+    unsigned long earliest;       // earliest deadline of all jobs
+    uint32_t sleeps;
+    uint64_t sleptMs;
+    LoopProfiler* profiler;
+
+    static bool reached(unsigned long deadline, unsigned long now) {
+        return static_cast<long>(now - deadline) >= 0;
+    }
+
+    void insert(int8_t id);
+    void unlink(int8_t id);
+    void refreshEarliest();
+};
@@ -0,0 +1,115 @@
+#pragma once
+#include <Arduino.h>
+#include <WiFiUdp.h>
+
+// Non-blocking LAN discovery of the game server.
+//
+// Both discovery paths run at the same time inside one polling loop:
+//  - a DISCOVER-POWERPLANT UDP broadcast (re-sent every DISCOVERY_BROADCAST_INTERVAL_MS);
+//    only datagrams carrying DISCOVERY_REPLY_TOKEN count, never another board's request
+//  - a TCP port sweep of the /24: up to MAX_PARALLEL_CONNECTS non-blocking connects to
+//    port 80 are in flight, preferred hosts first, then the rest of .2-.254
+// A UDP reply or an open port on a host whose ARP entry carries one of the known server MACs
+// names the server. A preferred host with just port 80 open is a candidate: the best-ranked
+// one is tried after a short grace period once every preferred host before it has answered
+// or timed out. Other hosts need a reply or a known MAC (routers and printers serve port 80
+// too). Nothing is taken before it served DISCOVERY_VERIFY_PATH with the token (see
+// discovery_reply.h); a host that does not is skipped and the search goes on. run() blocks
+// the caller for at most timeoutMs plus one check (setup only).
+//
+// The last server that authenticated is kept in NVS with the network it was found on
+// (subnet, gateway, AP BSSID). On the same network revalidateCached() checks just that
+// address, so a normal boot at an event skips the search entirely.
+class ServerDiscovery {
+public:
+    enum Source : uint8_t {
+        SOURCE_NONE,
+        SOURCE_UDP,
+        SOURCE_MAC,          // open port + known MAC
+        SOURCE_PORT          // open port on a preferred host
+    };
+
+    struct Result {
+        IPAddress ip;        // 0.0.0.0 = not found
+        Source source;
+        uint32_t elapsedMs;
+        uint16_t hostsProbed;
+    };
+
+    static constexpr uint8_t MAX_PARALLEL_CONNECTS = 12;   // lwIP has 16 sockets in total
+    static constexpr uint8_t MAX_KNOWN_MACS = 4;
+    static constexpr uint8_t MAX_PREFERRED_HOSTS = 32;
+
+    ServerDiscovery();
+
+    void addKnownMac(const uint8_t mac[6]);
+    void addPreferredHost(uint8_t host);       // last octet, probed before the sweep
+
+    Result run(uint32_t timeoutMs);
+
+    // Probe the remembered server if it was found on the current network; true = use ip
+    bool revalidateCached(uint32_t timeoutMs, IPAddress& ip);
+
+    // Remember a server that authenticated / drop it after it stopped doing so
+    static void rememberServer(const IPAddress& ip);
+    static void forgetServer();
+
+    static const char* sourceName(Source source);
+
+private:
+    struct CachedServer {
+        uint8_t version;
+        uint8_t ip[4];
+        uint8_t network[4];  // ip & mask of the board when the server was found
+        uint8_t gateway[4];
+        uint8_t bssid[6];
+    };
+    static constexpr uint8_t CACHE_VERSION = 1;
+
+    static void describeNetwork(CachedServer& entry);
+    static bool loadCached(CachedServer& entry);
+    // GET DISCOVERY_VERIFY_PATH; true when the answer is the game server's
+    static bool verifyServer(const IPAddress& ip, uint32_t timeoutMs);
+
+    struct Probe {
+        int fd;              // -1 = free slot
+        uint8_t rank;        // index into order
+        unsigned long startedAt;
+    };
+
+    uint8_t knownMacs[MAX_KNOWN_MACS][6];
+    uint8_t knownMacCount;
+    uint8_t preferredHosts[MAX_PREFERRED_HOSTS];
+    uint8_t preferredCount;
+
+    Probe probes[MAX_PARALLEL_CONNECTS];
+    uint8_t order[254];      // probe order of host octets
+    uint8_t orderCount;
+    uint8_t orderPreferred;  // leading entries of order that are preferred hosts
+    uint8_t nextProbe;       // index into order
+    uint8_t subnet[3];
+    uint8_t ownHost;
+    uint16_t hostsProbed;
+    int16_t candidateRank;   // position in order of the best open preferred host, -1 = none
+    unsigned long candidateAt;
+    uint32_t rejectedUdp;    // last UDP replier that failed the check, not tried again
+
+    WiFiUDP udp;
+    bool udpOpen;
+    unsigned long lastBroadcast;
+
+    void buildOrder();
+    // false only when no socket is free (the host is retried later)
+    bool startProbe(Probe& probe, uint8_t rank, unsigned long now);
+    void closeProbe(Probe& probe);
+    // Check in-flight connects; returns a confirmed host (MAC match) or 0
+    uint8_t pollProbes(unsigned long now);
+    bool candidateSettled(unsigned long now) const;
+    // verifyServer() with logging; source only names the path for the log
+    bool accept(const IPAddress& ip, Source source);
+    bool hasKnownMac(uint8_t host) const;
+    IPAddress hostAddress(uint8_t host) const { return IPAddress(subnet[0], subnet[1], subnet[2], host); }
+
+    void sendBroadcast(unsigned long now);
+    bool pollUdp(IPAddress& ip);
+};
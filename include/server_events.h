@@ -0,0 +1,48 @@
+#pragma once
+#include <stdint.h>
+#include <atomic>
+#include "server_events_session.h"
+#include "tls_session_client.h"
+
+// Server-push subscription: a Server-Sent Events stream from the game server.
+//
+// The server announces changes as named events: "ranges", "coefficients", "game" (start /
+// end) and "buildings". They are invalidations, not data: the board still fetches the new
+// state through ESPGameAPI, it just does so at once instead of on the next poll, and the
+// regular poll slows down to a fallback while the stream is up (see GameManager). The
+// library has no push channel or token of its own, so the stream is a separate connection
+// to SERVER_EVENTS_PATH on the API server, identified by board id. It carries no game data,
+// only hints to poll.
+//
+// The connection lives on its own task: connect, subscribe, read events, reconnect with
+// exponential back-off after errors or SERVER_EVENTS_IDLE_TIMEOUT_MS without a byte (the
+// server is expected to send ":" keepalives more often than that). The back-off only resets
+// after a stream stayed up for SERVER_EVENTS_STABLE_MS, so a server that accepts and drops
+// the subscription at once is not hammered every second. On https:// the TLS client is kept
+// by the board across reconnects and resumes its last session (see tls_session_client.h).
+// The session itself, the back-off and the counters are ServerEventsSession
+// (server_events_session.h, host-tested); this class adds the task and the connection.
+class ServerEvents : public ServerEventsSession {
+public:
+    static constexpr uint32_t TASK_STACK = 8192;   // TLS when the server URL is https://
+    static constexpr uint8_t MAX_HOST_LEN = 63;
+    static constexpr int32_t CONNECT_TIMEOUT_MS = 5000;
+
+    ServerEvents();
+
+    // Start the subscription task for the API server at serverUrl (once)
+    bool begin(const char* serverUrl);
+
+    void print() const;
+
+    // Split "scheme://host[:port][/path]"; false if the URL cannot be used
+    static bool parseUrl(const char* url, char* host, uint16_t& port, bool& secure);
+
+private:
+    char url[96];
+    std::atomic<bool> started;
+    TlsSessionClient tls;
+
+    static void taskEntry(void* arg);
+    void run();
+};
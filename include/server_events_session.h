@@ -0,0 +1,208 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include "sse_parser.h"
+
+// Connection-independent core of the server-push subscription (see server_events.h): one
+// subscription over a Link, the reconnect back-off and the counters.
+//
+// A Link is the connection plus the few board services a session needs, so the same code runs
+// on a Client on the board and against a scripted stand-in server in the host tests:
+//   bool connect();                      size_t write(const uint8_t* data, size_t len);
+//   int available();                     int read(uint8_t* buf, size_t size);
+//   bool connected();                    void stop();
+//   unsigned long millis();              void delay(uint32_t ms);
+//   bool online();                       // WiFi up
+//   void log(const char* line);
+//
+// Stream bytes (events and ":" keepalives) only prove the stream itself is alive: they hold
+// off the idle timeout and nothing else; whether the API answers is for its own requests to
+// tell. The counters are atomics, written by the subscription task and read from any other.
+// No Arduino dependencies.
+class ServerEventsSession {
+public:
+    enum Invalidation : uint8_t {
+        INVALIDATE_RANGES = 0x01,
+        INVALIDATE_COEFFICIENTS = 0x02,
+        INVALIDATE_GAME = 0x04,
+        INVALIDATE_BUILDINGS = 0x08
+    };
+
+    static constexpr int32_t RESPONSE_TIMEOUT_MS = 5000;   // status line and headers
+
+    // idleTimeoutMs: reconnect after this long without a byte; a stream that stayed up
+    // stableMs resets the back-off, which otherwise doubles from retryMinMs up to retryMaxMs
+    ServerEventsSession(uint32_t idleTimeoutMs, uint32_t stableMs, uint32_t retryMinMs, uint32_t retryMaxMs)
+        : idleTimeoutMs(idleTimeoutMs), stableMs(stableMs), retryMinMs(retryMinMs), retryMaxMs(retryMaxMs),
+          backoffMs(retryMinMs), subscribed(false), pending(0), lastByteAt(0), connects(0), failures(0),
+          events(0), unknownEvents(0), subscribedAt(0), lastEventAt(0) {}
+
+    // Map an event name to its Invalidation bit, 0 = unknown event
+    static uint8_t invalidationFor(const char* eventName) {
+        if (strcmp(eventName, "ranges") == 0) return INVALIDATE_RANGES;
+        if (strcmp(eventName, "coefficients") == 0) return INVALIDATE_COEFFICIENTS;
+        if (strcmp(eventName, "game") == 0) return INVALIDATE_GAME;
+        if (strcmp(eventName, "buildings") == 0) return INVALIDATE_BUILDINGS;
+        return 0;
+    }
+
+    // One connection: subscribe to path?board=boardId on host and read events until the
+    // server closes, the stream stays silent for idleTimeoutMs or the link goes offline.
+    // Returns how long to wait before the next attempt.
+    template <class Link>
+    uint32_t session(Link& link, const char* host, const char* path, int boardId) {
+        const bool stable = subscribe(link, host, path, boardId) && stream(link, host, path);
+        if (stable) {
+            backoffMs = retryMinMs;
+        } else {
+            failures++;
+            backoffMs = backoffMs * 2 > retryMaxMs ? retryMaxMs : backoffMs * 2;
+        }
+        return backoffMs;
+    }
+
+    bool isSubscribed() const { return subscribed.load(); }
+    // millis() of the last byte read from the stream (events and keepalives), 0 = none yet
+    unsigned long getLastByteAt() const { return lastByteAt.load(); }
+    // Invalidations received since the last call (Invalidation bits)
+    uint8_t takeInvalidations() { return pending.exchange(0); }
+
+    uint32_t getConnects() const { return connects.load(); }
+    uint32_t getFailures() const { return failures.load(); }       // sessions that ended before stableMs
+    uint32_t getEvents() const { return events.load(); }
+    uint32_t getUnknownEvents() const { return unknownEvents.load(); }
+    unsigned long getSubscribedAt() const { return subscribedAt.load(); }
+    unsigned long getLastEventAt() const { return lastEventAt.load(); }   // 0 = none yet
+
+private:
+    uint32_t idleTimeoutMs;
+    uint32_t stableMs;
+    uint32_t retryMinMs;
+    uint32_t retryMaxMs;
+    uint32_t backoffMs;        // subscription task only
+    SseParser parser;          // subscription task only
+
+    std::atomic<bool> subscribed;
+    std::atomic<uint8_t> pending;
+    std::atomic<unsigned long> lastByteAt;
+    std::atomic<uint32_t> connects;
+    std::atomic<uint32_t> failures;
+    std::atomic<uint32_t> events;
+    std::atomic<uint32_t> unknownEvents;
+    std::atomic<unsigned long> subscribedAt;
+    std::atomic<unsigned long> lastEventAt;
+
+    template <class Link, class... Args>
+    static void logf(Link& link, const char* format, Args... args) {
+        char line[192];
+        snprintf(line, sizeof(line), format, args...);
+        link.log(line);
+    }
+
+    // Read one header line (without CR LF) into buf; false on timeout or a dropped connection
+    template <class Link>
+    static bool readLine(Link& link, char* buf, size_t size, unsigned long deadline) {
+        size_t len = 0;
+        while (static_cast<long>(link.millis() - deadline) < 0) {
+            if (!link.available()) {
+                if (!link.connected()) return false;
+                link.delay(10);
+                continue;
+            }
+            uint8_t c;
+            if (link.read(&c, 1) != 1) continue;
+            if (c == '\n') {
+                buf[len] = '\0';
+                return true;
+            }
+            if (c != '\r' && len + 1 < size) buf[len++] = static_cast<char>(c);
+        }
+        return false;
+    }
+
+    // Connect, send the request, check the answer and skip its headers
+    template <class Link>
+    bool subscribe(Link& link, const char* host, const char* path, int boardId) {
+        connects++;
+        if (!link.connect()) {
+            logf(link, "[PUSH] Connect to %s failed", host);
+            return false;
+        }
+
+        // HTTP/1.0: the server streams until it closes, no chunked framing to undo
+        char request[192];
+        const int len = snprintf(request, sizeof(request),
+                                 "GET %s?board=%d HTTP/1.0\r\nHost: %s\r\nAccept: text/event-stream\r\n"
+                                 "Cache-Control: no-cache\r\n\r\n",
+                                 path, boardId, host);
+        link.write(reinterpret_cast<const uint8_t*>(request), len);
+
+        char line[128] = "";
+        const unsigned long deadline = link.millis() + RESPONSE_TIMEOUT_MS;
+        if (!readLine(link, line, sizeof(line), deadline) || strncmp(line, "HTTP/1.", 7) != 0 ||
+            strncmp(line + 8, " 200", 4) != 0) {
+            logf(link, "[PUSH] %s%s refused the subscription: %s", host, path, line);
+            link.stop();
+            return false;
+        }
+        do {
+            if (!readLine(link, line, sizeof(line), deadline)) {
+                link.stop();
+                return false;
+            }
+        } while (line[0] != '\0');
+        return true;
+    }
+
+    // Read events until the stream ends; true if it stayed up stableMs
+    template <class Link>
+    bool stream(Link& link, const char* host, const char* path) {
+        parser.reset();
+        const unsigned long startedAt = link.millis();
+        subscribedAt = startedAt;
+        lastByteAt = startedAt;
+        subscribed = true;
+        // Anything may have changed while the stream was down
+        pending |= INVALIDATE_RANGES | INVALIDATE_COEFFICIENTS;
+        logf(link, "[PUSH] Subscribed to %s%s", host, path);
+
+        uint8_t buf[64];
+        while (link.online()) {
+            const int available = link.available();
+            if (available <= 0) {
+                if (!link.connected()) break;
+                if (link.millis() - lastByteAt.load() >= idleTimeoutMs) {
+                    link.log("[PUSH] Stream silent, reconnecting");
+                    break;
+                }
+                link.delay(20);
+                continue;
+            }
+            const int n = link.read(buf, available < (int)sizeof(buf) ? available : sizeof(buf));
+            if (n <= 0) continue;
+            const unsigned long byteAt = link.millis();
+            lastByteAt = byteAt;
+            for (int i = 0; i < n; i++) {
+                if (!parser.feed(static_cast<char>(buf[i]))) continue;
+                const uint8_t bit = invalidationFor(parser.getEventName());
+                if (!bit) {
+                    unknownEvents++;
+                    continue;
+                }
+                pending |= bit;
+                events++;
+                lastEventAt = byteAt;
+                logf(link, "[PUSH] Event %s", parser.getEventName());
+            }
+        }
+
+        subscribed = false;
+        link.stop();
+        const unsigned long upMs = link.millis() - startedAt;
+        logf(link, "[PUSH] Subscription ended after %lu s, polling until it is back", upMs / 1000);
+        return upMs >= stableMs;
+    }
+};
@@ -0,0 +1,81 @@
+#pragma once
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include <mutex>
+
+// Server-derived lookup tables (ranges, production coefficients, consumption per building type)
+struct ServerTables {
+    static constexpr uint8_t TYPE_SLOTS = 9;             // indexed by source type (0 unused)
+    static constexpr uint16_t BUILDING_TYPE_SLOTS = 256;
+
+    uint32_t generation;                 // bumped on every publish
+    uint16_t rangeMask;                  // bit N = server sent a range for type N
+    float minWatts[TYPE_SLOTS];
+    float maxWatts[TYPE_SLOTS];
+    uint16_t coefficientMask;            // bit N = server sent a production coefficient for type N
+    float productionCoefficient[TYPE_SLOTS];
+    float consumption[BUILDING_TYPE_SLOTS];
+    uint32_t rejectedIds;                // server entries skipped for an out-of-range id, cumulative
+};
+
+// RCU-style double buffer for ServerTables.
+//
+// Writers (API completion callbacks) copy the active tables into the spare buffer, apply their
+// change there and publish it with a single index swap, so readers never see a half-built
+// table (e.g. every range zeroed before the refill). Writers are serialized by a mutex.
+// Readers never block: they copy the active buffer and retry only if a writer recycled that
+// buffer while it was being copied (sequence counter, two publishes within one copy).
+// getGeneration() is a single atomic load for cheap change detection.
+class ServerTableBuffer {
+public:
+    ServerTableBuffer() : activeIndex(0), generation(0) {
+        for (auto& slot : slots) {
+            slot.seq.store(0);
+            memset(&slot.tables, 0, sizeof(slot.tables));
+        }
+    }
+
+    // Build a new version from the current one and publish it; returns the new generation
+    template <typename Builder>
+    uint32_t publish(Builder build) {
+        std::lock_guard<std::mutex> lock(writerMutex);
+        const uint8_t current = activeIndex.load(std::memory_order_acquire);
+        Slot& spare = slots[current ^ 1];
+
+        spare.seq.fetch_add(1, std::memory_order_acq_rel); // odd: being rewritten
+        memcpy(&spare.tables, &slots[current].tables, sizeof(ServerTables));
+        build(spare.tables);
+        spare.tables.generation = slots[current].tables.generation + 1;
+        spare.seq.fetch_add(1, std::memory_order_release); // even: stable again
+
+        activeIndex.store(current ^ 1, std::memory_order_release);
+        generation.store(spare.tables.generation, std::memory_order_release);
+        return spare.tables.generation;
+    }
+
+    // Consistent copy of the active tables
+    void read(ServerTables& out) const {
+        for (;;) {
+            const Slot& slot = slots[activeIndex.load(std::memory_order_acquire)];
+            const uint32_t before = slot.seq.load(std::memory_order_acquire);
+            if (before & 1) continue; // recycled by a writer right now
+            memcpy(&out, &slot.tables, sizeof(ServerTables));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.seq.load(std::memory_order_relaxed) == before) return;
+        }
+    }
+
+    uint32_t getGeneration() const { return generation.load(std::memory_order_acquire); }
+
+private:
+    struct Slot {
+        std::atomic<uint32_t> seq;
+        ServerTables tables;
+    };
+
+    Slot slots[2];
+    std::atomic<uint8_t> activeIndex;
+    std::atomic<uint32_t> generation;
+    std::mutex writerMutex;
+};
@@ -0,0 +1,86 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+// Incremental text/event-stream (Server-Sent Events) parser.
+//
+// Bytes go in one at a time as they come off the socket; feed() returns true when a blank
+// line completed an event, which then stays readable until the next feed(). Understands the
+// "event:" and "data:" fields (several data lines are joined with '\n'), ignores comment
+// lines (":" keepalives), "id:", "retry:" and CR. Over-long names and data are truncated.
+// No Arduino dependencies.
+class SseParser {
+public:
+    static constexpr size_t MAX_NAME = 31;
+    static constexpr size_t MAX_DATA = 191;
+    static constexpr size_t MAX_LINE = MAX_DATA + 8;
+
+    SseParser() { reset(); }
+
+    void reset() {
+        lineLen = 0;
+        name[0] = '\0';
+        data[0] = '\0';
+        dataLen = 0;
+        hasData = false;
+        eventName[0] = '\0';
+        eventData[0] = '\0';
+    }
+
+    bool feed(char c) {
+        if (c == '\r') return false;
+        if (c != '\n') {
+            if (lineLen < MAX_LINE) line[lineLen++] = c;
+            return false;
+        }
+        line[lineLen] = '\0';
+        const size_t len = lineLen;
+        lineLen = 0;
+        if (len > 0) {
+            parseLine(len);
+            return false;
+        }
+
+        // Blank line: dispatch (an event with neither a name nor data is just a separator)
+        if (!hasData && name[0] == '\0') return false;
+        strcpy(eventName, name[0] ? name : "message");
+        strcpy(eventData, data);
+        name[0] = '\0';
+        data[0] = '\0';
+        dataLen = 0;
+        hasData = false;
+        return true;
+    }
+
+    const char* getEventName() const { return eventName; }
+    const char* getEventData() const { return eventData; }
+
+private:
+    char line[MAX_LINE + 1];
+    size_t lineLen;
+    char name[MAX_NAME + 1];
+    char data[MAX_DATA + 1];
+    size_t dataLen;
+    bool hasData;
+    char eventName[MAX_NAME + 1];
+    char eventData[MAX_DATA + 1];
+
+    void parseLine(size_t len) {
+        if (line[0] == ':') return;   // comment / keepalive
+        const char* colon = strchr(line, ':');
+        const size_t fieldLen = colon ? static_cast<size_t>(colon - line) : len;
+        const char* value = colon ? colon + 1 : line + len;
+        if (*value == ' ') value++;
+
+        if (fieldLen == 5 && strncmp(line, "event", 5) == 0) {
+            strncpy(name, value, MAX_NAME);
+            name[MAX_NAME] = '\0';
+        } else if (fieldLen == 4 && strncmp(line, "data", 4) == 0) {
+            if (hasData && dataLen < MAX_DATA) data[dataLen++] = '\n';
+            while (*value && dataLen < MAX_DATA) data[dataLen++] = *value++;
+            data[dataLen] = '\0';
+            hasData = true;
+        }
+    }
+};
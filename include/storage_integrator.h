@@ -0,0 +1,96 @@
+#pragma once
+#include <stdint.h>
+
+// State of charge of one storage type (battery, hydro storage).
+//
+// Time is cut into fixed STEP_MS steps; the signed power of one unit (+ = discharging into
+// the grid, - = charging) is held constant between two advance() calls, so the whole steps
+// that elapsed are integrated in one multiply and the sub-step remainder carries over. Every
+// call therefore costs the same no matter how long the gap was, and the result is identical
+// to stepping one STEP_MS at a time with a clamp after each step (the power does not change
+// sign within a call). Each unit stores capacityPerUnitWh; with power and capacity both per
+// unit the SoC does not depend on how many units are connected, the count only scales the
+// stored energy. No Arduino dependencies: compiles on the host.
+class StorageIntegrator {
+public:
+    static constexpr uint16_t STEP_MS = 100;
+    static constexpr uint32_t MAX_STEPS_PER_ADVANCE = 100;   // gaps over 10 s are not integrated
+
+    enum Boundary : uint8_t {
+        BOUNDARY_NONE,
+        BOUNDARY_EMPTY,
+        BOUNDARY_FULL
+    };
+
+    explicit StorageIntegrator(float initialSoc = 0.5f)
+        : initialSoc(clampSoc(initialSoc)), soc(this->initialSoc), capacityPerUnitWh(0.0f),
+          units(0), powerPerUnitW(0.0f), started(false), lastTick(0), steps(0), droppedSteps(0) {}
+
+    // Capacity of one unit and number of connected units
+    void configure(float capacityWh, uint8_t unitCount) {
+        capacityPerUnitWh = capacityWh > 0.0f ? capacityWh : 0.0f;
+        units = unitCount;
+    }
+
+    // Signed power of one unit until the next advance()
+    void setPower(float watts) { powerPerUnitW = watts; }
+
+    // Integrate the whole steps elapsed up to now; returns the number of steps taken
+    uint32_t advance(unsigned long now) {
+        if (!started) {
+            started = true;
+            lastTick = now;
+            return 0;
+        }
+        uint32_t n = static_cast<uint32_t>(now - lastTick) / STEP_MS;
+        if (n == 0) return 0;
+        lastTick += n * STEP_MS;
+        steps += n;
+        if (n > MAX_STEPS_PER_ADVANCE) {
+            droppedSteps += n - MAX_STEPS_PER_ADVANCE;
+            n = MAX_STEPS_PER_ADVANCE;
+        }
+        if (units == 0 || capacityPerUnitWh <= 0.0f || powerPerUnitW == 0.0f) return n;
+
+        const float hours = static_cast<float>(n * STEP_MS) / 3600000.0f;
+        soc = clampSoc(soc - powerPerUnitW * hours / capacityPerUnitWh);
+        return n;
+    }
+
+    // Power one unit may actually deliver: nothing out of an empty store, nothing into a full one
+    float limitPower(float watts) const {
+        if (capacityPerUnitWh <= 0.0f) return watts;
+        if (watts > 0.0f && soc <= 0.0f) return 0.0f;
+        if (watts < 0.0f && soc >= 1.0f) return 0.0f;
+        return watts;
+    }
+
+    // Back to the initial SoC (new game)
+    void reset() {
+        soc = initialSoc;
+        started = false;
+    }
+
+    float getSoc() const { return soc; }
+    float getEnergyWh() const { return soc * capacityPerUnitWh * units; }
+    float getCapacityWh() const { return capacityPerUnitWh * units; }
+    uint8_t getUnits() const { return units; }
+    Boundary getBoundary() const {
+        return soc <= 0.0f ? BOUNDARY_EMPTY : (soc >= 1.0f ? BOUNDARY_FULL : BOUNDARY_NONE);
+    }
+    uint32_t getSteps() const { return steps; }
+    uint32_t getDroppedSteps() const { return droppedSteps; }
+
+private:
+    float initialSoc;
+    float soc;                  // 0.0 empty .. 1.0 full
+    float capacityPerUnitWh;
+    uint8_t units;
+    float powerPerUnitW;
+    bool started;
+    unsigned long lastTick;     // time up to which steps were integrated
+    uint32_t steps;
+    uint32_t droppedSteps;
+
+    static float clampSoc(float v) { return v < 0.0f ? 0.0f : (v > 1.0f ? 1.0f : v); }
+};
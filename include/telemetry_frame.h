@@ -0,0 +1,152 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+// Binary live-telemetry frame (WebSocket binary message), all integers little-endian:
+//
+//   offset size
+//   0      2    magic 'E' 'A'
+//   2      1    version (2)
+//   3      1    kind: 0 = key frame (every field), 1 = delta (changed fields only)
+//   4      4    sequence, per subscriber, +1 per frame
+//   8      4    board uptime in ms
+//   12     8    field mask, bit N = field N follows
+//   20     4*k  int32 values of the fields in the mask, ascending field order
+//
+// A key frame is 164 bytes, a delta 20 + 4 per changed field; an empty delta is a
+// heartbeat. Units are fixed-point (see Field), so equal readings encode to equal values
+// and an unchanged field never shows up in a delta. decode() is the client side (host
+// tools, tests). No Arduino dependencies.
+struct TelemetrySnapshot {
+    enum Field : uint8_t {
+        FIELD_PRODUCTION,                              // total production, 0.1 W
+        FIELD_CONSUMPTION,                             // total consumption, 0.1 W
+        FIELD_TYPE_POWER,                              // + (type - 1) for types 1..8, 0.1 W
+        FIELD_TYPE_PERCENT = FIELD_TYPE_POWER + 8,     // encoder setting per type, 0.1 %
+        FIELD_TYPE_AMOUNT = FIELD_TYPE_PERCENT + 8,    // connected plants per type
+        FIELD_BATTERY_SOC = FIELD_TYPE_AMOUNT + 8,     // 0.1 %
+        FIELD_HYDRO_STORAGE_SOC,                       // 0.1 %
+        FIELD_LINK_FLAGS,                              // LINK_* bits
+        FIELD_WIFI_RSSI,                               // dBm, 0 while disconnected
+        FIELD_GAME_RUN_US,                             // duration of the last game job run
+        FIELD_MISSED_PERIODS,                          // scheduler periods missed since boot
+        FIELD_STATUS_MS,                               // last ESP-API status exchange (update()), ms
+        FIELD_STATUS_P99_MS,                           // p99 of the successful status exchanges, ms
+        FIELD_POLL_P99_MS,                             // p99 of the successful state poll requests, ms
+        FIELD_REQUEST_FAILURES,                        // failed and lost API requests since boot
+        FIELD_COUNT
+    };
+
+    enum LinkFlag : uint8_t {
+        LINK_WIFI = 0x01,
+        LINK_SERVER = 0x02,          // server answered recently
+        LINK_RETRANSLATION = 0x04,   // retranslation station alive on UART
+        LINK_GAME_ACTIVE = 0x08
+    };
+
+    int32_t fields[FIELD_COUNT];
+
+    TelemetrySnapshot() { memset(fields, 0, sizeof(fields)); }
+
+    // Fixed-point helper: round value * scale to the nearest integer
+    static int32_t scaled(float value, float scale) {
+        const float v = value * scale;
+        return static_cast<int32_t>(v < 0.0f ? v - 0.5f : v + 0.5f);
+    }
+
+    // Bit N set = field N differs from other
+    uint64_t diff(const TelemetrySnapshot& other) const {
+        uint64_t mask = 0;
+        for (uint8_t i = 0; i < FIELD_COUNT; i++) {
+            if (fields[i] != other.fields[i]) mask |= 1ull << i;
+        }
+        return mask;
+    }
+};
+
+class TelemetryFrame {
+public:
+    static constexpr uint8_t MAGIC_0 = 'E';
+    static constexpr uint8_t MAGIC_1 = 'A';
+    static constexpr uint8_t VERSION = 2;
+    static constexpr uint8_t KIND_KEY = 0;
+    static constexpr uint8_t KIND_DELTA = 1;
+    static constexpr size_t HEADER_SIZE = 20;
+    static constexpr size_t MAX_SIZE = HEADER_SIZE + 4 * TelemetrySnapshot::FIELD_COUNT;
+    static constexpr uint64_t ALL_FIELDS = 0xFFFFFFFFFFFFFFFFull >> (64 - TelemetrySnapshot::FIELD_COUNT);
+
+    static_assert(TelemetrySnapshot::FIELD_COUNT <= 64, "field mask is 64 bits");
+
+    // Encode current as a key frame (baseline nullptr) or as a delta against baseline.
+    // out must hold MAX_SIZE bytes; returns the frame length.
+    static size_t encode(const TelemetrySnapshot& current, const TelemetrySnapshot* baseline, uint32_t sequence,
+                         uint32_t uptimeMs, uint8_t* out) {
+        const uint64_t mask = baseline ? current.diff(*baseline) : ALL_FIELDS;
+        out[0] = MAGIC_0;
+        out[1] = MAGIC_1;
+        out[2] = VERSION;
+        out[3] = baseline ? KIND_DELTA : KIND_KEY;
+        put32(out + 4, sequence);
+        put32(out + 8, uptimeMs);
+        put32(out + 12, static_cast<uint32_t>(mask));
+        put32(out + 16, static_cast<uint32_t>(mask >> 32));
+        size_t len = HEADER_SIZE;
+        for (uint8_t i = 0; i < TelemetrySnapshot::FIELD_COUNT; i++) {
+            if (!(mask & (1ull << i))) continue;
+            put32(out + len, static_cast<uint32_t>(current.fields[i]));
+            len += 4;
+        }
+        return len;
+    }
+
+    struct Header {
+        uint8_t kind;
+        uint32_t sequence;
+        uint32_t uptimeMs;
+        uint64_t mask;
+    };
+
+    // Apply a received frame to the client's copy of the snapshot: a key frame sets every
+    // field, a delta the fields in its mask. A malformed frame (magic, version, kind, a length
+    // that does not match the mask, a key frame without every field) returns false and
+    // leaves state untouched. Sequence gaps are for the caller to check in header.
+    static bool decode(const uint8_t* data, size_t len, TelemetrySnapshot& state, Header* header = nullptr) {
+        if (len < HEADER_SIZE || data[0] != MAGIC_0 || data[1] != MAGIC_1 || data[2] != VERSION) return false;
+        const uint8_t kind = data[3];
+        const uint64_t mask = get32(data + 12) | static_cast<uint64_t>(get32(data + 16)) << 32;
+        if (kind > KIND_DELTA || (mask & ~ALL_FIELDS) || (kind == KIND_KEY && mask != ALL_FIELDS)) return false;
+        size_t expected = HEADER_SIZE;
+        for (uint8_t i = 0; i < TelemetrySnapshot::FIELD_COUNT; i++) {
+            if (mask & (1ull << i)) expected += 4;
+        }
+        if (len != expected) return false;
+
+        size_t pos = HEADER_SIZE;
+        for (uint8_t i = 0; i < TelemetrySnapshot::FIELD_COUNT; i++) {
+            if (!(mask & (1ull << i))) continue;
+            state.fields[i] = static_cast<int32_t>(get32(data + pos));
+            pos += 4;
+        }
+        if (header) {
+            header->kind = kind;
+            header->sequence = get32(data + 4);
+            header->uptimeMs = get32(data + 8);
+            header->mask = mask;
+        }
+        return true;
+    }
+
+private:
+    static void put32(uint8_t* p, uint32_t v) {
+        p[0] = static_cast<uint8_t>(v);
+        p[1] = static_cast<uint8_t>(v >> 8);
+        p[2] = static_cast<uint8_t>(v >> 16);
+        p[3] = static_cast<uint8_t>(v >> 24);
+    }
+
+    static uint32_t get32(const uint8_t* p) {
+        return static_cast<uint32_t>(p[0]) | static_cast<uint32_t>(p[1]) << 8 | static_cast<uint32_t>(p[2]) << 16 |
+               static_cast<uint32_t>(p[3]) << 24;
+    }
+};
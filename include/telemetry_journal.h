@@ -0,0 +1,125 @@
+#pragma once
+#include <stdint.h>
+#include <stdio.h>
+#include <mutex>
+
+// One journaled telemetry window
+struct JournalRecord {
+    uint32_t endMs;             // millis() when the window closed
+    uint32_t durationMs;
+    float productionMean;       // W, time-weighted
+    float productionMax;
+    float consumptionMean;
+};
+
+// Fixed-capacity ring of telemetry windows recorded while the server is unreachable.
+//
+// push() never fails: when the ring is full the oldest record is overwritten and counted as
+// dropped, so a long outage keeps its most recent part. Records come out oldest first in
+// batches; every record has a sequence number (records ever removed before it), so a batch
+// acknowledged after newer pushes overwrote part of it only removes what it delivered.
+// No allocation after construction, no Arduino dependencies; the caller serialises access.
+template <uint16_t Capacity>
+class TelemetryJournal {
+public:
+    TelemetryJournal() { clear(); }
+
+    void push(const JournalRecord& record) {
+        if (count == Capacity) {
+            head = next(head);
+            count--;
+            dropped++;
+            removed++;
+        }
+        records[(head + count) % Capacity] = record;
+        count++;
+        recorded++;
+    }
+
+    // Copy up to maxRecords of the oldest records into out without removing them;
+    // firstSequence receives the sequence number of out[0]
+    uint16_t peek(JournalRecord* out, uint16_t maxRecords, uint32_t* firstSequence = nullptr) const {
+        const uint16_t n = maxRecords < count ? maxRecords : count;
+        for (uint16_t i = 0; i < n; i++) out[i] = records[(head + i) % Capacity];
+        if (firstSequence) *firstSequence = removed;
+        return n;
+    }
+
+    // Remove the n oldest records (after they were delivered)
+    void pop(uint16_t n) {
+        if (n > count) n = count;
+        head = static_cast<uint16_t>((head + n) % Capacity);
+        count -= n;
+        removed += n;
+    }
+
+    // A peeked batch was delivered: remove whatever of it is still in the ring
+    void ack(uint32_t firstSequence, uint16_t n) {
+        const int32_t remaining = static_cast<int32_t>(firstSequence + n - removed);
+        if (remaining > 0) pop(static_cast<uint16_t>(remaining));
+    }
+
+    void clear() {
+        head = 0;
+        count = 0;
+        recorded = 0;
+        dropped = 0;
+        removed = 0;
+    }
+
+    uint16_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    static constexpr uint16_t capacity() { return Capacity; }
+    uint32_t getRecorded() const { return recorded; }
+    uint32_t getDropped() const { return dropped; }
+
+private:
+    JournalRecord records[Capacity];
+    uint16_t head;              // oldest record
+    uint16_t count;
+    uint32_t recorded;
+    uint32_t dropped;           // overwritten before delivery
+    uint32_t removed;           // popped + dropped = sequence number of the oldest record
+
+    static uint16_t next(uint16_t index) { return static_cast<uint16_t>((index + 1) % Capacity); }
+};
+
+// Body of a journal backfill upload: the records oldest first, each with its age at send
+// time (ms before now), so the server can place the window although the board has no clock:
+//   {"board":1,"records":[{"age_ms":..,"duration_ms":..,"production_mean":..,
+//    "production_max":..,"consumption_mean":..},...]}
+// Returns the length, 0 if out is too small.
+inline size_t formatJournalBatch(const JournalRecord* records, uint16_t n, int boardId, uint32_t now, char* out,
+                                 size_t capacity) {
+    int len = snprintf(out, capacity, "{\"board\":%d,\"records\":[", boardId);
+    for (uint16_t i = 0; i < n && len > 0 && static_cast<size_t>(len) < capacity; i++) {
+        const JournalRecord& r = records[i];
+        len += snprintf(out + len, capacity - len,
+                        "%s{\"age_ms\":%lu,\"duration_ms\":%lu,\"production_mean\":%.2f,\"production_max\":%.2f,"
+                        "\"consumption_mean\":%.2f}",
+                        i ? "," : "", (unsigned long)(now - r.endMs), (unsigned long)r.durationMs,
+                        r.productionMean, r.productionMax, r.consumptionMean);
+    }
+    if (len > 0 && static_cast<size_t>(len) < capacity) len += snprintf(out + len, capacity - len, "]}");
+    return len > 0 && static_cast<size_t>(len) < capacity ? static_cast<size_t>(len) : 0;
+}
+
+// One backfill step, called off the loop task: hand the oldest batch (up to MaxBatch records)
+// to sink.send(records, n, now) without holding the lock, then acknowledge it if the send
+// succeeded. Returns the records delivered, 0 when the journal was empty, -1 when the send
+// failed (the batch stays queued).
+template <uint16_t MaxBatch, uint16_t Capacity, typename Sink>
+int replayJournalBatch(TelemetryJournal<Capacity>& journal, std::mutex& mutex, Sink& sink, uint32_t now) {
+    JournalRecord batch[MaxBatch];
+    uint32_t firstSequence;
+    uint16_t n;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        n = journal.peek(batch, MaxBatch, &firstSequence);
+    }
+    if (n == 0) return 0;
+    if (!sink.send(batch, n, now)) return -1;
+    std::lock_guard<std::mutex> lock(mutex);
+    journal.ack(firstSequence, n);
+    return n;
+}
@@ -0,0 +1,80 @@
+#pragma once
+#include <stdint.h>
+#include <atomic>
+#include <WiFiClient.h>
+#include <mbedtls/net_sockets.h>
+#include <mbedtls/ssl.h>
+#include <mbedtls/entropy.h>
+#include <mbedtls/ctr_drbg.h>
+
+// TLS client for the board's own connections to the game server (server-push stream, journal
+// backfill) that resumes its last session instead of paying a full handshake every time.
+//
+// WiFiClientSecure in Arduino-ESP32 2.x cannot offer a saved session, so this is a small
+// Client on mbedtls directly: certificates are not verified (like setInsecure() and the API
+// client), the session of every full handshake is kept and offered on the next connect (session
+// ticket, or the server's session cache by ID), and it is persisted to NVS under nvsKey so the
+// first connection after a reboot can resume too. The socket has TCP keepalive on, so a
+// long-lived stream notices a dead peer. A resumed handshake is recognised by its master
+// secret matching the offered session. The counters are atomics, readable from any task;
+// everything else belongs to the task that owns the connection.
+class TlsSessionClient : public Client {
+public:
+    static constexpr size_t MAX_SAVED_SESSION = 2048;   // serialized session kept in NVS
+
+    explicit TlsSessionClient(const char* nvsKey);
+    ~TlsSessionClient();
+
+    int connect(IPAddress ip, uint16_t port) override;
+    int connect(const char* host, uint16_t port) override;
+    size_t write(uint8_t b) override { return write(&b, 1); }
+    size_t write(const uint8_t* buf, size_t size) override;
+    int available() override;
+    int read() override;
+    int read(uint8_t* buf, size_t size) override;
+    int peek() override;
+    void flush() override {}
+    void stop() override;
+    uint8_t connected() override { return open; }
+    operator bool() override { return open; }
+
+    void setHandshakeTimeout(uint32_t ms) { handshakeTimeoutMs = ms; }
+    // Drop the saved session (RAM and NVS): the next connect does a full handshake
+    void forgetSession();
+
+    uint32_t getHandshakes() const { return handshakes.load(); }        // successful, full or resumed
+    uint32_t getResumed() const { return resumed.load(); }
+    uint32_t getFailedHandshakes() const { return failedHandshakes.load(); }
+    uint32_t getLastHandshakeMs() const { return lastHandshakeMs.load(); }
+    uint32_t getFullHandshakeMsTotal() const { return fullHandshakeMs.load(); }
+    uint32_t getResumedHandshakeMsTotal() const { return resumedHandshakeMs.load(); }
+
+    void print(const char* tag) const;
+
+private:
+    char nvsKey[16];
+    mbedtls_net_context net;
+    mbedtls_ssl_context ssl;
+    mbedtls_ssl_config conf;
+    mbedtls_entropy_context entropy;
+    mbedtls_ctr_drbg_context drbg;
+    mbedtls_ssl_session saved;
+    bool seeded;
+    bool haveSession;
+    bool sessionLoaded;        // NVS checked since boot
+    bool open;
+    int peeked;                // byte read ahead by peek() / available(), -1 = none
+    uint32_t handshakeTimeoutMs;
+
+    std::atomic<uint32_t> handshakes;
+    std::atomic<uint32_t> resumed;
+    std::atomic<uint32_t> failedHandshakes;
+    std::atomic<uint32_t> lastHandshakeMs;
+    std::atomic<uint32_t> fullHandshakeMs;
+    std::atomic<uint32_t> resumedHandshakeMs;
+
+    bool setup(const char* host);
+    void loadSession();
+    void storeSession();
+    int readSome(uint8_t* buf, size_t size);
+};
@@ -13,6 +13,22 @@ namespace UartProtocol {
     static constexpr uint8_t CMD_ON  = 0x01;  // turn ON
     static constexpr uint8_t CMD_OFF = 0x02;  // turn OFF
     
+    // Battery / solar state commands
+    static constexpr uint8_t CMD_BATTERY_IDLE      = 0x03; // battery -> idle (solar: green)
+    static constexpr uint8_t CMD_BATTERY_CHARGE    = 0x04; // battery -> charge/consume
+    static constexpr uint8_t CMD_BATTERY_DISCHARGE = 0x05; // battery -> discharge/produce
+    
+    // Gas flame levels: level 1..10 -> 0x06..0x0F
+    static constexpr uint8_t CMD_GAS_LEVEL_1  = 0x06;
+    static constexpr uint8_t CMD_GAS_LEVEL_10 = 0x0F;
+    
+    // Hydro storage levels (5 levels)
+    static constexpr uint8_t CMD_HYDRO_STORAGE_LEVEL_1 = 0x0B; // 100% Full - Green
+    static constexpr uint8_t CMD_HYDRO_STORAGE_LEVEL_2 = 0x0C; // 75% Full - Light Green
+    static constexpr uint8_t CMD_HYDRO_STORAGE_LEVEL_3 = 0x0D; // 50% Full - Orange
+    static constexpr uint8_t CMD_HYDRO_STORAGE_LEVEL_4 = 0x0E; // 25% Full - Light Red
+    static constexpr uint8_t CMD_HYDRO_STORAGE_LEVEL_5 = 0x0F; // 0% Empty - Red
+    
     // Frame structure constants
     static constexpr uint8_t MIN_FRAME_SIZE = 5; // SYNC1 + SYNC2 + LEN + CRC16_H + CRC16_L
     static constexpr uint8_t MAX_PAYLOAD_SIZE_MASTER = 250;
@@ -0,0 +1,81 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+// Raw NFC UID as read from the card (ISO 14443-3: single, double or triple size)
+struct RawUid {
+    static constexpr uint8_t MAX_BYTES = 10;
+
+    uint8_t len;                 // 4, 7 or 10
+    uint8_t bytes[MAX_BYTES];    // unused tail is zero
+
+    bool operator==(const RawUid& other) const;
+    bool operator!=(const RawUid& other) const { return !(*this == other); }
+};
+
+// Small handle for an interned building UID (index into the store table)
+typedef uint8_t UidHandle;
+
+// Interned building UIDs in a fixed table.
+//
+// The registry, ESP-API and NFC callbacks speak hex text; inside the firmware a building is
+// a one-byte handle to its raw UID bytes, so lookups are a short memcmp over a flat table
+// instead of string hashing and map copies. Text is parsed once when a UID enters and
+// formatted only where it leaves (API upload, registry calls, logs). The text format seen on
+// the way in (case, byte separator) is remembered per entry so the round trip is exact.
+class UidStore {
+public:
+    static constexpr uint8_t CAPACITY = 128;   // one per connected consumer the API accepts
+    static constexpr UidHandle INVALID = 0xFF;
+    static constexpr size_t MAX_TEXT_LEN = RawUid::MAX_BYTES * 3 - 1; // "AA:BB:..." without NUL
+
+    // Text format flags
+    static constexpr uint8_t FORMAT_LOWERCASE = 0x80;
+    static constexpr uint8_t FORMAT_SEPARATOR_MASK = 0x7F; // separator character, 0 = none
+
+    // Parse hex text ("04A1B2C3", "04:a1:b2:c3", "04 A1 B2 C3") into raw bytes.
+    // Fails on anything that is not a 4/7/10-byte UID; format receives the text style.
+    static bool parse(const char* text, size_t len, RawUid& out, uint8_t& format);
+
+    // Write the UID as text in the given style (NUL-terminated); returns the length or 0
+    static size_t format(const RawUid& uid, uint8_t format, char* out, size_t capacity);
+
+    UidStore();
+
+    // Add a UID (or update the building type of a known one); INVALID when the table is full
+    UidHandle intern(const RawUid& uid, uint8_t buildingType, uint8_t format = 0);
+    // Parse and add; INVALID when the text is not a UID or the table is full
+    UidHandle intern(const char* text, size_t len, uint8_t buildingType);
+
+    UidHandle find(const RawUid& uid) const;
+    UidHandle find(const char* text, size_t len) const;
+
+    // Drop one entry; the handle may be reused by the next intern
+    bool release(UidHandle handle);
+    void clear();
+
+    bool isValid(UidHandle handle) const { return handle < CAPACITY && entries[handle].uid.len != 0; }
+    const RawUid& getUid(UidHandle handle) const { return entries[handle].uid; }
+    uint8_t getBuildingType(UidHandle handle) const { return entries[handle].buildingType; }
+    uint8_t getFormat(UidHandle handle) const { return entries[handle].format; }
+
+    // Hex text of an entry in its original style; returns the length or 0
+    size_t toText(UidHandle handle, char* out, size_t capacity) const;
+
+    uint8_t size() const { return count; }
+    uint32_t getRejectedCount() const { return rejected; }   // unparsable text or table full
+
+private:
+    struct Entry {
+        uint32_t key;            // first bytes + length, compared before the full UID
+        RawUid uid;
+        uint8_t buildingType;
+        uint8_t format;
+    };
+
+    Entry entries[CAPACITY];
+    uint8_t count;
+    uint32_t rejected;
+
+    static uint32_t keyOf(const RawUid& uid);
+};
@@ -0,0 +1,63 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <array>
+#include <vector>
+
+// Reusable list for the ESP-API upload callbacks.
+//
+// The storage is reserved once at construction; clearing and refilling it on every upload
+// never touches the heap. An item past the capacity is dropped and counted instead of
+// growing the vector. No Arduino dependencies.
+template <typename T>
+class UploadList {
+public:
+    explicit UploadList(size_t capacity) : dropped(0), fillDropped(0) { items.reserve(capacity); }
+
+    void clear() {
+        items.clear();
+        fillDropped = 0;
+    }
+
+    bool push(const T& item) {
+        if (items.size() == items.capacity()) {
+            drop(1);
+            return false;
+        }
+        items.push_back(item);
+        return true;
+    }
+
+    // Count items that did not fit without offering them one by one
+    void drop(uint32_t count) {
+        dropped += count;
+        fillDropped += count;
+    }
+
+    const std::vector<T>& get() const { return items; }
+    size_t size() const { return items.size(); }
+    size_t capacity() const { return items.capacity(); }
+    uint32_t getDropped() const { return dropped; }          // since boot
+    uint32_t getFillDropped() const { return fillDropped; }  // since the last clear()
+
+private:
+    std::vector<T> items;
+    uint32_t dropped;
+    uint32_t fillDropped;
+};
+
+// Refill `out` with one item per unit of counts[type], built by make(type). Units past the
+// capacity are counted as dropped.
+template <typename T, typename Count, size_t N, typename Make>
+void fillFromCounts(UploadList<T>& out, const std::array<Count, N>& counts, Make make) {
+    out.clear();
+    for (size_t type = 0; type < N; type++) {
+        for (uint32_t n = counts[type]; n > 0; n--) {
+            if (!out.push(make(type))) {
+                out.drop(n - 1);
+                for (type++; type < N; type++) out.drop(counts[type]);
+                return;
+            }
+        }
+    }
+}
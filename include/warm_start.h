@@ -0,0 +1,101 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include "uid_store.h"
+
+// Last-known game state persisted to NVS so that a reboot, brownout or OTA update comes back
+// with usable ranges, coefficients, buildings and inventory long before WiFi and the server
+// are up. The server stays authoritative: restored values are overwritten as soon as it answers.
+//
+// Record layout (little endian, packed):
+//   [MAGIC 'W''S'][VERSION][FLAGS][PAYLOAD_LEN u16][CRC16 u16][PAYLOAD...]
+// PAYLOAD:
+//   rangeMask u16        + {min f32, max f32} per set bit
+//   coefficientMask u16  + {coefficient f32} per set bit
+//   inventoryMask u16    + {amount u8} per set bit
+//   consumptionCount u8  + {buildingType u8, consumption f32}
+//   buildingCount u8     + {buildingType u8, uidFormat u8, uidLen u8, uid[uidLen]} (raw UID bytes)
+// CRC16-CCITT covers FLAGS and the payload. A record with a different version is ignored.
+struct WarmStartState {
+    static constexpr uint8_t TYPE_SLOTS = 9;          // indexed by slave / source type (0 unused)
+    static constexpr uint8_t MAX_CONSUMPTION = 32;    // building types with a consumption value
+    static constexpr uint8_t MAX_BUILDINGS = UidStore::CAPACITY; // every interned building
+
+    struct Consumption {
+        uint8_t buildingType;
+        float consumption;
+    };
+
+    struct Building {
+        uint8_t buildingType;
+        uint8_t uidFormat;                    // UidStore text style, restores the exact registry text
+        RawUid uid;
+    };
+
+    bool gameActive;
+    uint16_t rangeMask;                       // bit N = type N has a server range
+    float minWatts[TYPE_SLOTS];
+    float maxWatts[TYPE_SLOTS];
+    uint16_t coefficientMask;                 // bit N = type N has a production coefficient
+    float productionCoefficient[TYPE_SLOTS];
+    uint16_t inventoryMask;                   // bit N = type N reported by the retranslation station
+    uint8_t inventory[TYPE_SLOTS];
+    uint8_t consumptionCount;
+    Consumption consumption[MAX_CONSUMPTION];
+    uint8_t buildingCount;
+    Building buildings[MAX_BUILDINGS];
+
+    void clear();
+
+    // Append helpers; return false when the fixed capacity is exhausted
+    bool addConsumption(uint8_t buildingType, float value);
+    bool addBuilding(uint8_t buildingType, const RawUid& uid, uint8_t uidFormat);
+};
+
+class WarmStart {
+public:
+    static constexpr uint8_t RECORD_VERSION = 3;
+    static constexpr size_t HEADER_SIZE = 8;
+    static constexpr size_t MAX_RECORD_SIZE = HEADER_SIZE
+        + 2 + WarmStartState::TYPE_SLOTS * 8
+        + 2 + WarmStartState::TYPE_SLOTS * 4
+        + 2 + WarmStartState::TYPE_SLOTS
+        + 1 + WarmStartState::MAX_CONSUMPTION * 5
+        + 1 + WarmStartState::MAX_BUILDINGS * (3 + RawUid::MAX_BYTES);
+    static constexpr unsigned long MIN_WRITE_INTERVAL_MS = 60000; // flash wear limit
+
+    // Serialize / parse a record; encode returns the record length, decode validates magic,
+    // version, length and CRC before touching the output
+    static size_t encode(const WarmStartState& state, uint8_t* out, size_t capacity);
+    static bool decode(const uint8_t* data, size_t length, WarmStartState& state);
+
+    WarmStart();
+
+    // Read the stored record from NVS; false if missing, stale version or corrupt
+    bool load(WarmStartState& state);
+
+    // Persist the state if its encoding differs from what is stored and at least
+    // MIN_WRITE_INTERVAL_MS passed since the last write (force skips the interval).
+    // Returns true when flash was written.
+    bool save(const WarmStartState& state, unsigned long now, bool force = false);
+
+    // True when the write interval allows another flash write
+    bool isWriteAllowed(unsigned long now) const {
+        return !wroteOnce || now - lastWriteTime >= MIN_WRITE_INTERVAL_MS;
+    }
+
+    // Remove the stored record
+    void erase();
+
+    uint32_t getWriteCount() const { return writeCount; }
+    uint32_t getUnchangedCount() const { return unchangedCount; }
+    size_t getLastRecordSize() const { return lastRecordSize; }
+
+private:
+    size_t storedLength;         // length of the record in flash (copy kept for save()), 0 = unknown
+    bool wroteOnce;
+    unsigned long lastWriteTime;
+    uint32_t writeCount;
+    uint32_t unchangedCount;
+    size_t lastRecordSize;
+};
@@ -0,0 +1,83 @@
+#pragma once
+#include <stdint.h>
+
+// Summary of one upload window
+struct WindowStats {
+    uint32_t samples;
+    uint32_t durationMs;
+    float min;
+    float max;
+    float mean;          // time-weighted: energy / duration (last value for an empty window)
+    float last;
+    float energyWh;      // integral of the value over the window (value in W)
+};
+
+// Streaming min / mean / max / energy over a window of samples.
+//
+// Each sample holds until the next one (zero-order hold), so the energy integral counts every
+// value for exactly the time it was current and the mean is time-weighted: a 50 ms spike is
+// worth 50 ms no matter how the samples are spaced. close() ends the window and starts the
+// next one at the same instant with the last value still current, so windows tile without
+// gaps. O(1) per sample, no Arduino dependencies.
+class WindowAggregator {
+public:
+    WindowAggregator() : started(false), windowStart(0), lastTime(0), lastValue(0.0f) { resetWindow(); }
+
+    void add(float value, unsigned long now) {
+        if (!started) {
+            started = true;
+            windowStart = now;
+            lastTime = now;
+        }
+        accumulate(now);
+        lastValue = value;
+        if (!rangeValid || value < minValue) minValue = value;
+        if (!rangeValid || value > maxValue) maxValue = value;
+        rangeValid = true;
+        samples++;
+    }
+
+    WindowStats close(unsigned long now) {
+        if (started) accumulate(now);
+        WindowStats stats;
+        stats.samples = samples;
+        stats.durationMs = started ? static_cast<uint32_t>(now - windowStart) : 0;
+        stats.min = rangeValid ? minValue : lastValue;
+        stats.max = rangeValid ? maxValue : lastValue;
+        stats.mean = stats.durationMs ? static_cast<float>(weightedSum / stats.durationMs) : lastValue;
+        stats.last = lastValue;
+        stats.energyWh = static_cast<float>(weightedSum / 3600000.0);
+        resetWindow();
+        windowStart = now;
+        if (started) {
+            // The value carried into the next window counts towards its range
+            minValue = maxValue = lastValue;
+            rangeValid = true;
+        }
+        return stats;
+    }
+
+private:
+    bool started;
+    unsigned long windowStart;
+    unsigned long lastTime;
+    float lastValue;
+    uint32_t samples;
+    bool rangeValid;
+    float minValue;
+    float maxValue;
+    double weightedSum;  // value * ms (double: W * ms over a window overflows float precision)
+
+    void accumulate(unsigned long now) {
+        weightedSum += static_cast<double>(lastValue) * static_cast<uint32_t>(now - lastTime);
+        lastTime = now;
+    }
+
+    void resetWindow() {
+        samples = 0;
+        rangeValid = false;
+        minValue = 0.0f;
+        maxValue = 0.0f;
+        weightedSum = 0.0;
+    }
+};
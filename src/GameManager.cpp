@@ -1,184 +1,624 @@
 #include "GameManager.h"
 #include "power_plant_config.h"
+#include "actuation_policy.h"
 #include <ESPGameAPI.h>
 #include <Arduino.h>
 #include <math.h>
 
 // --- New UART TX hooks provided by the ESP32-S3 main file ---
-extern void sendAttractionCommand(uint8_t slaveType, uint8_t state); // maps to cmd4 0x01/0x02
 extern void sendCmd2B(uint8_t slaveType, uint8_t cmd4);              // sends [type, cmd4]
 
-// --- 4-bit command codes used on the wire (no payload) ---
-static constexpr uint8_t CMD_ON               = 0x01; // generic ON
-static constexpr uint8_t CMD_OFF              = 0x02; // generic OFF
-static constexpr uint8_t CMD_BATTERY_IDLE     = 0x03; // battery -> idle
-static constexpr uint8_t CMD_BATTERY_CHARGE   = 0x04; // battery -> charge/consume
-static constexpr uint8_t CMD_BATTERY_DISCHARGE= 0x05; // battery -> discharge/produce
-
-// Hydro storage command codes (5 levels)
-static constexpr uint8_t CMD_HYDRO_STORAGE_LEVEL_1 = 0x0B; // 100% Full - Green (Discharging)
-static constexpr uint8_t CMD_HYDRO_STORAGE_LEVEL_2 = 0x0C; // 75% Full - Light Green
-static constexpr uint8_t CMD_HYDRO_STORAGE_LEVEL_3 = 0x0D; // 50% Full - Orange (Idle)
-static constexpr uint8_t CMD_HYDRO_STORAGE_LEVEL_4 = 0x0E; // 25% Full - Light Red
-static constexpr uint8_t CMD_HYDRO_STORAGE_LEVEL_5 = 0x0F; // 0% Empty - Red (Charging)
-
 // Implementation of methods that need ESPGameAPI types
 
-std::vector<ConnectedPowerPlant> GameManager::getConnectedPowerPlants() {
-    std::vector<ConnectedPowerPlant> plants;
+void GameManager::fillConnectedPowerPlants(UploadList<ConnectedPowerPlant>& out) const {
+    out.clear();
     // Only report powerplants that are actually connected via UART
     for (const auto& uartPlant : uartPowerplants) {
-        if (uartPlant.amount > 0) {
-            // Calculate individual power for each type (separate battery and hydro storage)
-            float totalPower = calculateTotalPowerForType(uartPlant.slaveType);
-            plants.push_back({static_cast<uint16_t>(uartPlant.slaveType), totalPower});
+        if (uartPlant.amount == 0 || !isValidSlaveType(uartPlant.slaveType)) continue;
+        // Mean power of the type over the upload window (separate battery and hydro storage)
+        float totalPower = uploadWindow.typeProduction[uartPlant.slaveType].mean;
+        out.push({static_cast<uint16_t>(uartPlant.slaveType), totalPower});
+    }
+}
+
+void GameManager::sampleTelemetry(unsigned long now) {
+    float typePower[MAX_SLAVE_TYPE + 1] = {};
+    float production = 0.0f;
+    for (const auto& uartPlant : uartPowerplants) {
+        if (!isValidSlaveType(uartPlant.slaveType)) continue;
+        typePower[uartPlant.slaveType] = currentPowerForType(uartPlant.slaveType, uartPlant.amount);
+        production += typePower[uartPlant.slaveType];
+    }
+
+    std::lock_guard<std::mutex> lock(telemetryMutex);
+    productionAggregator.add(production, now);
+    consumptionAggregator.add(getTotalConsumption(), now);
+    for (uint8_t type = PHOTOVOLTAIC; type <= MAX_SLAVE_TYPE; type++) {
+        typeProductionAggregators[type].add(typePower[type], now);
+    }
+
+    // No upload reaches the server: keep the outage in the journal instead of one huge window
+    if (lastGameActive && !isServerReachable(now) && now - telemetryCutAt >= JOURNAL_RECORD_INTERVAL_MS) {
+        journalTelemetry(now);
+    }
+}
+
+float GameManager::currentPowerForType(uint8_t slaveType, uint8_t amount) const {
+    if (amount == 0) return 0.0f;
+    for (size_t i = 0; i < powerPlantCount; i++) {
+        const PowerPlant& plant = powerPlants[i];
+        if (static_cast<uint8_t>(plant.plantType) != slaveType) continue;
+        return plant.maxWatts > 0.0f ? computePowerPerPlant(plant) * amount : 0.0f;
+    }
+    return 0.0f;
+}
+
+void GameManager::fillLiveTelemetry(TelemetrySnapshot& out, unsigned long now) const {
+    float production = 0.0f;
+    for (const auto& uartPlant : uartPowerplants) {
+        if (!isValidSlaveType(uartPlant.slaveType)) continue;
+        const uint8_t index = uartPlant.slaveType - PHOTOVOLTAIC;
+        const float power = currentPowerForType(uartPlant.slaveType, uartPlant.amount);
+        production += power;
+        out.fields[TelemetrySnapshot::FIELD_TYPE_POWER + index] = TelemetrySnapshot::scaled(power, 10.0f);
+        out.fields[TelemetrySnapshot::FIELD_TYPE_AMOUNT + index] = uartPlant.amount;
+    }
+    for (size_t i = 0; i < powerPlantCount; i++) {
+        const uint8_t type = static_cast<uint8_t>(powerPlants[i].plantType);
+        if (!isValidSlaveType(type)) continue;
+        out.fields[TelemetrySnapshot::FIELD_TYPE_PERCENT + type - PHOTOVOLTAIC] =
+            TelemetrySnapshot::scaled(powerPlants[i].powerPercentage.load(), 1000.0f);
+    }
+    out.fields[TelemetrySnapshot::FIELD_PRODUCTION] = TelemetrySnapshot::scaled(production, 10.0f);
+    out.fields[TelemetrySnapshot::FIELD_CONSUMPTION] = TelemetrySnapshot::scaled(getTotalConsumption(), 10.0f);
+
+    const StorageIntegrator* battery = storageForType(BATTERY);
+    const StorageIntegrator* hydroStorage = storageForType(HYDRO_STORAGE);
+    if (battery) out.fields[TelemetrySnapshot::FIELD_BATTERY_SOC] = TelemetrySnapshot::scaled(battery->getSoc(), 1000.0f);
+    if (hydroStorage) {
+        out.fields[TelemetrySnapshot::FIELD_HYDRO_STORAGE_SOC] = TelemetrySnapshot::scaled(hydroStorage->getSoc(), 1000.0f);
+    }
+
+    int32_t flags = out.fields[TelemetrySnapshot::FIELD_LINK_FLAGS];
+    if (lastServerResponse != 0 && isServerReachable(now)) flags |= TelemetrySnapshot::LINK_SERVER;
+    if (retranslationConnected) flags |= TelemetrySnapshot::LINK_RETRANSLATION;
+    if (isGameActive()) flags |= TelemetrySnapshot::LINK_GAME_ACTIVE;
+    out.fields[TelemetrySnapshot::FIELD_LINK_FLAGS] = flags;
+
+    out.fields[TelemetrySnapshot::FIELD_STATUS_MS] =
+        static_cast<int32_t>(requestStats.getLastMs(RequestStats::ENDPOINT_STATUS));
+    out.fields[TelemetrySnapshot::FIELD_STATUS_P99_MS] =
+        static_cast<int32_t>(requestStats.getSuccessPercentile(RequestStats::ENDPOINT_STATUS, 99));
+    const uint32_t rangesP99 = requestStats.getSuccessPercentile(RequestStats::ENDPOINT_RANGES, 99);
+    const uint32_t coefficientsP99 = requestStats.getSuccessPercentile(RequestStats::ENDPOINT_COEFFICIENTS, 99);
+    out.fields[TelemetrySnapshot::FIELD_POLL_P99_MS] =
+        static_cast<int32_t>(rangesP99 > coefficientsP99 ? rangesP99 : coefficientsP99);
+    out.fields[TelemetrySnapshot::FIELD_REQUEST_FAILURES] = static_cast<int32_t>(requestStats.getFailureTotal());
+}
+
+void GameManager::journalTelemetry(unsigned long now) {
+    const WindowStats production = productionAggregator.close(now);
+    const WindowStats consumption = consumptionAggregator.close(now);
+    for (uint8_t type = PHOTOVOLTAIC; type <= MAX_SLAVE_TYPE; type++) {
+        typeProductionAggregators[type].close(now);
+    }
+    JournalRecord record;
+    record.endMs = now;
+    record.durationMs = production.durationMs;
+    record.productionMean = production.mean;
+    record.productionMax = production.max;
+    record.consumptionMean = consumption.mean;
+    if (telemetryJournal.empty()) {
+        Serial.println("[JOURNAL] Server unreachable, journaling telemetry");
+    }
+    telemetryJournal.push(record);
+    telemetryCutAt = now;
+}
+
+GameManager::TelemetryWindow GameManager::getUploadWindow() {
+    std::lock_guard<std::mutex> lock(telemetryMutex);
+    unsigned long now = millis();
+    if (uploadWindow.sequence == 0 || now - uploadWindowClosedAt >= TELEMETRY_WINDOW_MIN_MS) {
+        uploadWindow.production = productionAggregator.close(now);
+        uploadWindow.consumption = consumptionAggregator.close(now);
+        for (uint8_t type = PHOTOVOLTAIC; type <= MAX_SLAVE_TYPE; type++) {
+            uploadWindow.typeProduction[type] = typeProductionAggregators[type].close(now);
         }
+        uploadWindow.sequence++;
+        uploadWindowClosedAt = now;
+        telemetryCutAt = now;
     }
-    return plants;
+    return uploadWindow;
+}
+
+static ConnectedConsumer consumerForType(size_t type) {
+    // use building type as consumer ID for now
+    return {static_cast<uint32_t>(type)};
+}
+
+void GameManager::fillConnectedConsumers(UploadList<ConnectedConsumer>& out) const {
+    // One consumer per connected building, straight from the per-type counts (no registry
+    // copy). Caller holds telemetryMutex: the loop task updates the counts under it.
+    fillFromCounts(out, buildingTypeCounts, consumerForType);
+}
+
+// The library takes the lists by value, so each callback returns one copy of the reserved
+// list; filling it never allocates.
+std::vector<ConnectedPowerPlant> GameManager::getConnectedPowerPlants() {
+    getUploadWindow(); // same window as the production callback of this upload
+    statusUploads++;
+    std::lock_guard<std::mutex> lock(telemetryMutex);
+    fillConnectedPowerPlants(connectedPlants);
+    return connectedPlants.get();
 }
 
 std::vector<ConnectedConsumer> GameManager::getConnectedConsumers() {
-    std::vector<ConnectedConsumer> consumers;
-    if (nfcRegistry) {
-        auto buildings = nfcRegistry->getAllBuildings();
-        for (const auto& building : buildings) {
-            // use building type as consumer ID for now
-            uint32_t consumerId = static_cast<uint32_t>(building.second.buildingType);
-            consumers.push_back({consumerId});
+    std::lock_guard<std::mutex> lock(telemetryMutex);
+    fillConnectedConsumers(connectedConsumers);
+    const uint32_t dropped = connectedConsumers.getFillDropped();
+    if (dropped != lastReportedConsumerDrop) {
+        lastReportedConsumerDrop = dropped;
+        if (dropped) {
+            Serial.printf("[GameManager] %lu consumers past the upload limit of %u not reported\n",
+                          (unsigned long)dropped, (unsigned)MAX_CONNECTED_CONSUMERS);
+        }
+    }
+    return connectedConsumers.get();
+}
+
+void GameManager::startStatePoll(unsigned long now) {
+    if (!espApi || pollHandoff.stage() != POLL_IDLE) return;
+    pollCycles++;
+    pollCycleChanged = false;
+    lastRequestTime = now;
+    if (rangesRefreshDue || rangesFingerprint == 0 || now - lastRangesFetch >= RANGES_REFRESH_INTERVAL_MS) {
+        requestProductionRanges();
+    } else {
+        requestProductionCoefficients();
+    }
+}
+
+void GameManager::requestProductionRanges() {
+    if (!espApi) return;
+
+    const PollHandoff::Ticket ticket = pollHandoff.begin(POLL_RANGES);
+    pollStageStartTime = millis();
+    pollRequests++;
+    requestStats.begin(RequestStats::ENDPOINT_RANGES, pollStageStartTime);
+    Serial.println("[GameManager] 🚀 Starting production ranges request...");
+
+    espApi->getProductionRanges([this, ticket](bool success, const std::vector<ProductionRange>& ranges,
+                                               const std::string& error) {
+        if (!pollHandoff.claim(ticket)) return; // given up on after POLL_TIMEOUT_MS
+        bool changed = false;
+        if (success) {
+            const uint32_t fingerprint = Fingerprint::ofRanges(ranges);
+            if (fingerprint != rangesFingerprint) {
+                rangesFingerprint = fingerprint;
+                changed = true;
+                updateCoefficientsFromGame(); // publishes the new ranges for update() to apply
+            }
+        }
+        answerPoll(ticket, RequestStats::ENDPOINT_RANGES, success, changed, error);
+    });
+}
+
+void GameManager::requestProductionCoefficients() {
+    if (!espApi) return;
+
+    const PollHandoff::Ticket ticket = pollHandoff.begin(POLL_COEFFICIENTS);
+    pollStageStartTime = millis();
+    pollRequests++;
+    requestStats.begin(RequestStats::ENDPOINT_COEFFICIENTS, pollStageStartTime);
+
+    espApi->pollCoefficients([this, ticket](bool success, const std::string& error) {
+        if (!pollHandoff.claim(ticket)) return;
+        // Coefficients are stored in espApi; publish them into the server tables only when
+        // they differ from the last response. update() actuates attractions whose value changed.
+        bool changed = false;
+        if (success) {
+            const uint32_t fingerprint =
+                Fingerprint::ofCoefficients(espApi->getProductionCoefficients(), espApi->getConsumptionCoefficients());
+            if (fingerprint != coefficientsFingerprint) {
+                coefficientsFingerprint = fingerprint;
+                changed = true;
+                publishServerCoefficients();
+            }
+        }
+        answerPoll(ticket, RequestStats::ENDPOINT_COEFFICIENTS, success, changed, error);
+    });
+}
+
+void GameManager::answerPoll(PollHandoff::Ticket ticket, RequestStats::Endpoint endpoint, bool success, bool changed,
+                             const std::string& error) {
+    pollResponse.endpoint = endpoint;
+    pollResponse.success = success;
+    pollResponse.changed = changed;
+    pollResponse.receivedAt = millis();
+    strncpy(pollResponse.error, error.c_str(), sizeof(pollResponse.error) - 1);
+    pollResponse.error[sizeof(pollResponse.error) - 1] = '\0';
+    pollHandoff.publish(ticket); // releases pollResponse to the loop task
+}
+
+void GameManager::applyPollResponse() {
+    const PollResponse& response = pollResponse;
+    const bool ranges = response.endpoint == RequestStats::ENDPOINT_RANGES;
+    const unsigned long duration = response.receivedAt - pollStageStartTime;
+    requestStats.complete(response.endpoint, response.receivedAt, response.success, response.error);
+    noteServerResponse(response.success, response.receivedAt);
+
+    if (response.success) {
+        stateResponseOk = true;
+        if (response.changed) {
+            pollCycleChanged = true;
+        } else {
+            pollUnchanged++;
         }
+        if (ranges) {
+            lastRangesFetch = response.receivedAt;
+            rangesRefreshDue = false;
+            Serial.printf("[GameManager] ✅ Production ranges received in %lu ms\n", duration);
+            if (response.changed) Serial.println("📊 Production ranges changed on server");
+        } else if (response.changed) {
+            Serial.printf("[GameManager] ✅ Production coefficients changed (%lu ms)\n", duration);
+        }
+    } else {
+        Serial.printf("[GameManager] ❌ Production %s failed after %lu ms: %s\n", ranges ? "ranges" : "coefficients",
+                      duration, response.error);
+    }
+
+    pollHandoff.finish();
+    if (ranges) {
+        requestProductionCoefficients(); // coefficients follow either way
+        return;
+    }
+    pollCadence.onCycle(pollCycleChanged);
+}
+
+// Per-type UART amount debounce timing, indexed by slave type. Rows use the shared defaults
+// from power_plant_config.h unless a type needs its own {decreaseGraceMs, increaseGraceMs};
+// tune from the per-type flap counters printed in the plant debug output.
+struct UartDebounceTiming {
+    uint16_t decreaseGraceMs;
+    uint16_t increaseGraceMs;
+};
+static constexpr UartDebounceTiming UART_DEBOUNCE_DEFAULT = {UART_DECREASE_GRACE_MS, UART_INCREASE_GRACE_MS};
+static constexpr UartDebounceTiming UART_DEBOUNCE_TIMING[] = {
+    {0, 0},                     // 0: unused
+    UART_DEBOUNCE_DEFAULT,      // PHOTOVOLTAIC
+    UART_DEBOUNCE_DEFAULT,      // WIND
+    UART_DEBOUNCE_DEFAULT,      // NUCLEAR
+    UART_DEBOUNCE_DEFAULT,      // GAS
+    UART_DEBOUNCE_DEFAULT,      // HYDRO
+    UART_DEBOUNCE_DEFAULT,      // HYDRO_STORAGE
+    UART_DEBOUNCE_DEFAULT,      // COAL
+    UART_DEBOUNCE_DEFAULT,      // BATTERY
+};
+static_assert(sizeof(UART_DEBOUNCE_TIMING) / sizeof(UART_DEBOUNCE_TIMING[0]) == BATTERY + 1,
+              "one debounce row per slave type");
+
+void GameManager::configureUartDebounce() {
+    for (uint8_t type = PHOTOVOLTAIC; type <= MAX_SLAVE_TYPE; type++) {
+        uartDebouncer.configure(type, UART_DEBOUNCE_TIMING[type].decreaseGraceMs,
+                                UART_DEBOUNCE_TIMING[type].increaseGraceMs);
     }
-    return consumers;
 }
 
 void GameManager::updateUartPowerplants(const std::vector<UartSlaveInfo>& powerplants) {
-    // For each incoming powerplant record decide whether it's an increase (apply immediately)
-    // or decrease (stage with grace) relative to current uartPowerplants snapshot.
-    // Build a map of current amounts.
+    // Every reported amount goes through the per-type debounce state machine; increases are
+    // applied immediately by default, decreases (including disconnects) after a grace period.
     auto now = millis();
-    // Helper lambda to find current amount
-    auto findCurrentAmount = [this](uint8_t type) -> int {
-        for (const auto &p : uartPowerplants) if (p.slaveType == type) return p.amount; return -1; };
+    uint16_t reportedMask = 0;
 
-    // Process each reported type
     for (const auto &incoming : powerplants) {
         if (!isValidSlaveType(incoming.slaveType)) {
             Serial.printf("[UART] Ignoring invalid slave type %u (amount=%u)\n", incoming.slaveType, incoming.amount);
             continue;
         }
-        int current = findCurrentAmount(incoming.slaveType);
-        if (current < 0) {
-            // New type appears or first report -> add immediately
-            uartPowerplants.push_back(incoming);
-            Serial.printf("[UART] Type %u initial amount=%u\n", incoming.slaveType, incoming.amount);
-            // Remove any stale pending decrease for this type (no longer relevant)
-            pendingDecreases.erase(std::remove_if(pendingDecreases.begin(), pendingDecreases.end(), [&](const PendingDecrease &pd){return pd.slaveType==incoming.slaveType;}), pendingDecreases.end());
-            continue;
-        }
-        if (incoming.amount > current) {
-            // Increase -> apply immediately, cancel any pending decrease
-            for (auto &p : uartPowerplants) if (p.slaveType == incoming.slaveType) { p.amount = incoming.amount; break; }
-            pendingDecreases.erase(std::remove_if(pendingDecreases.begin(), pendingDecreases.end(), [&](const PendingDecrease &pd){return pd.slaveType==incoming.slaveType;}), pendingDecreases.end());
-            Serial.printf("[UART] Type %u amount increased %d -> %u (applied immediately)\n", incoming.slaveType, current, incoming.amount);
-        } else if (incoming.amount < current) {
-            // Decrease -> stage: if already pending with same target refresh timer else create
-            bool foundPending = false;
-            for (auto &pd : pendingDecreases) {
-                if (pd.slaveType == incoming.slaveType) {
-                    if (pd.targetAmount != incoming.amount) {
-                        pd.targetAmount = incoming.amount;
-                        pd.firstSeen = now; // restart timer for new lower target
-                        Serial.printf("[UART] Type %u decrease updated pending %u -> %u (timer reset)\n", incoming.slaveType, current, incoming.amount);
-                    } else {
-                        // Same target observed again -> keep timer (optionally refresh if we want stronger confirmation)
-                    }
-                    foundPending = true;
-                    break;
-                }
-            }
-            if (!foundPending) {
-                PendingDecrease pd{incoming.slaveType, incoming.amount, now, (uint8_t)current};
-                pendingDecreases.push_back(pd);
-                Serial.printf("[UART] Type %u decrease staged %d -> %u (grace %lums)\n", incoming.slaveType, current, incoming.amount, DECREASE_GRACE_MS);
-            }
-        } else {
-            // Same amount; no change. Could clear pending decreases if any were for this target beyond it? We keep them; stable amount doesn't confirm decrease.
-        }
-    }
-
-    // Also prune types that disappeared entirely from the report (treat as potential zero w/ grace)
-    for (const auto &existing : uartPowerplants) {
-        if (!isValidSlaveType(existing.slaveType)) continue; // will purge later
-        bool seen = false;
-        for (const auto &inc : powerplants) if (inc.slaveType == existing.slaveType) { seen = true; break; }
-        if (!seen) {
-            // Not reported this cycle -> treat as potential disconnect (target 0) if not already 0 or pending.
-            if (existing.amount > 0) {
-                bool alreadyPending = false;
-                for (auto &pd : pendingDecreases) if (pd.slaveType == existing.slaveType && pd.targetAmount==0) { alreadyPending = true; break; }
-                if (!alreadyPending) {
-                    PendingDecrease pd{existing.slaveType, 0, now, existing.amount};
-                    pendingDecreases.push_back(pd);
-                    Serial.printf("[UART] Type %u missing from report -> staged disconnect %u -> 0 (grace %lums)\n", existing.slaveType, existing.amount, DECREASE_GRACE_MS);
-                }
-            }
+        reportedMask |= static_cast<uint16_t>(1u << incoming.slaveType);
+        observeUartAmount(incoming.slaveType, incoming.amount, now);
+    }
+
+    // Types that disappeared from the report are treated as a potential disconnect (target 0)
+    for (size_t i = 0; i < uartPowerplants.size(); i++) {
+        const uint8_t type = uartPowerplants[i].slaveType;
+        if (!isValidSlaveType(type)) continue; // will purge later
+        if (reportedMask & (1u << type)) continue;
+        if (uartPowerplants[i].amount > 0) {
+            observeUartAmount(type, 0, now);
         }
     }
 
-    // Apply any pending decreases whose timers expired
-    applyPendingDecreases();
+    // Apply any staged changes whose deadline expired
+    applyExpiredAmountChanges();
     purgeInvalidUartPowerplants();
 }
 
-void GameManager::updateAttractionStates() {
-    // Throttle updates to avoid spam while keeping responsiveness
-    if (millis() - lastUartAttractionUpdate < ATTRACTION_UPDATE_MS) {
-        return;
+void GameManager::observeUartAmount(uint8_t slaveType, uint8_t amount, unsigned long now) {
+    const bool known = uartDebouncer.isKnown(slaveType);
+    const uint8_t before = uartDebouncer.getCommitted(slaveType);
+
+    switch (uartDebouncer.observe(slaveType, amount, now)) {
+        case AmountDebouncer::COMMITTED:
+            setUartAmount(slaveType, amount);
+            if (!known) {
+                Serial.printf("[UART] Type %u initial amount=%u\n", slaveType, amount);
+            } else {
+                Serial.printf("[UART] Type %u amount %u -> %u (applied immediately)\n", slaveType, before, amount);
+            }
+            break;
+        case AmountDebouncer::STAGED:
+            Serial.printf("[UART] Type %u change staged %u -> %u (grace %ums)\n", slaveType, before, amount,
+                          amount < before ? UART_DEBOUNCE_TIMING[slaveType].decreaseGraceMs
+                                          : UART_DEBOUNCE_TIMING[slaveType].increaseGraceMs);
+            break;
+        case AmountDebouncer::RESTAGED:
+            Serial.printf("[UART] Type %u pending change updated %u -> %u (timer reset)\n", slaveType, before, amount);
+            break;
+        case AmountDebouncer::CANCELLED:
+            Serial.printf("[UART] Type %u pending change cancelled, amount back to %u (flaps=%u)\n",
+                          slaveType, amount, uartDebouncer.getFlapCount(slaveType));
+            break;
+        case AmountDebouncer::NO_CHANGE:
+            break;
+    }
+}
+
+void GameManager::setUartAmount(uint8_t slaveType, uint8_t amount) {
+    bool found = false;
+    for (auto &p : uartPowerplants) {
+        if (p.slaveType == slaveType) { p.amount = amount; found = true; break; }
+    }
+    if (!found) {
+        uartPowerplants.push_back({slaveType, amount});
+    }
+    raiseActuationEvent(slaveType, true); // new plants need the current command even if unchanged
+    warmStartDirty = true;
+}
+
+// ---------------- Warm start (NVS) ----------------
+
+// Shared scratch record: ~2.5 KB, kept off the loop task stack
+static WarmStartState warmStartScratch;
+
+bool GameManager::restoreWarmStart() {
+    unsigned long start = millis();
+    WarmStartState& state = warmStartScratch;
+    if (!warmStart.load(state)) {
+        Serial.println("[WARM] No valid warm-start record, cold start");
+        return false;
+    }
+
+    // Restored tables go through the same publish / apply path as server responses, so the
+    // first real response replaces them as a whole
+    serverTables.publish([&state](ServerTables& tables) {
+        tables.rangeMask = state.rangeMask;
+        tables.coefficientMask = state.coefficientMask;
+        for (uint8_t type = 0; type < ServerTables::TYPE_SLOTS && type < WarmStartState::TYPE_SLOTS; type++) {
+            tables.minWatts[type] = state.minWatts[type];
+            tables.maxWatts[type] = state.maxWatts[type];
+            tables.productionCoefficient[type] = state.productionCoefficient[type];
+        }
+        for (uint8_t i = 0; i < state.consumptionCount; i++) {
+            tables.consumption[state.consumption[i].buildingType] = state.consumption[i].consumption;
+        }
+    });
+    applyServerTables();
+
+    // Interned now, handed to the NFC registry once it is attached
+    buildingUids.clear();
+    for (uint8_t i = 0; i < state.buildingCount; i++) {
+        const auto& b = state.buildings[i];
+        buildingUids.intern(b.uid, b.buildingType, b.uidFormat);
+    }
+
+    uint8_t inventoryTypes = 0;
+    for (uint8_t type = PHOTOVOLTAIC; type <= MAX_SLAVE_TYPE && type < WarmStartState::TYPE_SLOTS; type++) {
+        if (state.inventoryMask & (1u << type)) {
+            // Committed without debounce; the first station report reconciles it like any change
+            uartDebouncer.setCommitted(type, state.inventory[type]);
+            setUartAmount(type, state.inventory[type]);
+            inventoryTypes++;
+        }
     }
 
-    // Ensure any elapsed pending decreases are applied before sending attraction commands
-    applyPendingDecreases();
+    warmGameActive = state.gameActive;
+    lastGameActive = state.gameActive;
+    warmRestoreTime = millis();
+    warmStartDirty = false;
+
+    Serial.printf("[WARM] Restored %u ranges, %u coefficients, %u consumption entries, %u buildings, "
+                  "%u plant types (game %s) in %lu ms\n",
+                  (unsigned)__builtin_popcount(state.rangeMask), (unsigned)__builtin_popcount(state.coefficientMask),
+                  state.consumptionCount,
+                  state.buildingCount, inventoryTypes, warmGameActive ? "ON" : "OFF", millis() - start);
+    return true;
+}
 
-    // Track which types we already sent for (avoid duplicates)
-    uint8_t sentTypes[16];
-    size_t sentCount = 0;
+void GameManager::captureWarmStart(WarmStartState& state) {
+    state.clear();
+    state.gameActive = isGameActive();
+
+    // Server tables as last applied by the loop
+    const ServerTables& tables = serverTablesSnapshot;
+    for (uint8_t type = 0; type < ServerTables::TYPE_SLOTS && type < WarmStartState::TYPE_SLOTS; type++) {
+        const uint16_t bit = static_cast<uint16_t>(1u << type);
+        if (tables.rangeMask & bit) {
+            state.rangeMask |= bit;
+            state.minWatts[type] = tables.minWatts[type];
+            state.maxWatts[type] = tables.maxWatts[type];
+        }
+        if (tables.coefficientMask & bit) {
+            state.coefficientMask |= bit;
+            state.productionCoefficient[type] = tables.productionCoefficient[type];
+        }
+    }
 
-    // Handle all types reported via UART first
     for (const auto& uartPlant : uartPowerplants) {
-        if (uartPlant.amount == 0) continue;
-        if (!isValidSlaveType(uartPlant.slaveType)) continue; // skip invalid type 0 etc.
+        if (!isValidSlaveType(uartPlant.slaveType) || uartPlant.slaveType >= WarmStartState::TYPE_SLOTS) continue;
+        state.inventoryMask |= static_cast<uint16_t>(1u << uartPlant.slaveType);
+        state.inventory[uartPlant.slaveType] = uartPlant.amount;
+    }
 
-        bool hasLocal = false;
-        for (size_t i = 0; i < powerPlantCount; i++) {
-            if (static_cast<uint8_t>(powerPlants[i].plantType) == uartPlant.slaveType) {
-                const auto& plant = powerPlants[i];
-                switch (plant.plantType) {
-                    case PHOTOVOLTAIC: updatePhotovoltaic(uartPlant.slaveType, plant); break;
-                    case WIND:         updateWind(uartPlant.slaveType, plant); break;
-                    case NUCLEAR:      updateNuclear(uartPlant.slaveType, plant); break;
-                    case GAS:          updateGas(uartPlant.slaveType, plant); break;
-                    case HYDRO:        updateHydro(uartPlant.slaveType, plant); break;
-                    case HYDRO_STORAGE:updateHydroStorage(uartPlant.slaveType, plant); break;
-                    case COAL:         updateCoal(uartPlant.slaveType, plant); break;
-                    case BATTERY:      updateBattery(uartPlant.slaveType, plant); break;
-                    default: {
-                        uint8_t attractionState = (plant.maxWatts > 0.0f && plant.powerPercentage.load() > 0.5f) ? 1 : 0;
-                        sendAttractionCommand(uartPlant.slaveType, attractionState);
-                    } break;
-                }
-                hasLocal = true;
+    for (size_t type = 0; type < ServerTables::BUILDING_TYPE_SLOTS; type++) {
+        if (tables.consumption[type] != 0.0f &&
+            !state.addConsumption(static_cast<uint8_t>(type), tables.consumption[type])) {
+            break;
+        }
+    }
+
+    for (UidHandle handle = 0; handle < UidStore::CAPACITY; handle++) {
+        if (!buildingUids.isValid(handle)) continue;
+        if (!state.addBuilding(buildingUids.getBuildingType(handle), buildingUids.getUid(handle),
+                               buildingUids.getFormat(handle))) {
+            break; // full
+        }
+    }
+    const size_t connected = getConnectedBuildingCount();
+    if (connected > state.buildingCount) {
+        Serial.printf("[WARMSTART] %u of %u buildings not saved (UID table full)\n",
+                      (unsigned)(connected - state.buildingCount), (unsigned)connected);
+    }
+}
+
+void GameManager::persistWarmStartIfDue() {
+    if (warmStartBuildingGeneration != buildingSetGeneration) {
+        warmStartBuildingGeneration = buildingSetGeneration;
+        warmStartDirty = true;
+    }
+    if (!warmStartDirty) return;
+
+    unsigned long now = millis();
+    if (!warmStart.isWriteAllowed(now)) return; // rate limit: keep dirty, retry later
+
+    captureWarmStart(warmStartScratch);
+    warmStartDirty = false;
+    if (warmStart.save(warmStartScratch, now)) {
+        Serial.printf("[WARM] State saved to NVS (%zu bytes, write #%lu)\n",
+                      warmStart.getLastRecordSize(), (unsigned long)warmStart.getWriteCount());
+    }
+}
+
+void GameManager::raiseActuationEvent(uint8_t slaveType, bool forceFrame) {
+    if (!isValidSlaveType(slaveType)) return;
+    if (forceFrame) forcedActuationMask.fetch_or(static_cast<uint16_t>(1u << slaveType));
+    // Keep the timestamp of the oldest unserved event so latency covers the full wait
+    if (actuationEventMicros[slaveType] == 0) {
+        uint32_t nowUs = micros();
+        actuationEventMicros[slaveType] = nowUs ? nowUs : 1;
+    }
+    pendingActuationMask.fetch_or(static_cast<uint16_t>(1u << slaveType));
+}
+
+void GameManager::updateAttractionStates() {
+    unsigned long now = millis();
+
+    // Periodic backstop: refresh every connected type so a lost frame is corrected eventually
+    if (now - lastUartAttractionUpdate >= ATTRACTION_UPDATE_MS) {
+        // Ensure any elapsed staged amount changes are applied before sending attraction commands
+        applyExpiredAmountChanges();
+
+        uint16_t heldMask = 0;
+        for (const auto& uartPlant : uartPowerplants) {
+            if (emitAttractionForType(uartPlant.slaveType, now, true)) {
+                heldMask |= static_cast<uint16_t>(1u << uartPlant.slaveType);
+            }
+        }
+        pendingActuationMask.store(heldMask); // held level changes keep being re-evaluated
+        forcedActuationMask.store(0);
+        actuationEventMicros.fill(0); // events for unconnected types are moot after a full refresh
+        lastUartAttractionUpdate = now;
+        return;
+    }
+
+    // Event path: only the types that changed, each at most once per ATTRACTION_EVENT_MIN_GAP_MS
+    uint16_t mask = pendingActuationMask.load();
+    if (mask == 0) return;
+
+    const uint16_t forced = forcedActuationMask.load();
+    uint16_t served = 0;
+    uint16_t heldMask = 0;
+    for (uint8_t type = PHOTOVOLTAIC; type <= MAX_SLAVE_TYPE; type++) {
+        uint16_t bit = static_cast<uint16_t>(1u << type);
+        if (!(mask & bit)) continue;
+        if (now - lastActuationTime[type] < ATTRACTION_EVENT_MIN_GAP_MS) continue; // retry next call
+
+        for (const auto& uartPlant : uartPowerplants) {
+            if (uartPlant.slaveType == type) {
+                if (emitAttractionForType(type, now, (forced & bit) != 0)) heldMask |= bit;
                 break;
             }
         }
+        // Types without connected plants have nothing to actuate; drop the event either way
+        actuationEventMicros[type] = 0;
+        served |= bit;
+    }
+    forcedActuationMask.fetch_and(static_cast<uint16_t>(~served));
+    pendingActuationMask.fetch_and(static_cast<uint16_t>(~served));
+    // A level change waiting for its dwell time is evaluated again after the event gap
+    if (heldMask) pendingActuationMask.fetch_or(heldMask);
+}
+
+bool GameManager::emitAttractionForType(uint8_t slaveType, unsigned long now, bool sendAlways) {
+    if (!isValidSlaveType(slaveType)) return false; // skip invalid type 0 etc.
 
-        if (!hasLocal) {
-            // No local control registered: ensure device goes OFF
-            sendAttractionCommand(uartPlant.slaveType, 0);
+    uint8_t amount = 0;
+    for (const auto& uartPlant : uartPowerplants) {
+        if (uartPlant.slaveType == slaveType) { amount = uartPlant.amount; break; }
+    }
+    if (amount == 0) return false;
+
+    const PowerPlant* plant = nullptr;
+    for (size_t i = 0; i < powerPlantCount; i++) {
+        if (static_cast<uint8_t>(powerPlants[i].plantType) == slaveType) {
+            plant = &powerPlants[i];
+            break;
         }
+    }
+
+    uint8_t cmd = UartProtocol::CMD_OFF; // no local control registered: ensure device goes OFF
+    float input = 0.0f;
+    const auto& policy = ActuationPolicy::forType(slaveType);
+    auto& levelState = actuationLevels[slaveType];
+    if (plant) {
+        ActuationPolicy::Inputs inputs;
+        inputs.rangeValid = plant->maxWatts > 0.0f;
+        inputs.values[ActuationPolicy::INPUT_NONE] = 0.0f;
+        inputs.values[ActuationPolicy::INPUT_ENCODER_PERCENT] = plant->powerPercentage.load();
+        inputs.coefficientValid = hasProductionCoefficientForType(slaveType);
+        inputs.values[ActuationPolicy::INPUT_COEFFICIENT] = getProductionCoefficientForType(slaveType);
+        const float range = plant->maxWatts - plant->minWatts;
+        inputs.values[ActuationPolicy::INPUT_SIGNED_POWER] =
+            (range > 0.0f) ? computePowerPerPlant(*plant) / (range * 0.5f) : 0.0f; // scale to ±1.0
+        const StorageIntegrator* storage = storageForType(slaveType);
+        inputs.values[ActuationPolicy::INPUT_STATE_OF_CHARGE] = storage ? storage->getSoc() : 0.0f;
+        cmd = ActuationPolicy::evaluate(policy, inputs, levelState, now);
+        input = ActuationPolicy::selectInput(policy, inputs);
+    }
+    lastActuationTime[slaveType] = now;
+
+    const bool changed = lastActuationCommand[slaveType] != cmd;
+    if (!changed && !sendAlways) {
+        suppressedActuationFrames++;
+        return levelState.held;
+    }
+
+    sendCmd2B(slaveType, cmd);
 
-        if (sentCount < sizeof(sentTypes)) sentTypes[sentCount++] = uartPlant.slaveType;
+    // Log command changes only; the periodic refresh re-sends the same command silently
+    if (changed) {
+        Serial.printf("[ACTUATION] %s input=%.3f -> cmd=0x%02X (was 0x%02X, level %u, transitions %lu)\n",
+                      policy.name, input, cmd, lastActuationCommand[slaveType], levelState.level,
+                      (unsigned long)levelState.transitions);
+        lastActuationCommand[slaveType] = cmd;
     }
 
-    lastUartAttractionUpdate = millis();
+    uint32_t eventUs = actuationEventMicros[slaveType];
+    if (eventUs != 0) {
+        actuationLatencyUs.record(micros() - eventUs);
+        actuationEventMicros[slaveType] = 0;
+    }
+    return levelState.held;
 }
 
 float GameManager::calculateTotalPowerForType(uint8_t slaveType) const {
@@ -193,15 +633,13 @@ float GameManager::calculateTotalPowerForType(uint8_t slaveType) const {
                 if (uartPlant.slaveType == slaveType) {
                     // If no powerplants connected or powerplant type disabled (max = 0), return 0
                     if (uartPlant.amount == 0 || plant.maxWatts <= 0.0f) {
-                        // Debug logging for disabled plants
-                        static unsigned long lastDisabledDebug = 0;
-                        if (millis() - lastDisabledDebug > 5000) { // Debug every 5 seconds
+                        // Debug logging for disabled plants (once per trace request)
+                        if (powerTraceDue) {
                             if (uartPlant.amount == 0) {
                                 Serial.printf("[POWER] Type %u: No plants connected via UART\n", slaveType);
                             } else if (plant.maxWatts <= 0.0f) {
                                 Serial.printf("[POWER] Type %u: Plant disabled (maxWatts=%.1f)\n", slaveType, plant.maxWatts);
                             }
-                            lastDisabledDebug = millis();
                         }
                         return 0.0f;
                     }
@@ -212,14 +650,10 @@ float GameManager::calculateTotalPowerForType(uint8_t slaveType) const {
                     // Total power = power per plant * number of connected plants
                     float totalPower = powerPerPlant * uartPlant.amount;
                     
-                    // Debug logging for active plants
-                    static unsigned long lastActiveDebug = 0;
-                    if (millis() - lastActiveDebug > 2000) { // Debug every 2 seconds
-                        if (totalPower != 0.0f) {
-                            Serial.printf("[POWER] Type %u: %u plants, %.1fW per plant, %.1fW total\n", 
-                                         slaveType, uartPlant.amount, powerPerPlant, totalPower);
-                        }
-                        lastActiveDebug = millis();
+                    // Debug logging for active plants (once per trace request)
+                    if (powerTraceDue && totalPower != 0.0f) {
+                        Serial.printf("[POWER] Type %u: %u plants, %.1fW per plant, %.1fW total\n", 
+                                     slaveType, uartPlant.amount, powerPerPlant, totalPower);
                     }
                     
                     return totalPower;
@@ -233,214 +667,6 @@ float GameManager::calculateTotalPowerForType(uint8_t slaveType) const {
     return 0.0f;
 }
 
-// ------- Per-type update helpers -------
-static inline uint8_t onOffByPercent(const PowerPlant& plant) {
-    if (plant.maxWatts <= 0.0f) return 0;
-    return plant.powerPercentage.load() > 0.5f ? 1 : 0;
-}
-
-void GameManager::updatePhotovoltaic(uint8_t slaveType, const PowerPlant& plant) {
-    // Photovoltaic attraction state is now based on the server-provided solar coefficient.
-    // A zero or low coefficient means night/no sun (idle, green light),
-    // while a high coefficient means sun is available (active, orange light).
-    // The slave itself will then use its light sensor to modulate brightness.
-    
-    uint8_t solarStateCommand = CMD_BATTERY_IDLE; // Default to idle (green)
-
-    // Activation threshold (can be overridden at compile time)
-    #ifndef SOLAR_ACTIVE_THRESHOLD
-    #define SOLAR_ACTIVE_THRESHOLD 0.5f
-    #endif
-
-    if (espApi) {
-        float solarCoefficient = getProductionCoefficientForType(SOURCE_PHOTOVOLTAIC);
-        if (solarCoefficient <= SOLAR_ACTIVE_THRESHOLD) {
-            solarStateCommand = CMD_ON; // orange / active
-        }
-    }
-    
-    // Send the determined command (CMD_BATTERY_IDLE for green, CMD_ON for orange)
-    sendCmd2B(slaveType, solarStateCommand);
-
-    // Optional: Keep debug output for monitoring
-    
-}
-
-void GameManager::updateWind(uint8_t slaveType, const PowerPlant& plant) {
-    // Wind powerplant control based on server-provided wind coefficient
-    // 
-    // The server sends production coefficients for wind that reflect current wind conditions.
-    // When coefficient > WIND_COEFFICIENT_THRESHOLD, wind turbines should spin.
-    // This approach allows the wind powerplant to respond to real-time wind data
-    // from the game server rather than manual user control.
-    
-    uint8_t windState = 0;
-    
-    if (espApi) {
-        float windCoefficient = getProductionCoefficientForType(SOURCE_WIND);
-        windState = (windCoefficient > WIND_COEFFICIENT_THRESHOLD) ? 1 : 0;
-        
-        // Debug output to monitor wind conditions and help tune parameters
-        static unsigned long lastWindDebug = 0;
-        if (millis() - lastWindDebug > 5000) { // Debug every 5 seconds
-            Serial.printf("[WIND] Server coefficient=%.2f, threshold=%.2f -> %s\n",
-                         windCoefficient, WIND_COEFFICIENT_THRESHOLD, 
-                         windState ? "SPINNING" : "STOPPED");
-            lastWindDebug = millis();
-        }
-        
-        if (windCoefficient == 0.0f) {
-            // No wind coefficient found or zero coefficient
-            static unsigned long lastNoDataDebug = 0;
-            if (millis() - lastNoDataDebug > 10000) { // Debug every 10 seconds
-                Serial.println("[WIND] No wind coefficient from server - turbines stopped");
-                lastNoDataDebug = millis();
-            }
-        }
-    } else {
-        // No ESP API connection - keep turbines stopped
-        static unsigned long lastNoApiDebug = 0;
-        if (millis() - lastNoApiDebug > 10000) {
-            Serial.println("[WIND] No ESP API connection - turbines stopped");
-            lastNoApiDebug = millis();
-        }
-    }
-    
-    sendAttractionCommand(slaveType, windState);
-}
-
-void GameManager::updateNuclear(uint8_t slaveType, const PowerPlant& plant) {
-    sendAttractionCommand(slaveType, onOffByPercent(plant));
-}
-
-void GameManager::updateGas(uint8_t slaveType, const PowerPlant& plant) {
-    // Gas powerplant expanded to 10 levels (commands 0x06 - 0x0F)
-    // Mapping encoder percentage -> level in 10% bands (with OFF below 5%)
-    if (plant.maxWatts <= 0.0f) {
-        sendCmd2B(slaveType, CMD_OFF);
-        return;
-    }
-
-    float pct = plant.powerPercentage.load();
-    uint8_t gasCommand = CMD_OFF;
-
-    if (pct < 0.05f) {
-        gasCommand = CMD_OFF; // below 5% off
-    } else {
-        // Determine level 1..10
-        int level = (int)floorf(pct * 10.0f); // 0..10
-        if (level == 0) level = 1;            // ensure at least level 1 for >=5%
-        if (level > 10) level = 10;
-        // Map level to command code: level1->0x06 ... level10->0x0F
-        gasCommand = 0x05 + level; // 0x06..0x0F
-    }
-
-    sendCmd2B(slaveType, gasCommand);
-
-    static unsigned long lastGasDebug = 0;
-    if (millis() - lastGasDebug > 3000) {
-        if (gasCommand == CMD_OFF) {
-            Serial.printf("[GAS] pct=%.1f%% -> OFF (cmd=0x%02X)\n", pct * 100.0f, gasCommand);
-        } else {
-            int level = gasCommand - 0x05; // 1..10
-            Serial.printf("[GAS] pct=%.1f%% -> Level %d (cmd=0x%02X)\n", pct * 100.0f, level, gasCommand);
-        }
-        lastGasDebug = millis();
-    }
-}
-
-void GameManager::updateHydro(uint8_t slaveType, const PowerPlant& plant) {
-    // Hydro powerplant control based on rotary encoder percentage
-    // Simple on/off control: OFF when encoder ≤ 50%, ON when encoder > 50%
-    uint8_t hydroState = onOffByPercent(plant);
-    sendAttractionCommand(slaveType, hydroState);
-    
-    // Debug output to verify rotary control is working
-    static unsigned long lastHydroDebug = 0;
-    if (millis() - lastHydroDebug > 3000) { // Debug every 3 seconds
-        float pct = plant.powerPercentage.load();
-        Serial.printf("[HYDRO] Encoder: %.1f%% -> %s (threshold: 50%%)\n",
-                     pct * 100.0f, hydroState ? "ON" : "OFF");
-        lastHydroDebug = millis();
-    }
-}
-
-void GameManager::updateHydroStorage(uint8_t slaveType, const PowerPlant& plant) {
-    // Hydro storage powerplant with 5-level control similar to battery
-    // Maps encoder percentage to 5 storage levels with middle stages
-    // Uses the same encoder control as battery but different command mapping
-    // 
-    // The hydro storage acts as a battery-like device but with 5 visual levels:
-    // - Level 1 (100% Full): Heavy discharging (producing power)
-    // - Level 2 (75% Full): Light discharging  
-    // - Level 3 (50% Full): Idle state (neutral)
-    // - Level 4 (25% Full): Light charging (consuming power)
-    // - Level 5 (0% Empty): Heavy charging
-    
-    if (plant.maxWatts <= 0.0f) {
-        sendCmd2B(slaveType, CMD_OFF);
-        return;
-    }
-    
-    float powerPerPlant = computePowerPerPlant(plant);
-    uint8_t cmd;
-    
-    // Normalize power to percentage of range for level determination
-    float range = plant.maxWatts - plant.minWatts;
-    float normalizedPower = (range > 0) ? powerPerPlant / (range * 0.5f) : 0.0f; // Scale to ±1.0
-    
-    // Map normalized power to 5 hydro storage levels
-    // More gradual transitions than battery for better visual feedback
-    if (normalizedPower <= -0.6f) {
-        cmd = CMD_HYDRO_STORAGE_LEVEL_5; // 0% Empty - Red (Heavy Charging)
-    } else if (normalizedPower <= -0.2f) {
-        cmd = CMD_HYDRO_STORAGE_LEVEL_4; // 25% - Light Red (Light Charging)
-    } else if (normalizedPower >= 0.6f) {
-        cmd = CMD_HYDRO_STORAGE_LEVEL_1; // 100% Full - Green (Heavy Discharging)
-    } else if (normalizedPower >= 0.2f) {
-        cmd = CMD_HYDRO_STORAGE_LEVEL_2; // 75% - Light Green (Light Discharging)
-    } else {
-        cmd = CMD_HYDRO_STORAGE_LEVEL_3; // 50% - Orange (Idle)
-    }
-    
-    // Send as pure 2B command [type, cmd4]
-    sendCmd2B(slaveType, cmd);
-    
-    // Debug output
-    static unsigned long lastHydroStorageDebug = 0;
-    if (millis() - lastHydroStorageDebug > 3000) { // Debug every 3 seconds
-        const char* levelName = "UNKNOWN";
-        switch (cmd) {
-            case CMD_HYDRO_STORAGE_LEVEL_1: levelName = "100% Full (Heavy Discharging)"; break;
-            case CMD_HYDRO_STORAGE_LEVEL_2: levelName = "75% (Light Discharging)"; break;
-            case CMD_HYDRO_STORAGE_LEVEL_3: levelName = "50% (Idle)"; break;
-            case CMD_HYDRO_STORAGE_LEVEL_4: levelName = "25% (Light Charging)"; break;
-            case CMD_HYDRO_STORAGE_LEVEL_5: levelName = "0% Empty (Heavy Charging)"; break;
-        }
-        Serial.printf("[HYDRO_STORAGE] Power=%.2fW, Normalized=%.2f -> %s (cmd=0x%02X)\n", 
-                     powerPerPlant, normalizedPower, levelName, cmd);
-        lastHydroStorageDebug = millis();
-    }
-}
-
-void GameManager::updateCoal(uint8_t slaveType, const PowerPlant& plant) {
-    sendAttractionCommand(slaveType, onOffByPercent(plant));
-}
-
-void GameManager::updateBattery(uint8_t slaveType, const PowerPlant& plant) {
-    float powerPerPlant = computePowerPerPlant(plant);
-    uint8_t cmd;
-    if (powerPerPlant == 0.0f) {
-        cmd = CMD_BATTERY_IDLE;
-    } else if (powerPerPlant < 0.0f) {
-        cmd = CMD_BATTERY_CHARGE;     // consume
-    } else {
-        cmd = CMD_BATTERY_DISCHARGE;  // produce
-    }
-    // Send as pure 2B command [type, cmd4]
-    sendCmd2B(slaveType, cmd);
-}
-
 // Compute power per plant with a zero-centered deadband for symmetric ranges
 float GameManager::computePowerPerPlant(const PowerPlant& plant) const {
     // Root-cause fix: before the game starts (no active ranges/coefficients) treat production as zero
@@ -465,25 +691,61 @@ float GameManager::computePowerPerPlant(const PowerPlant& plant) const {
         return 0.0f;
     }
 
-    return value;
+    // Storage cannot discharge when empty or charge when full
+    const StorageIntegrator* storage = storageForType(static_cast<uint8_t>(plant.plantType));
+    return storage ? storage->limitPower(value) : value;
 }
 
-void GameManager::applyPendingDecreases() {
-    if (pendingDecreases.empty()) return;
-    auto now = millis();
-    bool anyApplied = false;
-    pendingDecreases.erase(std::remove_if(pendingDecreases.begin(), pendingDecreases.end(), [&](const PendingDecrease &pd){
-        if (now - pd.firstSeen >= DECREASE_GRACE_MS) {
-            // Commit decrease
-            for (auto &p : uartPowerplants) if (p.slaveType == pd.slaveType) { p.amount = pd.targetAmount; break; }
-            Serial.printf("[UART] Type %u decrease applied after grace: %u -> %u\n", pd.slaveType, pd.originalAmount, pd.targetAmount);
-            anyApplied = true;
-            return true; // remove from pending
+StorageIntegrator* GameManager::storageForType(uint8_t slaveType) {
+    return slaveType == BATTERY ? &batteryStorage : (slaveType == HYDRO_STORAGE ? &hydroStorage : nullptr);
+}
+
+const StorageIntegrator* GameManager::storageForType(uint8_t slaveType) const {
+    return slaveType == BATTERY ? &batteryStorage : (slaveType == HYDRO_STORAGE ? &hydroStorage : nullptr);
+}
+
+void GameManager::updateStorage(unsigned long now) {
+    static const uint8_t STORAGE_TYPES[] = {BATTERY, HYDRO_STORAGE};
+    for (uint8_t type : STORAGE_TYPES) {
+        StorageIntegrator& storage = *storageForType(type);
+        const PowerPlant* plant = getPowerPlantByType(static_cast<PowerPlantType>(type));
+
+        uint8_t units = 0;
+        for (const auto& uartPlant : uartPowerplants) {
+            if (uartPlant.slaveType == type) { units = uartPlant.amount; break; }
         }
-        return false; // keep
-    }), pendingDecreases.end());
-    if (anyApplied) {
-        // Optional: could trigger immediate attraction update, but caller usually handles.
+        // Capacity follows the server range: one unit at full power empties in the configured time
+        const float seconds = type == BATTERY ? BATTERY_FULL_POWER_SECONDS : HYDRO_STORAGE_FULL_POWER_SECONDS;
+        const float capacityWh = plant ? fabsf(plant->maxWatts) * seconds / 3600.0f : 0.0f;
+        storage.configure(capacityWh, units);
+        storage.setPower(plant ? plant->powerSetting.load() : 0.0f);
+
+        const StorageIntegrator::Boundary boundary = storage.getBoundary();
+        if (storage.advance(now) == 0) continue;
+
+        // Hitting empty / full changes the limited power; a new fill level changes the display
+        bool changed = storage.getBoundary() != boundary;
+        const auto& policy = ActuationPolicy::forType(type);
+        const auto& levelState = actuationLevels[type];
+        if (policy.source == ActuationPolicy::INPUT_STATE_OF_CHARGE && levelState.valid &&
+            ActuationPolicy::quantizeFrom(policy, storage.getSoc(), levelState.level) != levelState.level) {
+            changed = true;
+        }
+        if (changed) raiseActuationEvent(type);
+    }
+}
+
+void GameManager::applyExpiredAmountChanges() {
+    auto now = millis();
+    if (!uartDebouncer.hasExpired(now)) return; // no deadline due yet, O(1)
+
+    uint16_t committed = uartDebouncer.expire(now);
+    while (committed) {
+        uint8_t type = __builtin_ctz(committed);
+        committed &= committed - 1;
+        uint8_t amount = uartDebouncer.getCommitted(type);
+        setUartAmount(type, amount);
+        Serial.printf("[UART] Type %u change applied after grace: amount=%u\n", type, amount);
     }
 }
 
@@ -615,15 +877,7 @@ void GameManager::updateDisplaysImpl() {
     if (productionTotalDisplay) {
         float totalProduction = getTotalProduction();
         if (!retranslationConnected) {
-            static unsigned long lastBlinkTime = 0;
-            static bool blinkState = false;
-            
-            if (millis() - lastBlinkTime >= 500) { // Blink every 500ms
-                blinkState = !blinkState;
-                lastBlinkTime = millis();
-            }
-            
-            if (blinkState) {
+            if (displayBlinkState) { // blink phase toggled by the scheduler
                 productionTotalDisplay->displayNumber(totalProduction, 1);
             } else {
                 productionTotalDisplay->clear(); // Turn off display for blink effect
@@ -634,15 +888,7 @@ void GameManager::updateDisplaysImpl() {
     }    if (consumptionTotalDisplay) {
         float totalConsumption = getTotalConsumption();
         if (!retranslationConnected) {
-            static unsigned long lastBlinkTime = 0;
-            static bool blinkState = false;
-            
-            if (millis() - lastBlinkTime >= 500) { // Blink every 500ms
-                blinkState = !blinkState;
-                lastBlinkTime = millis();
-            }
-            
-            if (blinkState) {
+            if (displayBlinkState) { // blink phase toggled by the scheduler
                 consumptionTotalDisplay->displayNumber(totalConsumption, 1);
             } else {
                 consumptionTotalDisplay->clear(); // Turn off display for blink effect
@@ -651,6 +897,8 @@ void GameManager::updateDisplaysImpl() {
             consumptionTotalDisplay->displayNumber(totalConsumption, 1);
         }
     }
+
+    powerTraceDue = false; // this pass logged every type once
 }
 #ifdef __GNUC__
 #pragma GCC pop_options
@@ -0,0 +1,122 @@
+#include "amount_debouncer.h"
+#include <string.h>
+
+AmountDebouncer::AmountDebouncer() : pendingMask(0), nextDeadline(0) {
+    memset(slots, 0, sizeof(slots));
+}
+
+void AmountDebouncer::configure(uint8_t type, uint16_t decreaseGraceMs, uint16_t increaseGraceMs) {
+    if (type >= MAX_TYPES) return;
+    slots[type].decreaseGraceMs = decreaseGraceMs;
+    slots[type].increaseGraceMs = increaseGraceMs;
+}
+
+void AmountDebouncer::setCommitted(uint8_t type, uint8_t amount) {
+    if (type >= MAX_TYPES) return;
+    clearPending(type);
+    slots[type].committed = amount;
+    slots[type].target = amount;
+    slots[type].known = true;
+}
+
+AmountDebouncer::Result AmountDebouncer::observe(uint8_t type, uint8_t amount, unsigned long now) {
+    if (type >= MAX_TYPES) return NO_CHANGE;
+    Slot& slot = slots[type];
+
+    // First report for this type is taken as-is
+    if (!slot.known) {
+        slot.known = true;
+        commit(type, amount);
+        return COMMITTED;
+    }
+
+    if (amount == slot.committed) {
+        if (slot.state == STABLE) return NO_CHANGE;
+        // Amount came back before the deadline -> the staged change was noise
+        slot.flapCount++;
+        clearPending(type);
+        return CANCELLED;
+    }
+
+    const bool decreasing = amount < slot.committed;
+    const State wanted = decreasing ? PENDING_DECREASE : PENDING_INCREASE;
+    const uint16_t graceMs = decreasing ? slot.decreaseGraceMs : slot.increaseGraceMs;
+
+    if (slot.state != STABLE && slot.state != wanted) {
+        // Direction reversed while pending: abandoned change counts as a flap
+        slot.flapCount++;
+        clearPending(type);
+    }
+
+    if (graceMs == 0) {
+        commit(type, amount);
+        return COMMITTED;
+    }
+
+    if (slot.state == wanted) {
+        if (slot.target == amount) return NO_CHANGE; // keep running timer
+        stage(type, wanted, amount, graceMs, now);
+        return RESTAGED;
+    }
+
+    stage(type, wanted, amount, graceMs, now);
+    return STAGED;
+}
+
+uint16_t AmountDebouncer::expire(unsigned long now) {
+    if (!hasExpired(now)) return 0;
+
+    uint16_t committedMask = 0;
+    uint16_t mask = pendingMask;
+    while (mask) {
+        uint8_t type = __builtin_ctz(mask);
+        mask &= mask - 1;
+        if (static_cast<long>(now - slots[type].deadline) >= 0) {
+            uint8_t target = slots[type].target;
+            clearPending(type);
+            commit(type, target);
+            committedMask |= static_cast<uint16_t>(1u << type);
+        }
+    }
+    recomputeNextDeadline();
+    return committedMask;
+}
+
+void AmountDebouncer::commit(uint8_t type, uint8_t amount) {
+    Slot& slot = slots[type];
+    slot.committed = amount;
+    slot.target = amount;
+    slot.commitCount++;
+}
+
+void AmountDebouncer::stage(uint8_t type, State state, uint8_t amount, uint16_t graceMs, unsigned long now) {
+    Slot& slot = slots[type];
+    slot.state = state;
+    slot.target = amount;
+    slot.deadline = now + graceMs;
+    // A stale (too early) nextDeadline is harmless: expire() rescans and recomputes it
+    if (pendingMask == 0 || static_cast<long>(slot.deadline - nextDeadline) < 0) {
+        nextDeadline = slot.deadline;
+    }
+    pendingMask |= static_cast<uint16_t>(1u << type);
+}
+
+void AmountDebouncer::clearPending(uint8_t type) {
+    Slot& slot = slots[type];
+    slot.state = STABLE;
+    slot.target = slot.committed;
+    pendingMask &= static_cast<uint16_t>(~(1u << type));
+}
+
+void AmountDebouncer::recomputeNextDeadline() {
+    uint16_t mask = pendingMask;
+    bool first = true;
+    while (mask) {
+        uint8_t type = __builtin_ctz(mask);
+        mask &= mask - 1;
+        if (first || static_cast<long>(slots[type].deadline - nextDeadline) < 0) {
+            nextDeadline = slots[type].deadline;
+            first = false;
+        }
+    }
+}
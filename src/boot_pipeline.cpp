@@ -0,0 +1,71 @@
+#include "boot_pipeline.h"
+#include <Arduino.h>
+#include <string.h>
+
+static constexpr uint32_t ALL_STAGES = (1u << BootPipeline::STAGE_COUNT) - 1;
+
+BootPipeline::BootPipeline() : doneBits(nullptr) {
+    memset(timings, 0, sizeof(timings));
+    memset(taskArgs, 0, sizeof(taskArgs));
+}
+
+void BootPipeline::begin() {
+    if (!doneBits) doneBits = xEventGroupCreate();
+}
+
+const char* BootPipeline::stageName(Stage stage) {
+    static const char* const names[STAGE_COUNT] = { "peripherals", "warm-start", "display", "uart", "nfc", "wifi",
+                                                     "server" };
+    return stage < STAGE_COUNT ? names[stage] : "?";
+}
+
+bool BootPipeline::execute(Stage stage, StageFn fn) {
+    timings[stage].startMs = millis();
+    const bool ok = fn();
+    timings[stage].endMs = millis();
+    timings[stage].ok = ok;
+    Serial.printf("[BOOT] %s %s in %lu ms (t=%lu ms)\n", stageName(stage), ok ? "done" : "FAILED",
+                  (unsigned long)(timings[stage].endMs - timings[stage].startMs), (unsigned long)timings[stage].endMs);
+
+    const EventBits_t done = xEventGroupSetBits(doneBits, bit(stage));
+    if ((done & ALL_STAGES) == ALL_STAGES) printReport();
+    return ok;
+}
+
+bool BootPipeline::run(Stage stage, StageFn fn) {
+    return execute(stage, fn);
+}
+
+void BootPipeline::taskEntry(void* arg) {
+    TaskArgs* args = static_cast<TaskArgs*>(arg);
+    if (args->dependsOn) {
+        xEventGroupWaitBits(args->pipeline->doneBits, args->dependsOn, pdFALSE, pdTRUE, portMAX_DELAY);
+    }
+    args->pipeline->execute(args->stage, args->fn);
+    vTaskDelete(nullptr);
+}
+
+bool BootPipeline::start(Stage stage, StageFn fn, uint32_t dependsOn, uint32_t stackSize, uint8_t priority) {
+    TaskArgs& args = taskArgs[stage];
+    args.pipeline = this;
+    args.stage = stage;
+    args.fn = fn;
+    args.dependsOn = dependsOn;
+    if (xTaskCreate(taskEntry, stageName(stage), stackSize, &args, priority, nullptr) == pdPASS) return true;
+
+    Serial.printf("[BOOT] Could not start a task for %s, running it inline\n", stageName(stage));
+    if (dependsOn) xEventGroupWaitBits(doneBits, dependsOn, pdFALSE, pdTRUE, portMAX_DELAY);
+    return execute(stage, fn);
+}
+
+void BootPipeline::printReport() const {
+    Serial.println("[BOOT] Stage        start    end   duration");
+    for (uint8_t i = 0; i < STAGE_COUNT; i++) {
+        const Timing& t = timings[i];
+        Serial.printf("  %-12s %6lu %6lu %6lu ms%s\n", stageName(static_cast<Stage>(i)), (unsigned long)t.startMs,
+                      (unsigned long)t.endMs, (unsigned long)(t.endMs - t.startMs), t.ok ? "" : " FAILED");
+    }
+    Serial.printf("[BOOT] Time to first display %lu ms, UART ready %lu ms, server ready %lu ms\n",
+                  (unsigned long)timings[STAGE_DISPLAY].endMs, (unsigned long)timings[STAGE_UART].endMs,
+                  (unsigned long)timings[STAGE_SERVER].endMs);
+}
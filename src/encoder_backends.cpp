@@ -0,0 +1,72 @@
+#include "encoder_backends.h"
+#include <Arduino.h>
+
+static uint8_t nextPcntUnit = 0;
+
+PcntEncoder* PcntEncoder::create(int pinA, int pinB, long minValue, long maxValue, uint8_t edgesPerStep) {
+    if (nextPcntUnit >= PCNT_UNIT_MAX) {
+        Serial.printf("[ENCODER] No PCNT unit left for pins %d/%d\n", pinA, pinB);
+        return nullptr;
+    }
+    pcnt_unit_t unit = static_cast<pcnt_unit_t>(nextPcntUnit);
+    PcntEncoder* encoder = new PcntEncoder(unit, minValue, maxValue, edgesPerStep);
+    if (!encoder->begin(pinA, pinB)) {
+        Serial.printf("[ENCODER] PCNT unit %u setup failed for pins %d/%d\n", nextPcntUnit, pinA, pinB);
+        delete encoder;
+        return nullptr;
+    }
+    nextPcntUnit++;
+    Serial.printf("[ENCODER] Pins %d/%d on PCNT unit %u (x4, filter %u cycles)\n",
+                  pinA, pinB, static_cast<unsigned>(unit), ENCODER_PCNT_FILTER_CYCLES);
+    return encoder;
+}
+
+bool PcntEncoder::begin(int pinA, int pinB) {
+    // Channel 0 counts A edges, B decides direction; channel 1 counts B edges, A decides.
+    // Together every edge of the Gray sequence 00 -> 10 -> 11 -> 01 counts +1 (A leads B).
+    pcnt_config_t config = {};
+    config.pulse_gpio_num = pinA;
+    config.ctrl_gpio_num = pinB;
+    config.channel = PCNT_CHANNEL_0;
+    config.unit = unit;
+    config.pos_mode = PCNT_COUNT_INC;
+    config.neg_mode = PCNT_COUNT_DEC;
+    config.lctrl_mode = PCNT_MODE_KEEP;
+    config.hctrl_mode = PCNT_MODE_REVERSE;
+    config.counter_h_lim = PCNT_LIMIT;
+    config.counter_l_lim = -PCNT_LIMIT;
+    if (pcnt_unit_config(&config) != ESP_OK) return false;
+
+    config.pulse_gpio_num = pinB;
+    config.ctrl_gpio_num = pinA;
+    config.channel = PCNT_CHANNEL_1;
+    config.pos_mode = PCNT_COUNT_DEC;
+    config.neg_mode = PCNT_COUNT_INC;
+    if (pcnt_unit_config(&config) != ESP_OK) return false;
+
+    // Encoders are wired to ground with internal pull-ups, like the GPIO backend
+    gpio_pullup_en(static_cast<gpio_num_t>(pinA));
+    gpio_pullup_en(static_cast<gpio_num_t>(pinB));
+
+    pcnt_set_filter_value(unit, ENCODER_PCNT_FILTER_CYCLES);
+    pcnt_filter_enable(unit);
+
+    pcnt_counter_pause(unit);
+    pcnt_counter_clear(unit);
+    pcnt_counter_resume(unit);
+    lastRaw = 0;
+    resetReference();
+    return true;
+}
+
+int32_t PcntEncoder::readCount() {
+    int16_t raw = 0;
+    pcnt_get_counter_value(unit, &raw);
+    // A jump of more than half the range means the counter restarted at a limit
+    int32_t delta = static_cast<int32_t>(raw) - lastRaw;
+    if (delta > PCNT_LIMIT / 2) delta -= PCNT_LIMIT;
+    else if (delta < -PCNT_LIMIT / 2) delta += PCNT_LIMIT;
+    lastRaw = raw;
+    extended += delta;
+    return extended;
+}
@@ -0,0 +1,125 @@
+#include "journal_upload.h"
+#include "server_events.h"
+#include <Arduino.h>
+#include <WiFi.h>
+#include <WiFiClient.h>
+#include <freertos/FreeRTOS.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+JournalUpload::JournalUpload()
+    : pump(nullptr), started(false), batches(0), records(0), failures(0), lastStatus(0), tls("journal") {
+    url[0] = '\0';
+    tls.setHandshakeTimeout(TIMEOUT_MS);
+}
+
+bool JournalUpload::begin(const char* serverUrl, Pump pump) {
+    if (started.load()) return true;
+    char host[ServerEvents::MAX_HOST_LEN + 1];
+    uint16_t port;
+    bool secure;
+    if (!pump || !ServerEvents::parseUrl(serverUrl, host, port, secure) || strlen(serverUrl) >= sizeof(url)) {
+        Serial.printf("[JOURNAL] Cannot upload to %s, the journal is kept on the board\n",
+                      serverUrl ? serverUrl : "(none)");
+        return false;
+    }
+    strcpy(url, serverUrl);
+    this->pump = pump;
+    if (xTaskCreate(taskEntry, "journal", TASK_STACK, this, 1, nullptr) != pdPASS) {
+        Serial.println("[JOURNAL] Could not start the upload task");
+        return false;
+    }
+    started = true;
+    return true;
+}
+
+void JournalUpload::taskEntry(void* arg) {
+    static_cast<JournalUpload*>(arg)->run();
+}
+
+void JournalUpload::run() {
+    uint32_t backoffMs = JOURNAL_UPLOAD_CHECK_MS;
+    for (;;) {
+        if (WiFi.status() != WL_CONNECTED) {
+            delay(1000);
+            continue;
+        }
+        const int delivered = pump(*this, millis());
+        if (delivered < 0) {
+            failures++;
+            backoffMs = backoffMs * 2 > JOURNAL_UPLOAD_RETRY_MAX_MS ? JOURNAL_UPLOAD_RETRY_MAX_MS : backoffMs * 2;
+            delay(backoffMs);
+            continue;
+        }
+        backoffMs = JOURNAL_UPLOAD_CHECK_MS;
+        if (delivered == 0) delay(JOURNAL_UPLOAD_CHECK_MS);   // otherwise straight on to the next batch
+    }
+}
+
+bool JournalUpload::send(const JournalRecord* batch, uint16_t count, uint32_t now) {
+    const size_t length = formatJournalBatch(batch, count, BOARD_ID, now, body, sizeof(body));
+    if (length == 0) return false;
+
+    char host[ServerEvents::MAX_HOST_LEN + 1];
+    uint16_t port;
+    bool secure;
+    ServerEvents::parseUrl(url, host, port, secure);
+
+    WiFiClient plain;
+    Client& client = secure ? static_cast<Client&>(tls) : static_cast<Client&>(plain);
+    lastStatus = 0;
+    if (!client.connect(host, port)) {
+        Serial.printf("[JOURNAL] Connect to %s:%u failed\n", host, port);
+        return false;
+    }
+
+    char request[192];
+    const int headerLength = snprintf(request, sizeof(request),
+                                      "POST %s HTTP/1.0\r\nHost: %s\r\nContent-Type: application/json\r\n"
+                                      "Content-Length: %u\r\n\r\n",
+                                      JOURNAL_UPLOAD_PATH, host, (unsigned)length);
+    client.write(reinterpret_cast<const uint8_t*>(request), headerLength);
+    client.write(reinterpret_cast<const uint8_t*>(body), length);
+
+    // Status line only: "HTTP/1.x NNN ..."
+    char line[32];
+    size_t lineLength = 0;
+    const unsigned long deadline = millis() + TIMEOUT_MS;
+    while (static_cast<long>(millis() - deadline) < 0) {
+        if (!client.available()) {
+            if (!client.connected()) break;
+            delay(10);
+            continue;
+        }
+        uint8_t c;
+        if (client.read(&c, 1) != 1) continue;
+        if (c == '\n' || lineLength + 1 == sizeof(line)) break;
+        if (c != '\r') line[lineLength++] = static_cast<char>(c);
+    }
+    line[lineLength] = '\0';
+    client.stop();
+
+    const uint16_t status =
+        strncmp(line, "HTTP/1.", 7) == 0 ? static_cast<uint16_t>(strtol(line + 8, nullptr, 10)) : 0;
+    lastStatus = status;
+    if (status < 200 || status >= 300) {
+        Serial.printf("[JOURNAL] %s%s did not take %u records: %s\n", url, JOURNAL_UPLOAD_PATH, count,
+                      line[0] ? line : "no answer");
+        return false;
+    }
+    batches++;
+    records += count;
+    return true;
+}
+
+void JournalUpload::print() const {
+    if (!started.load()) {
+        Serial.println("[JOURNAL] Upload not started");
+        return;
+    }
+    Serial.printf("[JOURNAL] Backfill: %lu records in %lu requests, %lu failed, last status %u\n",
+                  (unsigned long)records.load(), (unsigned long)batches.load(), (unsigned long)failures.load(),
+                  (unsigned)lastStatus.load());
+    tls.print("JOURNAL");
+}
@@ -0,0 +1,164 @@
+#include "live_telemetry.h"
+#include <Arduino.h>
+#include <WiFi.h>
+#include <ESPAsyncWebServer.h>
+#include <string.h>
+
+LiveTelemetry::LiveTelemetry()
+    : server(nullptr), socket(nullptr), framesSent(0), keyFramesSent(0), bytesSent(0), framesSkipped(0),
+      clientsDropped(0), clientsRejected(0) {
+    for (auto& sub : subscribers) sub.clientId = 0;
+}
+
+void LiveTelemetry::begin() {
+    if (socket) return;
+    server = new AsyncWebServer(LIVE_TELEMETRY_PORT);
+    socket = new AsyncWebSocket(LIVE_TELEMETRY_PATH);
+    socket->onEvent([this](AsyncWebSocket*, AsyncWebSocketClient* client, AwsEventType type, void* arg,
+                           uint8_t* data, size_t len) {
+        switch (type) {
+        case WS_EVT_CONNECT: onConnect(client); break;
+        case WS_EVT_DISCONNECT: onDisconnect(client->id()); break;
+        case WS_EVT_DATA: {
+            // Only whole single-frame messages carry a rate request
+            const AwsFrameInfo* info = static_cast<const AwsFrameInfo*>(arg);
+            if (info->final && info->index == 0 && info->len == len) onRateRequest(client->id(), data, len);
+            break;
+        }
+        default: break;
+        }
+    });
+    server->addHandler(socket);
+    server->begin();
+    Serial.printf("[LIVE] Telemetry stream on ws://%s:%u%s\n", WiFi.localIP().toString().c_str(),
+                  (unsigned)LIVE_TELEMETRY_PORT, LIVE_TELEMETRY_PATH);
+}
+
+LiveTelemetry::Subscriber* LiveTelemetry::find(uint32_t clientId) {
+    for (auto& sub : subscribers) {
+        if (sub.clientId == clientId) return &sub;
+    }
+    return nullptr;
+}
+
+void LiveTelemetry::onConnect(AsyncWebSocketClient* client) {
+    {
+        std::lock_guard<std::mutex> lock(subscribersMutex);
+        Subscriber* sub = find(0);
+        if (sub) {
+            sub->clientId = client->id();
+            sub->intervalMs = 1000 / LIVE_TELEMETRY_DEFAULT_HZ;
+            sub->keyed = false;
+            sub->sequence = 0;
+            sub->lastCheckAt = 0;
+            sub->lastSentAt = 0;
+            sub->lastKeyAt = 0;
+            sub->stalledSince = 0;
+            Serial.printf("[LIVE] Client #%lu subscribed\n", (unsigned long)client->id());
+            return;
+        }
+        clientsRejected++;
+    }
+    Serial.printf("[LIVE] Client #%lu rejected, %u subscribers already\n", (unsigned long)client->id(),
+                  (unsigned)LIVE_TELEMETRY_MAX_CLIENTS);
+    client->close();
+}
+
+void LiveTelemetry::onDisconnect(uint32_t clientId) {
+    std::lock_guard<std::mutex> lock(subscribersMutex);
+    Subscriber* sub = find(clientId);
+    if (sub) sub->clientId = 0;
+}
+
+void LiveTelemetry::onRateRequest(uint32_t clientId, const uint8_t* data, size_t len) {
+    if (len != 1 || data[0] == 0) return;
+    const uint8_t hz = data[0] > LIVE_TELEMETRY_MAX_HZ ? LIVE_TELEMETRY_MAX_HZ : data[0];
+    std::lock_guard<std::mutex> lock(subscribersMutex);
+    Subscriber* sub = find(clientId);
+    if (sub) sub->intervalMs = static_cast<uint16_t>(1000 / hz);
+}
+
+bool LiveTelemetry::isDue(const Subscriber& sub, unsigned long now) const {
+    return sub.clientId != 0 && (!sub.keyed || now - sub.lastCheckAt >= sub.intervalMs);
+}
+
+bool LiveTelemetry::wantsFrame(unsigned long now) {
+    if (!socket) return false;
+    std::lock_guard<std::mutex> lock(subscribersMutex);
+    for (const auto& sub : subscribers) {
+        if (isDue(sub, now)) return true;
+    }
+    return false;
+}
+
+void LiveTelemetry::publish(const TelemetrySnapshot& snapshot, unsigned long now) {
+    if (!socket) return;
+    uint8_t frame[TelemetryFrame::MAX_SIZE];
+    uint32_t stalled[LIVE_TELEMETRY_MAX_CLIENTS];
+    uint8_t stalledCount = 0;
+    {
+        std::lock_guard<std::mutex> lock(subscribersMutex);
+        for (auto& sub : subscribers) {
+            if (!isDue(sub, now)) continue;
+            sub.lastCheckAt = now;
+            if (sub.keyed && snapshot.diff(sub.baseline) == 0 && now - sub.lastSentAt < LIVE_TELEMETRY_HEARTBEAT_MS) {
+                continue;
+            }
+
+            AsyncWebSocketClient* client = socket->client(sub.clientId);
+            if (!client || client->status() != WS_CONNECTED) continue;   // disconnect event still on its way
+            if (client->queueIsFull()) {
+                // Keep the baseline: the next delta that fits covers everything since then
+                framesSkipped++;
+                if (sub.stalledSince == 0) {
+                    sub.stalledSince = now | 1;
+                } else if (now - sub.stalledSince >= LIVE_TELEMETRY_STALL_MS) {
+                    stalled[stalledCount++] = sub.clientId;
+                    sub.clientId = 0;
+                }
+                continue;
+            }
+
+            // Only queued frames move the baseline and the sequence on
+            const bool key = !sub.keyed || now - sub.lastKeyAt >= LIVE_TELEMETRY_KEYFRAME_MS;
+            const size_t len = TelemetryFrame::encode(snapshot, key ? nullptr : &sub.baseline, sub.sequence,
+                                                      static_cast<uint32_t>(now), frame);
+            client->binary(frame, len);
+            sub.sequence++;
+            sub.baseline = snapshot;
+            sub.keyed = true;
+            sub.lastSentAt = now;
+            if (key) {
+                sub.lastKeyAt = now;
+                keyFramesSent++;
+            }
+            sub.stalledSince = 0;
+            framesSent++;
+            bytesSent += len;
+        }
+    }
+
+    // Outside the lock: closing may call back into the event handler
+    for (uint8_t i = 0; i < stalledCount; i++) {
+        clientsDropped++;
+        Serial.printf("[LIVE] Client #%lu too slow, disconnecting\n", (unsigned long)stalled[i]);
+        socket->close(stalled[i]);
+    }
+    socket->cleanupClients();
+}
+
+void LiveTelemetry::print() const {
+    if (!socket) {
+        Serial.println("[LIVE] Telemetry stream not started (waiting for WiFi)");
+        return;
+    }
+    uint8_t active = 0;
+    for (const auto& sub : subscribers) {
+        if (sub.clientId != 0) active++;
+    }
+    Serial.printf("[LIVE] %u/%u subscribers, %lu frames (%lu key), %lu bytes, %lu skipped (queue full), "
+                  "%lu dropped, %lu rejected\n",
+                  active, (unsigned)LIVE_TELEMETRY_MAX_CLIENTS, (unsigned long)framesSent,
+                  (unsigned long)keyFramesSent, (unsigned long)bytesSent,
+                  (unsigned long)framesSkipped, (unsigned long)clientsDropped, (unsigned long)clientsRejected);
+}
@@ -0,0 +1,79 @@
+#include "loop_profiler.h"
+#include <Arduino.h>
+
+#if LOOP_PROFILER_ENABLED
+
+LoopProfiler::LoopProfiler() : stageCount(0) {
+    for (uint8_t i = 0; i < MAX_STAGES; i++) names[i] = nullptr;
+    reset();
+}
+
+void LoopProfiler::setStageName(uint8_t stage, const char* name) {
+    if (stage >= MAX_STAGES) return;
+    names[stage] = name;
+    if (stage >= stageCount) stageCount = stage + 1;
+}
+
+void LoopProfiler::beginIteration() {
+    currentMask = 0;
+    iterationStart = cycles();
+}
+
+void LoopProfiler::record(uint8_t stage, uint32_t elapsedCycles) {
+    if (stage >= MAX_STAGES) return;
+    stages[stage].record(elapsedCycles);
+    current[stage] = elapsedCycles;
+    currentMask |= static_cast<uint16_t>(1u << stage);
+}
+
+void LoopProfiler::endIteration() {
+    if (currentMask == 0) return;
+    const uint32_t total = cycles() - iterationStart;
+    iterations.record(total);
+    if (total > worstTotal) {
+        worstTotal = total;
+        worstMask = currentMask;
+        for (uint8_t i = 0; i < MAX_STAGES; i++) worst[i] = (currentMask >> i) & 1u ? current[i] : 0;
+    }
+}
+
+void LoopProfiler::reset() {
+    for (uint8_t i = 0; i < MAX_STAGES; i++) {
+        stages[i].reset();
+        current[i] = 0;
+        worst[i] = 0;
+    }
+    iterations.reset();
+    iterationStart = 0;
+    currentMask = 0;
+    worstTotal = 0;
+    worstMask = 0;
+}
+
+void LoopProfiler::print() const {
+    const float mhz = static_cast<float>(getCpuFrequencyMhz());
+    Serial.printf("[PROFILE] %lu iterations, us: min/avg/p99/max %.1f/%.1f/%.1f/%.1f\n",
+                  (unsigned long)iterations.getCount(), iterations.getMin() / mhz, iterations.getAverage() / mhz,
+                  iterations.percentile(99) / mhz, iterations.getMax() / mhz);
+    for (uint8_t i = 0; i < stageCount; i++) {
+        const LatencyHistogram& h = stages[i];
+        if (h.getCount() == 0) continue;
+        Serial.printf("  %-10s n=%-7lu %8.1f %8.1f %8.1f %8.1f\n", names[i] ? names[i] : "?",
+                      (unsigned long)h.getCount(), h.getMin() / mhz, h.getAverage() / mhz,
+                      h.percentile(99) / mhz, h.getMax() / mhz);
+    }
+    if (worstTotal == 0) return;
+    Serial.printf("[PROFILE] Worst iteration %.1f us:", worstTotal / mhz);
+    for (uint8_t i = 0; i < stageCount; i++) {
+        if ((worstMask >> i) & 1u) Serial.printf(" %s=%.1f", names[i] ? names[i] : "?", worst[i] / mhz);
+    }
+    Serial.println();
+}
+
+#else
+
+void LoopProfiler::print() const {
+    Serial.println("[PROFILE] Profiler compiled out (LOOP_PROFILER_ENABLED=0)");
+}
+
+#endif
@@ -4,11 +4,10 @@
  ******************************************************************************/
 #include <Arduino.h>
 #include <WiFi.h>
-#include <WiFiUdp.h>
-#include <WiFiClient.h>
 #include <vector>
 #include <algorithm>
 #include "PeripheralFactory.h"
+#include "encoder_backends.h"
 #include <SPI.h>
 #include <MFRC522.h>
 #include <NFCBuildingRegistry.h>
@@ -17,6 +16,12 @@
 #include "power_plant_config.h"
 #include "GameManager.h"
 #include "robust_uart.h"
+#include "scheduler.h"
+#include "server_discovery.h"
+#include "boot_pipeline.h"
+#include "live_telemetry.h"
+#include "server_events.h"
+#include "journal_upload.h"
 #include "secrets.h"
 
 /* ------------------------------------------------------------------ */
@@ -80,148 +85,25 @@ hw_timer_t *displayTimer = nullptr;
 static const uint8_t SERVER_MAC_1[6] = {0x74, 0x3A, 0xF4, 0x10, 0xD5, 0x7E};
 static const uint8_t SERVER_MAC_2[6] = {0x00, 0xD8, 0x61, 0x31, 0x29, 0xC5};
 
-WiFiUDP udp;
+// Hosts that usually run the server on our event LANs; probed before the sweep
+static const uint8_t SERVER_PREFERRED_HOSTS[] = {2, 6, 210, 11, 100, 105, 106, 101, 200, 201,
+                                                 4, 7, 8, 9, 10, 12, 13, 14, 15, 3};
 
-// Find HTTP server by connecting and then checking if we can find the expected MAC
-IPAddress findHttpServer()
+// Remembered server first (when allowed), else UDP broadcast and a parallel port sweep; every
+// candidate must pass the discovery check. 0.0.0.0 = not found
+IPAddress discoverServer(bool useCache, bool &fromCache)
 {
-    IPAddress myIp = WiFi.localIP();
-    IPAddress mask = WiFi.subnetMask();
-
-    WiFiClient client;
-
-    Serial.printf("[Server Discovery] Scanning network %s with mask %s\n",
-                  myIp.toString().c_str(), mask.toString().c_str());
-    Serial.printf("[Server Discovery] Looking for HTTP servers with known MACs:\n");
-    Serial.printf("   MAC 1: %02X:%02X:%02X:%02X:%02X:%02X\n",
-                  SERVER_MAC_1[0], SERVER_MAC_1[1], SERVER_MAC_1[2],
-                  SERVER_MAC_1[3], SERVER_MAC_1[4], SERVER_MAC_1[5]);
-    Serial.printf("   MAC 2: %02X:%02X:%02X:%02X:%02X:%02X\n",
-                  SERVER_MAC_2[0], SERVER_MAC_2[1], SERVER_MAC_2[2],
-                  SERVER_MAC_2[3], SERVER_MAC_2[4], SERVER_MAC_2[5]);
-
-    // Calculate subnet base address
-    uint8_t subnet[4] = {(uint8_t)(myIp[0] & mask[0]),
-                         (uint8_t)(myIp[1] & mask[1]),
-                         (uint8_t)(myIp[2] & mask[2]),
-                         0};
-
-    Serial.printf("[Server Discovery] Subnet base: %d.%d.%d.0\n", subnet[0], subnet[1], subnet[2]);
-
-    uint32_t hostsScanned = 0;
-
-    // First try common server IPs
-    uint8_t commonHosts[] = {2,  6, 210, 11, 100, 105, 105, 106, 106, 101, 106, 200, 201, 4,  7, 8, 9, 10, 12, 13, 14, 105, 15, 3, 106, 106, 106};
-    for (uint8_t host : commonHosts)
-    {
-        IPAddress target(subnet[0], subnet[1], subnet[2], host);
-        if (target == myIp)
-            continue;
-
-        hostsScanned++;
-        Serial.printf("[Server Discovery] Testing common host %s...", target.toString().c_str());
-
-        if (client.connect(target, 80, 600))
-        {                  // 150 ms timeout
-            client.stop(); // handshake OK
-            Serial.println(" ✓ HTTP server found!");
-            return target;
-        }
-        Serial.println(" ✗");
-    }
-
-    // If no common hosts work, try full scan
-    Serial.println("[Server Discovery] No common hosts found, trying full scan...");
-
-    for (uint16_t host = 2; host < 255; ++host)
-    {
-        // Skip our own address and already-tested common hosts
-        if (host == myIp[3])
-            continue;
-
-        bool alreadyTested = false;
-        for (uint8_t commonHost : commonHosts)
-        {
-            if (host == commonHost)
-            {
-                alreadyTested = true;
-                break;
-            }
-        }
-        if (alreadyTested)
-            continue;
-
-        IPAddress target(subnet[0], subnet[1], subnet[2], host);
-
-        hostsScanned++;
-        if (hostsScanned % 50 == 0)
-        {
-            Serial.printf("[Server Discovery] Scanned %lu hosts...\n", hostsScanned);
-        }
-        // testing mac address
-        if (client.connect(target, 80, 150) && (client.localIP() == target))
-        {                  // 150 ms timeout
-            client.stop(); // handshake OK
-            Serial.printf("✅ HTTP server found at %s\n", target.toString().c_str());
-            return target;
-        }
-        else
-        {
-            Serial.printf("✗ %s and mac %02X:%02X:%02X:%02X:%02X:%02X\n",
-                          target.toString().c_str(),
-                          client.localIP()[0], client.localIP()[1],
-                          client.localIP()[2], client.localIP()[3],
-                          client.localIP()[4], client.localIP()[5]);
-        }
-    }
-
-    Serial.printf("[Server Discovery] Scanned %lu hosts total, no HTTP server found\n", hostsScanned);
-    return IPAddress(); // 0.0.0.0 = not found
-}
-
-// UDP broadcast discovery (fallback method)
-IPAddress findServerByBroadcast()
-{
-    const char *DISCOVERY_MSG = "DISCOVER-POWERPLANT";
-    const int DISCOVERY_PORT = 80;
-    const int LISTEN_PORT = 80;
-
-    Serial.println("[Server Discovery] Trying UDP broadcast discovery...");
-
-    if (!udp.begin(LISTEN_PORT))
-    {
-        Serial.println("[Server Discovery] Failed to start UDP");
-        return INADDR_NONE;
-    }
-
-    // Send broadcast
-    IPAddress broadcastIP = WiFi.localIP();
-    broadcastIP[3] = 255; // Assume /24 network
-
-    udp.beginPacket(broadcastIP, DISCOVERY_PORT);
-    udp.write((const uint8_t *)DISCOVERY_MSG, strlen(DISCOVERY_MSG));
-    udp.endPacket();
-
-    Serial.printf("[Server Discovery] Sent broadcast to %s:%d\n", broadcastIP.toString().c_str(), DISCOVERY_PORT);
-
-    // Wait for response
-    unsigned long startTime = millis();
-    while (millis() - startTime < 3000)
-    { // 3 second timeout
-        int packetSize = udp.parsePacket();
-        if (packetSize)
-        {
-            IPAddress serverIP = udp.remoteIP();
-            udp.stop();
-            Serial.printf("[Server Discovery] Server responded from %s\n", ("http://" + serverIP.toString()).c_str());
-            return serverIP;
-        }
-        delay(100);
-    }
-
-    udp.stop();
-    Serial.println("[Server Discovery] No UDP response received");
-    return INADDR_NONE;
+    ServerDiscovery discovery;
+    IPAddress ip;
+    fromCache = useCache && discovery.revalidateCached(DISCOVERY_CACHE_PROBE_MS, ip);
+    if (fromCache)
+        return ip;
+
+    discovery.addKnownMac(SERVER_MAC_1);
+    discovery.addKnownMac(SERVER_MAC_2);
+    for (uint8_t host : SERVER_PREFERRED_HOSTS)
+        discovery.addPreferredHost(host);
+    return discovery.run(DISCOVERY_TIMEOUT_MS).ip;
 }
 
 /* ------------------------------------------------------------------ */
@@ -251,12 +133,18 @@ std::vector<UartSlaveInfo> connectedSlaves; // struct defined in GameManager.h
 // Function prototypes
 void processUartData();
 void uartWriteFunction(const uint8_t *data, size_t len);
+void initScheduler();
 
 /* ------------------------------------------------------------------ */
 /*                    GLOBAL STATE & FORWARD DECLS                    */
 /* ------------------------------------------------------------------ */
-unsigned long lastUpdateTime = 0;
-unsigned long lastDebugTime = 0;
+Scheduler scheduler;
+LoopProfiler loopProfiler;
+BootPipeline bootPipeline;
+LiveTelemetry liveTelemetry;
+ServerEvents serverEvents;
+JournalUpload journalUpload;
+int8_t gameJobId = Scheduler::INVALID_JOB;
 
 /* ---------------- Hardware helper singletons --------------------- */
 PeripheralFactory factory;
@@ -273,9 +161,9 @@ SegmentDisplay *display1 = nullptr, *display2 = nullptr,
 // Double displays for totals
 SegmentDisplay *productionTotalDisplay = nullptr;
 SegmentDisplay *consumptionTotalDisplay = nullptr;
-Encoder *encoder1 = nullptr, *encoder2 = nullptr,
-        *encoder3 = nullptr, *encoder4 = nullptr,
-        *encoder5 = nullptr; // Newly added encoder
+EncoderInput *encoder1 = nullptr, *encoder2 = nullptr,
+             *encoder3 = nullptr, *encoder4 = nullptr,
+             *encoder5 = nullptr; // Newly added encoder
 
 MFRC522 mfrc522(NFC_SS_PIN, NFC_RST_PIN);
 NFCBuildingRegistry nfcRegistry(&mfrc522);
@@ -317,7 +205,7 @@ void printWiFiStatusCode(wl_status_t status)
 
 bool connectToWiFi()
 {
-    const int max_connection_attempts = 10;
+    const int max_connection_attempts = 100;   // 100 ms polls, 10 s per network
 
     WiFi.mode(WIFI_STA);
     WiFi.disconnect();
@@ -336,9 +224,11 @@ bool connectToWiFi()
         
         int attempts = 0;
         while (WiFi.status() != WL_CONNECTED && attempts < max_connection_attempts) {
-            delay(1000);
-            Serial.print(".");
+            delay(100);
             attempts++;
+            if (attempts % 10 != 0)
+                continue;
+            Serial.print(".");
 
             // Print connection status for critical failures
             switch (WiFi.status()) {
@@ -421,51 +311,48 @@ void processUartData()
             robustUart.resetRx(); // Ready for next frame
         }
     }
-
-    // Print stats periodically for debugging
-    static unsigned long lastStats = 0;
-    if (millis() - lastStats >= 10000)
-    { // Every 10 seconds
-        robustUart.printStats();
-        lastStats = millis();
-    }
 }
 
 /* ------------------------------------------------------------------ */
 /*                               SETUP                                */
 /* ------------------------------------------------------------------ */
 
+// Encoder on the first free PCNT unit, falling back to the interrupt-driven library encoder.
+// Pin order follows factory.createEncoder: the first pin leading counts up.
+EncoderInput *createEncoderInput(int pinA, int pinB)
+{
+#ifndef DISABLE_PCNT_ENCODERS
+    if (EncoderInput *pcnt = PcntEncoder::create(pinA, pinB, 0, 1000))
+        return pcnt;
+#endif
+    return new GpioEncoderInput(factory.createEncoder(pinA, pinB, ENCODER_NO_BUTTON, 0, 1000, 1));
+}
+
 void initPeripherals()
 {
     /* ---------- Peripherals ---------- */
-    // Create encoders with remapped physical positions; button disabled (255)
-    encoder1 = factory.createEncoder(ENCODER1_PIN_B, ENCODER1_PIN_A,
-                                     ENCODER_NO_BUTTON, 0, 1000, 1);
+    // Create encoders with remapped physical positions; button disabled (255).
+    // Encoders 1-4 are decoded by the PCNT units, encoder 5 uses GPIO interrupts.
+    encoder1 = createEncoderInput(ENCODER1_PIN_B, ENCODER1_PIN_A);
     Serial.println("[Peripherals] Encoder 1 (phys old 3) created");
-    encoder2 = factory.createEncoder(ENCODER2_PIN_B, ENCODER2_PIN_A,
-                                     ENCODER_NO_BUTTON, 0, 1000, 1);
-    encoder3 = factory.createEncoder(ENCODER3_PIN_B, ENCODER3_PIN_A,
-                                     ENCODER_NO_BUTTON, 0, 1000, 1);
+    encoder2 = createEncoderInput(ENCODER2_PIN_B, ENCODER2_PIN_A);
+    encoder3 = createEncoderInput(ENCODER3_PIN_B, ENCODER3_PIN_A);
     
     // Encoder 4 - direction configurable for specific boards
 #ifdef REVERSE_ENCODER4_DIRECTION
-    encoder4 = factory.createEncoder(ENCODER4_PIN_A, ENCODER4_PIN_B,
-                                     ENCODER_NO_BUTTON, 0, 1000, 1);
+    encoder4 = createEncoderInput(ENCODER4_PIN_A, ENCODER4_PIN_B);
     Serial.println("[Peripherals] Encoder 4 (phys old 2) created - REVERSED DIRECTION");
 #else
-    encoder4 = factory.createEncoder(ENCODER4_PIN_B, ENCODER4_PIN_A,
-                                     ENCODER_NO_BUTTON, 0, 1000, 1);
+    encoder4 = createEncoderInput(ENCODER4_PIN_B, ENCODER4_PIN_A);
     Serial.println("[Peripherals] Encoder 4 (phys old 2) created");
 #endif
 
     // Encoder 5 - direction configurable for specific boards
 #ifdef REVERSE_ENCODER5_DIRECTION
-    encoder5 = factory.createEncoder(ENCODER5_PIN_A, ENCODER5_PIN_B,
-                                     ENCODER_NO_BUTTON, 0, 1000, 1);
+    encoder5 = createEncoderInput(ENCODER5_PIN_A, ENCODER5_PIN_B);
     Serial.println("[Peripherals] Encoder 5 (new) created - REVERSED DIRECTION");
 #else
-    encoder5 = factory.createEncoder(ENCODER5_PIN_B, ENCODER5_PIN_A,
-                                     ENCODER_NO_BUTTON, 0, 1000, 1);
+    encoder5 = createEncoderInput(ENCODER5_PIN_B, ENCODER5_PIN_A);
     Serial.println("[Peripherals] Encoder 5 (new) created");
 #endif
 
@@ -550,14 +437,82 @@ void initDisplayTimer()
 }
 
 
-void setup()
+/* ---------------------------- Boot stages ------------------------- */
+// Stage tasks only need to outlive setup; they delete themselves when done
+static const uint32_t NFC_STAGE_STACK = 4096;
+static const uint32_t WIFI_STAGE_STACK = 4096;
+static const uint32_t SERVER_STAGE_STACK = 8192;   // login / register run TLS on this task
+
+bool peripheralsStage()
 {
-    Serial.begin(115200);
-    Serial.println("\nMaster Board ESP32-S3 booting…");
     pinMode(BUZZER_PIN, OUTPUT);
     digitalWrite(BUZZER_PIN, LOW);
     initPeripherals();
+    return true;
+}
+
+bool warmStartStage()
+{
+    // Last-known ranges, coefficients, buildings and inventory from NVS (before WiFi)
+    GameManager::getInstance().restoreWarmStart();
+    return true;
+}
 
+bool displayStage()
+{
+    GameManager::updateDisplays(); // restored values (or zeros) while WiFi / server come up
+    factory.update();
+    initDisplayTimer();
+    return true;
+}
+
+bool uartStage()
+{
+    initUartCommunication();
+    Serial.printf("[COM-PROT] Master (via retranslation) UART on RX=%d, TX=%d\n", UART_RX_PIN, UART_TX_PIN);
+    return true;
+}
+
+// Reader init and self-test only; the registry is attached on the loop task (nfcScanJob)
+bool nfcStage()
+{
+    Serial.println("\n🔧 Testing NFC hardware...");
+    SPI.begin(NFC_SCK_PIN, NFC_MISO_PIN, NFC_MOSI_PIN, NFC_SS_PIN);
+    mfrc522.PCD_Init();
+    Serial.printf("[NFC] Using pins: SCK=%d, MISO=%d, MOSI=%d, SS=%d, RST=%d\n",
+                  NFC_SCK_PIN, NFC_MISO_PIN, NFC_MOSI_PIN, NFC_SS_PIN, NFC_RST_PIN);
+
+    // Test NFC chip communication
+    Serial.print("[NFC] Testing MFRC522 communication... ");
+    mfrc522.PCD_DumpVersionToSerial();
+    
+    // Check if MFRC522 is responding by reading version register
+    byte version = mfrc522.PCD_ReadRegister(mfrc522.VersionReg);
+    if (version == 0x00 || version == 0xFF) {
+        Serial.println("❌ [NFC] MFRC522 test FAILED - No response from chip!");
+        Serial.printf("[NFC] Version register: 0x%02X (expected: 0x90-0x92)\n", version);
+        
+        // Error buzzer: 3 short beeps
+        for (int i = 0; i < 3; i++) {
+            digitalWrite(BUZZER_PIN, HIGH); delay(100); 
+            digitalWrite(BUZZER_PIN, LOW); delay(100);
+        }
+    } else {
+        Serial.println("✅ [NFC] MFRC522 test PASSED - Chip responding correctly!");
+        Serial.printf("[NFC] Version register: 0x%02X\n", version);
+        
+        // Success buzzer: 2 rising tone beeps
+        digitalWrite(BUZZER_PIN, HIGH); delay(80); 
+        digitalWrite(BUZZER_PIN, LOW); delay(50);
+        digitalWrite(BUZZER_PIN, HIGH); delay(120); 
+        digitalWrite(BUZZER_PIN, LOW);
+    }
+
+    return version != 0x00 && version != 0xFF;
+}
+
+bool wifiStage()
+{
     // WiFi connection with fallback and reboot
     if (!connectToWiFi()) {
         Serial.println("💀 CRITICAL: No WiFi networks available!");
@@ -565,16 +520,33 @@ void setup()
         delay(5000);
         esp_restart();
     }
+    return true;
+}
+
+// Logged-in ESP-API instance from the server stage, published to GameManager by espApiJob
+// once the stage is done (the STAGE_SERVER bit orders these writes before that read)
+static ESPGameAPI *stagedEspApi = nullptr;
+static char stagedServerUrl[96] = "";
+
+static bool connectServer(const char *serverUrl, const char *boardName, const char *username, const char *password)
+{
+    stagedEspApi = GameManager::connectEspApi(serverUrl, boardName, username, password);
+    if (!stagedEspApi) return false;
+    strncpy(stagedServerUrl, serverUrl, sizeof(stagedServerUrl) - 1);
+    stagedServerUrl[sizeof(stagedServerUrl) - 1] = '\0';
+    return true;
+}
 
+bool serverStage()
+{
     // Server discovery and authentication
     bool serverConnected = false;
-    auto &gameManager = GameManager::getInstance();
     
 #ifdef PRODUCTION_SERVER_URL
     // Production mode: directly use fixed server URL, no discovery.
     Serial.println("\n🌐 Production mode: using fixed server URL");
     const char *serverUrl = PRODUCTION_SERVER_URL;
-    serverConnected = gameManager.initEspApi(serverUrl, BOARD_NAME, API_USERNAME, API_PASSWORD);
+    serverConnected = connectServer(serverUrl, BOARD_NAME, API_USERNAME, API_PASSWORD);
     if (serverConnected) {
         Serial.printf("[ESP-API] ✅ Successfully connected to %s\n", serverUrl);
     } else {
@@ -582,15 +554,23 @@ void setup()
     }
 #else
     Serial.println("\n🔍 Discovering server...");
-    IPAddress serverIp = findHttpServer();
-    if (!serverIp) {
-        Serial.println("[Server Discovery] MAC discovery failed, trying UDP broadcast discovery...");
-        serverIp = findServerByBroadcast();
+    bool fromCache = false;
+    IPAddress serverIp = discoverServer(true, fromCache);
+    if (serverIp && fromCache) {
+        serverConnected = connectServer(("http://" + serverIp.toString()).c_str(), API_USERNAME, API_PASSWORD, SERVER_PASSWORD);
+        if (!serverConnected) {
+            // Something else answers on the old address now; never trust it again blindly
+            Serial.println("[ESP-API] ❌ Remembered server failed authentication, searching the network…");
+            ServerDiscovery::forgetServer();
+            serverIp = discoverServer(false, fromCache);
+        }
     }
-    if (serverIp) {
+    if (serverConnected) {
+        Serial.println("[ESP-API] ✅ Remembered server connection and authentication successful");
+    } else if (serverIp) {
         Serial.printf("🎯 Server discovered at: %s\n", serverIp.toString().c_str());
         Serial.println("[ESP-API] Initializing via GameManager…");
-        serverConnected = gameManager.initEspApi(("http://" + serverIp.toString()).c_str(), API_USERNAME, API_PASSWORD, SERVER_PASSWORD);
+        serverConnected = connectServer(("http://" + serverIp.toString()).c_str(), API_USERNAME, API_PASSWORD, SERVER_PASSWORD);
         if (serverConnected) {
             Serial.println("[ESP-API] ✅ Server connection and authentication successful");
         } else {
@@ -599,13 +579,15 @@ void setup()
     } else {
         Serial.println("⚠️  Server not found on local network");
         Serial.println("[ESP-API] Using fallback server URL from config…");
-        serverConnected = gameManager.initEspApi("http://192.168.50.201", BOARD_NAME, SERVER_USERNAME, SERVER_PASSWORD);
+        serverConnected = connectServer("http://192.168.50.201", BOARD_NAME, SERVER_USERNAME, SERVER_PASSWORD);
         if (serverConnected) {
             Serial.println("[ESP-API] ✅ Fallback server connection successful");
         } else {
             Serial.println("[ESP-API] ❌ Fallback server authentication failed");
         }
     }
+    if (serverConnected && serverIp)
+        ServerDiscovery::rememberServer(serverIp);
 #endif
 
     // Check if server authentication failed and reboot
@@ -616,127 +598,210 @@ void setup()
         esp_restart();
     }
 
-    // ---------- UART Communication Initialization ----------
-    initUartCommunication();
-
-    // ---------- NFC Testing & Initialization ----------
-    Serial.println("\n🔧 Testing NFC hardware...");
-    SPI.begin(NFC_SCK_PIN, NFC_MISO_PIN, NFC_MOSI_PIN, NFC_SS_PIN);
-    mfrc522.PCD_Init();
-    Serial.printf("[NFC] Using pins: SCK=%d, MISO=%d, MOSI=%d, SS=%d, RST=%d\n",
-                  NFC_SCK_PIN, NFC_MISO_PIN, NFC_MOSI_PIN, NFC_SS_PIN, NFC_RST_PIN);
-
-    // Test NFC chip communication
-    Serial.print("[NFC] Testing MFRC522 communication... ");
-    mfrc522.PCD_DumpVersionToSerial();
-    
-    // Check if MFRC522 is responding by reading version register
-    byte version = mfrc522.PCD_ReadRegister(mfrc522.VersionReg);
-    if (version == 0x00 || version == 0xFF) {
-        Serial.println("❌ [NFC] MFRC522 test FAILED - No response from chip!");
-        Serial.printf("[NFC] Version register: 0x%02X (expected: 0x90-0x92)\n", version);
-        
-        // Error buzzer: 3 short beeps
-        for (int i = 0; i < 3; i++) {
-            digitalWrite(BUZZER_PIN, HIGH); delay(100); 
-            digitalWrite(BUZZER_PIN, LOW); delay(100);
-        }
-    } else {
-        Serial.println("✅ [NFC] MFRC522 test PASSED - Chip responding correctly!");
-        Serial.printf("[NFC] Version register: 0x%02X\n", version);
-        
-        // Success buzzer: 2 rising tone beeps
-        digitalWrite(BUZZER_PIN, HIGH); delay(80); 
-        digitalWrite(BUZZER_PIN, LOW); delay(50);
-        digitalWrite(BUZZER_PIN, HIGH); delay(120); 
-        digitalWrite(BUZZER_PIN, LOW);
-    }
+#ifdef PRODUCTION_SERVER_URL
+    // In production mode: do NOT restart just because the game is not active yet.
+    // A 404 or inactive game state simply means we wait until the server starts a game.
+    // Restarting is only appropriate if WiFi/server were unreachable (handled earlier).
+    Serial.println("[ESP-API][INFO] Logged in, game state follows from the server… (no restart)");
+#endif
+    return true;
+}
 
+void attachNfcRegistry()
+{
+    auto &gameManager = GameManager::getInstance();
     gameManager.initNfcRegistry(&nfcRegistry);
 
     // Immediate buzzer feedback on building add / delete
     nfcRegistry.setOnNewBuildingCallback([](uint8_t buildingType, const String &uid){
         Serial.printf("[NFC] New building type=%u uid=%s\n", buildingType, uid.c_str());
+        GameManager::getInstance().onBuildingAdded(buildingType, uid);
         // Short beep: 2 quick pulses for clarity
         digitalWrite(BUZZER_PIN, HIGH); delay(30); digitalWrite(BUZZER_PIN, LOW); delay(40);
         digitalWrite(BUZZER_PIN, HIGH); delay(30); digitalWrite(BUZZER_PIN, LOW);
     });
     nfcRegistry.setOnDeleteBuildingCallback([](uint8_t buildingType, const String &uid){
         Serial.printf("[NFC] Building removed type=%u uid=%s\n", buildingType, uid.c_str());
+        GameManager::getInstance().onBuildingRemoved(buildingType, uid);
         // Longer descending style (two spaced pulses)
         digitalWrite(BUZZER_PIN, HIGH); delay(60); digitalWrite(BUZZER_PIN, LOW); delay(120);
         digitalWrite(BUZZER_PIN, HIGH); delay(40); digitalWrite(BUZZER_PIN, LOW);
     });
+}
 
-    Serial.printf("[COM-PROT] Master (via retranslation) UART on RX=%d, TX=%d\n", UART_RX_PIN, UART_TX_PIN);
-    Serial.println("Setup done ✓");
-#ifdef PRODUCTION_SERVER_URL
-    // In production mode: do NOT restart just because the game is not active yet.
-    // A 404 or inactive game state simply means we wait until the server starts a game.
-    // Restarting is only appropriate if WiFi/server were unreachable (handled earlier).
-    if (!GameManager::getInstance().isGameActive()) {
-        Serial.println("[ESP-API][INFO] Game not active after init. Waiting for game start… (no restart)");
-    }
-#endif
-    initDisplayTimer();
+void setup()
+{
+    Serial.begin(115200);
+    Serial.println("\nMaster Board ESP32-S3 booting…");
+    bootPipeline.begin();
+
+    // Local hardware first: the board shows its last state and serves the retranslation
+    // station while WiFi / login and the NFC self-test run on their own tasks
+    bootPipeline.run(BootPipeline::STAGE_PERIPHERALS, peripheralsStage);
+    bootPipeline.run(BootPipeline::STAGE_WARM_START, warmStartStage);
+    bootPipeline.run(BootPipeline::STAGE_DISPLAY, displayStage);
+    bootPipeline.run(BootPipeline::STAGE_UART, uartStage);
+    bootPipeline.start(BootPipeline::STAGE_NFC, nfcStage, 0, NFC_STAGE_STACK);
+    bootPipeline.start(BootPipeline::STAGE_WIFI, wifiStage, 0, WIFI_STAGE_STACK);
+    bootPipeline.start(BootPipeline::STAGE_SERVER, serverStage, BootPipeline::bit(BootPipeline::STAGE_WIFI),
+                       SERVER_STAGE_STACK);
+
+    initScheduler();
+    Serial.println("Setup done ✓ (WiFi, server and NFC continue in the background)");
     //xTaskCreatePinnedToCore(displayTask, "DisplayTask", 2048, NULL, 1, &ioTaskHandle, 1);
 }
 
 /* ------------------------------------------------------------------ */
 /*                                LOOP                                */
 /* ------------------------------------------------------------------ */
-unsigned long last_update_time = 0;
-void loop()
+void espApiJob()
 {
-    // Update ESP API if connected
+    if (!bootPipeline.isDone(BootPipeline::STAGE_SERVER))
+        return;
+    auto &gameManager = GameManager::getInstance();
+    if (stagedEspApi)
+    {
+        // Publish the instance the server stage logged in; only this task uses it from here on
+        gameManager.adoptEspApi(stagedEspApi, stagedServerUrl);
+        stagedEspApi = nullptr;
+        // Pushed invalidations from here on; polling stays as the fallback
+        serverEvents.begin(gameManager.getServerUrl());
+        // Telemetry journaled during outages goes out next to the live uploads
+        journalUpload.begin(gameManager.getServerUrl(), [](JournalUpload &upload, unsigned long now) {
+            return GameManager::getInstance().replayJournal(upload, now);
+        });
+    }
+
+    // Update ESP API while WiFi is up
     if (WiFi.status() == WL_CONNECTED)
     {
-        GameManager::getInstance().updateEspApi();
+        gameManager.onServerPush(serverEvents.takeInvalidations(), serverEvents.isSubscribed());
+        gameManager.updateEspApi();
     }
+    else
+    {
+        gameManager.onWifiDown(millis());
+    }
+}
 
+void gameJob()
+{
     GameManager::getInstance().update(); // update game logic
-
-    // UART Communication processing (receive slave info)
-    processUartData();
-    
     // Update retranslation station status (handled inside display update too, but keep here for timely state)
     GameManager::getInstance().updateRetranslationStatus();
-    if(millis() - last_update_time > 30) {
-                GameManager::updateDisplays();
+}
+
+void nfcScanJob()
+{
+    static bool registryAttached = false;
+    if (!registryAttached)
+    {
+        if (!bootPipeline.isDone(BootPipeline::STAGE_NFC))
+            return;
+        attachNfcRegistry();
+        registryAttached = true;
+    }
+    if (nfcRegistry.scanForCards())
+    {
+        Serial.println("📱 [NFC] Card detected and processed!");
+    }
+}
+
+void debugJob()
+{
+    nfcRegistry.printDatabase(); // Print NFC registry info
+
+    GameManager::printDebugInfo();
+
+    // Print retranslation status
+    static bool lastRetranslationStatus = true;
+    bool currentStatus = GameManager::getInstance().isRetranslationStationAlive();
+    if (lastRetranslationStatus != currentStatus) {
+        Serial.printf("[RETRANSLATION] Status changed: %s\n", 
+                     currentStatus ? "CONNECTED" : "DISCONNECTED");
+        lastRetranslationStatus = currentStatus;
     }
+}
 
-    if (millis() - lastDebugTime >= POWER_PLANT_DEBUG_INTERVAL)
+void liveTelemetryJob()
+{
+    const unsigned long now = millis();
+    if (!liveTelemetry.isRunning())
     {
-        lastDebugTime = millis();
-        static unsigned long lastNfcScan = 0;
-        if (millis() - lastNfcScan >= 100)
-        { // Scan every 100ms
-            bool cardFound = nfcRegistry.scanForCards();
-            if (cardFound)
-            {
-                Serial.println("📱 [NFC] Card detected and processed!");
-            }
-            lastNfcScan = millis();
-        }
-        nfcRegistry.printDatabase(); // Print NFC registry info
+        // The endpoint comes up with the first WiFi connection and stays for good
+        if (bootPipeline.isDone(BootPipeline::STAGE_WIFI) && WiFi.status() == WL_CONNECTED)
+            liveTelemetry.begin();
+        return;
+    }
+    if (!liveTelemetry.wantsFrame(now))
+        return;
+
+    TelemetrySnapshot snapshot;
+    if (WiFi.status() == WL_CONNECTED)
+    {
+        snapshot.fields[TelemetrySnapshot::FIELD_LINK_FLAGS] = TelemetrySnapshot::LINK_WIFI;
+        snapshot.fields[TelemetrySnapshot::FIELD_WIFI_RSSI] = WiFi.RSSI();
+    }
+    GameManager::getInstance().fillLiveTelemetry(snapshot, now);
+
+    uint32_t missed = 0;
+    for (uint8_t id = 0; id < scheduler.getJobCount(); id++)
+        missed += scheduler.getStats(id).missed;
+    snapshot.fields[TelemetrySnapshot::FIELD_MISSED_PERIODS] = static_cast<int32_t>(missed);
+    if (gameJobId != Scheduler::INVALID_JOB)
+        snapshot.fields[TelemetrySnapshot::FIELD_GAME_RUN_US] = static_cast<int32_t>(scheduler.getStats(gameJobId).lastRunUs);
 
-        GameManager::printDebugInfo();
+    liveTelemetry.publish(snapshot, now);
+}
 
-        // Print coefficient debug info every 10 seconds
-        static unsigned long lastCoefficientDebug = 0;
-        if (millis() - lastCoefficientDebug >= 10000)
+// Single-key serial commands: p = loop profile, r = reset the profile
+void consoleJob()
+{
+    while (Serial.available())
+    {
+        switch (Serial.read())
         {
-            GameManager::printCoefficientDebugInfo();
-            lastCoefficientDebug = millis();
-        }
-        
-        // Print retranslation status
-        static bool lastRetranslationStatus = true;
-    bool currentStatus = GameManager::getInstance().isRetranslationStationAlive();
-        if (lastRetranslationStatus != currentStatus) {
-            Serial.printf("[RETRANSLATION] Status changed: %s\n", 
-                         currentStatus ? "CONNECTED" : "DISCONNECTED");
-            lastRetranslationStatus = currentStatus;
+        case 'p': loopProfiler.print(); break;
+        case 'r': loopProfiler.reset(); Serial.println("[PROFILE] Reset"); break;
+        case 'n':
+            GameManager::getInstance().getRequestStats().print();
+            liveTelemetry.print();
+            serverEvents.print();
+            journalUpload.print();
+            break;
+        default: break;
         }
     }
 }
+
+void initScheduler()
+{
+    unsigned long now = millis();
+    scheduler.setProfiler(&loopProfiler);
+    scheduler.add("uart", UART_POLL_INTERVAL_MS, Scheduler::PRIORITY_HIGH, processUartData, now);
+    gameJobId = scheduler.add("game", GAME_UPDATE_INTERVAL_MS, Scheduler::PRIORITY_HIGH, gameJob, now);
+    scheduler.add("esp-api", ESP_API_UPDATE_INTERVAL_MS, Scheduler::PRIORITY_NORMAL, espApiJob, now);
+    scheduler.add("display", DISPLAY_UPDATE_INTERVAL_MS, Scheduler::PRIORITY_NORMAL,
+                  []() { GameManager::updateDisplays(); }, now);
+    scheduler.add("blink", DISPLAY_BLINK_INTERVAL_MS, Scheduler::PRIORITY_NORMAL,
+                  []() { GameManager::getInstance().toggleDisplayBlink(); }, now);
+    scheduler.add("nfc", NFC_SCAN_INTERVAL_MS, Scheduler::PRIORITY_NORMAL, nfcScanJob, now);
+    scheduler.add("debug", POWER_PLANT_DEBUG_INTERVAL, Scheduler::PRIORITY_LOW, debugJob, now);
+    scheduler.add("power-log", POWER_TRACE_INTERVAL_MS, Scheduler::PRIORITY_LOW,
+                  []() { GameManager::getInstance().requestPowerTrace(); }, now);
+    scheduler.add("coef-dbg", COEFFICIENT_DEBUG_INTERVAL_MS, Scheduler::PRIORITY_LOW,
+                  []() { GameManager::printCoefficientDebugInfo(); }, now, COEFFICIENT_DEBUG_INTERVAL_MS);
+    scheduler.add("uart-stat", UART_STATS_INTERVAL_MS, Scheduler::PRIORITY_LOW,
+                  []() { robustUart.printStats(); }, now, UART_STATS_INTERVAL_MS);
+    scheduler.add("console", CONSOLE_POLL_INTERVAL_MS, Scheduler::PRIORITY_LOW, consoleJob, now);
+    scheduler.add("live", LIVE_TELEMETRY_TICK_MS, Scheduler::PRIORITY_LOW, liveTelemetryJob, now);
+    scheduler.add("sched", SCHEDULER_STATS_INTERVAL_MS, Scheduler::PRIORITY_LOW,
+                  []() { scheduler.printStats(); }, now, SCHEDULER_STATS_INTERVAL_MS);
+}
+
+void loop()
+{
+    // Run whatever is due, then sleep until the next deadline instead of spinning
+    scheduler.runDue(millis());
+    scheduler.sleepUntilNext(millis());
+}
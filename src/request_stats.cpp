@@ -0,0 +1,146 @@
+#include "request_stats.h"
+#include <Arduino.h>
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+static bool containsNoCase(const char* text, const char* word) {
+    const size_t wordLen = strlen(word);
+    for (; *text; text++) {
+        size_t i = 0;
+        while (i < wordLen && text[i] && tolower((unsigned char)text[i]) == word[i]) i++;
+        if (i == wordLen) return true;
+    }
+    return false;
+}
+
+// First three-digit number in 400..599 in the error text (e.g. "HTTP error: 503")
+static uint16_t findHttpStatus(const char* error) {
+    for (const char* p = error; *p; p++) {
+        if (!isdigit((unsigned char)*p) || (p > error && isdigit((unsigned char)p[-1]))) continue;
+        char* end = nullptr;
+        const long value = strtol(p, &end, 10);
+        if (end - p == 3 && value >= 400 && value <= 599) return static_cast<uint16_t>(value);
+    }
+    return 0;
+}
+
+RequestStats::Failure RequestStats::classify(const char* error) {
+    if (!error || !*error) return FAIL_OTHER;
+    // Order matters: "TLS handshake timeout" is a TLS problem, "connection timeout" a timeout
+    if (containsNoCase(error, "ssl") || containsNoCase(error, "tls") || containsNoCase(error, "certificate") ||
+        containsNoCase(error, "handshake")) return FAIL_TLS;
+    if (containsNoCase(error, "timeout") || containsNoCase(error, "timed out")) return FAIL_TIMEOUT;
+    if (containsNoCase(error, "json") || containsNoCase(error, "parse") || containsNoCase(error, "deserial"))
+        return FAIL_PARSE;
+    if (findHttpStatus(error)) return FAIL_HTTP_STATUS;
+    if (containsNoCase(error, "connect") || containsNoCase(error, "dns") || containsNoCase(error, "resolve") ||
+        containsNoCase(error, "host") || containsNoCase(error, "refused")) return FAIL_CONNECT;
+    if (containsNoCase(error, "http") || containsNoCase(error, "status")) return FAIL_HTTP_STATUS;
+    return FAIL_OTHER;
+}
+
+const char* RequestStats::endpointName(Endpoint endpoint) {
+    switch (endpoint) {
+        case ENDPOINT_RANGES: return "ranges";
+        case ENDPOINT_COEFFICIENTS: return "coefficients";
+        case ENDPOINT_STATUS: return "status";
+        default: return "?";
+    }
+}
+
+const char* RequestStats::failureName(Failure failure) {
+    static const char* const names[FAIL_COUNT] = { "timeout", "connect", "tls", "http", "parse", "lost", "other" };
+    return failure < FAIL_COUNT ? names[failure] : "?";
+}
+
+void RequestStats::begin(Endpoint endpoint, unsigned long now) {
+    EndpointStats& s = stats[endpoint];
+    s.sent++;
+    s.startedAt = now;
+}
+
+void RequestStats::complete(Endpoint endpoint, unsigned long now, bool success, const char* error) {
+    EndpointStats& s = stats[endpoint];
+    const uint32_t elapsed = static_cast<uint32_t>(now - s.startedAt);
+    s.lastMs = elapsed;
+    if (success) {
+        s.succeeded++;
+        s.successMs.record(elapsed);
+        return;
+    }
+    const Failure failure = classify(error);
+    if (failure == FAIL_HTTP_STATUS) {
+        const uint16_t status = findHttpStatus(error);
+        if (status) s.lastHttpStatus = status;
+    }
+    fail(endpoint, failure, elapsed, error);
+}
+
+void RequestStats::lost(Endpoint endpoint, unsigned long now) {
+    fail(endpoint, FAIL_LOST, static_cast<uint32_t>(now - stats[endpoint].startedAt), "no response");
+}
+
+void RequestStats::fail(Endpoint endpoint, Failure failure, uint32_t elapsedMs, const char* error) {
+    EndpointStats& s = stats[endpoint];
+    s.failures[failure]++;
+    s.failureMs.record(elapsedMs);
+    strncpy(s.lastError, error ? error : "", MAX_ERROR_TEXT - 1);
+    s.lastError[MAX_ERROR_TEXT - 1] = '\0';
+}
+
+void RequestStats::reset() {
+    for (uint8_t e = 0; e < ENDPOINT_COUNT; e++) {
+        EndpointStats& s = stats[e];
+        s.successMs.reset();
+        s.failureMs.reset();
+        s.sent = 0;
+        s.succeeded = 0;
+        memset(s.failures, 0, sizeof(s.failures));
+        s.lastHttpStatus = 0;
+        s.lastMs = 0;
+        s.startedAt = 0;
+        s.lastError[0] = '\0';
+    }
+}
+
+void RequestStats::print() const {
+    Serial.println("[NET] endpoint      sent    ok  | ok ms min/avg/p50/p99/max | fail ms avg/max");
+    for (uint8_t e = 0; e < ENDPOINT_COUNT; e++) {
+        const EndpointStats& s = stats[e];
+        Serial.printf("  %-12s %5lu %5lu  | %lu/%lu/%lu/%lu/%lu | %lu/%lu\n", endpointName(static_cast<Endpoint>(e)),
+                      (unsigned long)s.sent, (unsigned long)s.succeeded,
+                      (unsigned long)s.successMs.getMin(), (unsigned long)s.successMs.getAverage(),
+                      (unsigned long)s.successMs.percentile(50), (unsigned long)s.successMs.percentile(99),
+                      (unsigned long)s.successMs.getMax(),
+                      (unsigned long)s.failureMs.getAverage(), (unsigned long)s.failureMs.getMax());
+        if (s.failureMs.getCount() == 0) continue;
+        Serial.print("    failures:");
+        for (uint8_t f = 0; f < FAIL_COUNT; f++) {
+            if (s.failures[f]) Serial.printf(" %s=%lu", failureName(static_cast<Failure>(f)), (unsigned long)s.failures[f]);
+        }
+        if (s.lastHttpStatus) Serial.printf(" (last status %u)", s.lastHttpStatus);
+        Serial.printf(", last: %s\n", s.lastError);
+    }
+}
+
+uint32_t RequestStats::getFailureTotal() const {
+    uint32_t total = 0;
+    for (uint8_t e = 0; e < ENDPOINT_COUNT; e++) {
+        for (uint8_t f = 0; f < FAIL_COUNT; f++) total += stats[e].failures[f];
+    }
+    return total;
+}
+
+void RequestStats::printSummary() const {
+    Serial.print("[NET]");
+    for (uint8_t e = 0; e < ENDPOINT_COUNT; e++) {
+        const EndpointStats& s = stats[e];
+        if (s.sent == 0) continue;
+        Serial.printf(" %s %lu/%lu ok p50/p99 %lu/%lu ms |", endpointName(static_cast<Endpoint>(e)),
+                      (unsigned long)s.succeeded, (unsigned long)s.sent,
+                      (unsigned long)getSuccessPercentile(static_cast<Endpoint>(e), 50),
+                      (unsigned long)getSuccessPercentile(static_cast<Endpoint>(e), 99));
+    }
+    Serial.printf(" failures %lu\n", (unsigned long)getFailureTotal());
+}
@@ -0,0 +1,152 @@
+#include "scheduler.h"
+#include <Arduino.h>
+#include <string.h>
+
+Scheduler::Scheduler()
+    : jobCount(0), cursor(0), earliest(0), sleeps(0), sleptMs(0), profiler(nullptr) {
+    memset(jobs, 0, sizeof(jobs));
+    for (uint8_t i = 0; i < WHEEL_SLOTS; i++) slots[i] = INVALID_JOB;
+}
+
+int8_t Scheduler::add(const char* name, uint32_t periodMs, Priority priority, JobFn fn,
+                      unsigned long now, uint32_t firstDelayMs) {
+    if (jobCount >= MAX_JOBS || !fn || periodMs == 0) return INVALID_JOB;
+    if (jobCount == 0) cursor = now;
+
+    const int8_t id = static_cast<int8_t>(jobCount++);
+    Job& job = jobs[id];
+    job.fn = fn;
+    job.deadline = now + firstDelayMs;
+    job.stats.name = name;
+    job.stats.periodMs = periodMs;
+    job.stats.priority = priority;
+    if (profiler) profiler->setStageName(id, name);
+    insert(id);
+    refreshEarliest();
+    return id;
+}
+
+void Scheduler::setProfiler(LoopProfiler* loopProfiler) {
+    profiler = loopProfiler;
+    if (!profiler) return;
+    for (uint8_t i = 0; i < jobCount; i++) profiler->setStageName(i, jobs[i].stats.name);
+}
+
+void Scheduler::insert(int8_t id) {
+    const uint8_t slot = jobs[id].deadline & (WHEEL_SLOTS - 1);
+    jobs[id].next = slots[slot];
+    slots[slot] = id;
+}
+
+void Scheduler::unlink(int8_t id) {
+    int8_t* link = &slots[jobs[id].deadline & (WHEEL_SLOTS - 1)];
+    while (*link != INVALID_JOB) {
+        if (*link == id) {
+            *link = jobs[id].next;
+            return;
+        }
+        link = &jobs[*link].next;
+    }
+}
+
+void Scheduler::refreshEarliest() {
+    if (jobCount == 0) return;
+    earliest = jobs[0].deadline;
+    for (uint8_t i = 1; i < jobCount; i++) {
+        if (static_cast<long>(jobs[i].deadline - earliest) < 0) earliest = jobs[i].deadline;
+    }
+}
+
+uint8_t Scheduler::runDue(unsigned long now) {
+    if (jobCount == 0 || !reached(earliest, now)) return 0;
+
+    // Collect due jobs from the slots the clock passed (the whole wheel after a long stall).
+    // The cursor tick itself is looked at again: a job may have been added for it.
+    int8_t due[MAX_JOBS];
+    uint8_t dueCount = 0;
+    unsigned long ticks = now - cursor + 1;
+    if (ticks > WHEEL_SLOTS) ticks = WHEEL_SLOTS;
+    for (unsigned long t = 0; t < ticks; t++) {
+        int8_t id = slots[(cursor + t) & (WHEEL_SLOTS - 1)];
+        while (id != INVALID_JOB) {
+            const int8_t next = jobs[id].next;
+            if (reached(jobs[id].deadline, now)) {
+                unlink(id);
+                due[dueCount++] = id;
+            }
+            id = next;
+        }
+    }
+    cursor = now;
+
+    // Highest priority first, then earliest deadline (insertion sort, a handful of jobs)
+    for (uint8_t i = 1; i < dueCount; i++) {
+        const int8_t id = due[i];
+        uint8_t j = i;
+        while (j > 0) {
+            const Job& prev = jobs[due[j - 1]];
+            const bool before = jobs[id].stats.priority > prev.stats.priority ||
+                (jobs[id].stats.priority == prev.stats.priority &&
+                 static_cast<long>(jobs[id].deadline - prev.deadline) < 0);
+            if (!before) break;
+            due[j] = due[j - 1];
+            j--;
+        }
+        due[j] = id;
+    }
+
+    if (profiler) profiler->beginIteration();
+    for (uint8_t i = 0; i < dueCount; i++) {
+        Job& job = jobs[due[i]];
+        JobStats& stats = job.stats;
+
+        const uint32_t late = static_cast<uint32_t>(now - job.deadline);
+        if (late > stats.maxLateMs) stats.maxLateMs = late;
+
+        const uint32_t start = micros();
+        const uint32_t startCycles = LoopProfiler::cycles();
+        job.fn();
+        const uint32_t elapsed = micros() - start;
+        if (profiler) profiler->record(due[i], LoopProfiler::cycles() - startCycles);
+        stats.runs++;
+        stats.lastRunUs = elapsed;
+        stats.totalRunUs += elapsed;
+        if (elapsed > stats.maxRunUs) stats.maxRunUs = elapsed;
+
+        // Next deadline on the original phase; whole periods already gone are skipped
+        const uint32_t skipped = late / stats.periodMs;
+        stats.missed += skipped;
+        job.deadline += (skipped + 1) * stats.periodMs;
+        insert(due[i]);
+    }
+    if (profiler) profiler->endIteration();
+
+    refreshEarliest();
+    return dueCount;
+}
+
+uint32_t Scheduler::msUntilNext(unsigned long now) const {
+    if (jobCount == 0 || reached(earliest, now)) return 0;
+    return static_cast<uint32_t>(earliest - now);
+}
+
+void Scheduler::sleepUntilNext(unsigned long now, uint32_t maxSleepMs) {
+    uint32_t wait = msUntilNext(now);
+    if (wait > maxSleepMs) wait = maxSleepMs;
+    if (wait == 0) return;
+    sleeps++;
+    sleptMs += wait;
+    vTaskDelay(pdMS_TO_TICKS(wait));
+}
+
+void Scheduler::printStats() const {
+    Serial.printf("[SCHED] %u jobs, slept %lu times (%lu ms total)\n", jobCount,
+                  (unsigned long)sleeps, (unsigned long)sleptMs);
+    for (uint8_t i = 0; i < jobCount; i++) {
+        const JobStats& s = jobs[i].stats;
+        Serial.printf("  %-10s %5lu ms p%u runs:%lu missed:%lu late<=%lu ms run avg:%lu max:%lu us\n",
+                      s.name, (unsigned long)s.periodMs, s.priority, (unsigned long)s.runs,
+                      (unsigned long)s.missed, (unsigned long)s.maxLateMs,
+                      (unsigned long)(s.runs ? s.totalRunUs / s.runs : 0), (unsigned long)s.maxRunUs);
+    }
+}
@@ -0,0 +1,384 @@
+#include "server_discovery.h"
+#include "board_config.h"
+#include "discovery_reply.h"
+#include <WiFi.h>
+#include <WiFiClient.h>
+#include <Preferences.h>
+#include <lwip/sockets.h>
+#include <lwip/etharp.h>
+#include <lwip/netif.h>
+#include <lwip/tcpip.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+
+static const char DISCOVERY_MSG[] = "DISCOVER-POWERPLANT";
+static const char* NVS_NAMESPACE = "discovery";
+static const char* NVS_KEY = "server";
+
+ServerDiscovery::ServerDiscovery()
+    : knownMacCount(0), preferredCount(0), orderCount(0), orderPreferred(0), nextProbe(0), ownHost(0),
+      hostsProbed(0), candidateRank(-1), candidateAt(0), rejectedUdp(0), udpOpen(false), lastBroadcast(0) {
+    memset(subnet, 0, sizeof(subnet));
+    for (uint8_t i = 0; i < MAX_PARALLEL_CONNECTS; i++) probes[i].fd = -1;
+}
+
+void ServerDiscovery::addKnownMac(const uint8_t mac[6]) {
+    if (knownMacCount < MAX_KNOWN_MACS) memcpy(knownMacs[knownMacCount++], mac, 6);
+}
+
+void ServerDiscovery::addPreferredHost(uint8_t host) {
+    for (uint8_t i = 0; i < preferredCount; i++) {
+        if (preferredHosts[i] == host) return;
+    }
+    if (preferredCount < MAX_PREFERRED_HOSTS) preferredHosts[preferredCount++] = host;
+}
+
+const char* ServerDiscovery::sourceName(Source source) {
+    switch (source) {
+        case SOURCE_UDP: return "UDP broadcast";
+        case SOURCE_MAC: return "known MAC";
+        case SOURCE_PORT: return "open port 80";
+        default: return "none";
+    }
+}
+
+void ServerDiscovery::buildOrder() {
+    bool queued[256] = {};
+    orderCount = 0;
+    for (uint8_t i = 0; i < preferredCount; i++) {
+        const uint8_t host = preferredHosts[i];
+        if (host < 2 || host > 254 || host == ownHost || queued[host]) continue;
+        queued[host] = true;
+        order[orderCount++] = host;
+    }
+    orderPreferred = orderCount;
+    for (uint16_t host = 2; host <= 254; host++) {
+        if (host == ownHost || queued[host]) continue;
+        order[orderCount++] = static_cast<uint8_t>(host);
+    }
+}
+
+bool ServerDiscovery::startProbe(Probe& probe, uint8_t rank, unsigned long now) {
+    const int fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (fd < 0) return false;
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(80);
+    addr.sin_addr.s_addr = static_cast<uint32_t>(hostAddress(order[rank]));
+
+    hostsProbed++;
+    if (connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) < 0 && errno != EINPROGRESS) {
+        close(fd);          // failed right away (no route); the host is done
+        return true;
+    }
+    probe.fd = fd;
+    probe.rank = rank;
+    probe.startedAt = now;
+    return true;
+}
+
+void ServerDiscovery::closeProbe(Probe& probe) {
+    if (probe.fd < 0) return;
+    close(probe.fd);
+    probe.fd = -1;
+}
+
+uint8_t ServerDiscovery::pollProbes(unsigned long now) {
+    fd_set writable;
+    FD_ZERO(&writable);
+    int maxFd = -1;
+    for (uint8_t i = 0; i < MAX_PARALLEL_CONNECTS; i++) {
+        if (probes[i].fd < 0) continue;
+        FD_SET(probes[i].fd, &writable);
+        if (probes[i].fd > maxFd) maxFd = probes[i].fd;
+    }
+    if (maxFd < 0) return 0;
+
+    struct timeval wait = {0, 10000};   // also paces the discovery loop
+    const int ready = select(maxFd + 1, nullptr, &writable, nullptr, &wait);
+
+    for (uint8_t i = 0; i < MAX_PARALLEL_CONNECTS; i++) {
+        Probe& probe = probes[i];
+        if (probe.fd < 0) continue;
+        if (ready > 0 && FD_ISSET(probe.fd, &writable)) {
+            int error = 0;
+            socklen_t length = sizeof(error);
+            getsockopt(probe.fd, SOL_SOCKET, SO_ERROR, &error, &length);
+            closeProbe(probe);
+            if (error != 0) continue;                    // refused: something there, not a web server
+            const uint8_t host = order[probe.rank];
+            if (hasKnownMac(host)) return host;
+            if (probe.rank < orderPreferred && (candidateRank < 0 || probe.rank < candidateRank)) {
+                candidateRank = probe.rank;
+                candidateAt = now;
+                Serial.printf("[Server Discovery] Port 80 open on %s\n", hostAddress(host).toString().c_str());
+            }
+        } else if (now - probe.startedAt >= DISCOVERY_CONNECT_TIMEOUT_MS) {
+            closeProbe(probe);
+        }
+    }
+    return 0;
+}
+
+bool ServerDiscovery::candidateSettled(unsigned long now) const {
+    if (candidateRank < 0 || now - candidateAt < DISCOVERY_CANDIDATE_GRACE_MS) return false;
+    // A better-ranked preferred host may still answer
+    for (uint8_t i = 0; i < MAX_PARALLEL_CONNECTS; i++) {
+        if (probes[i].fd >= 0 && probes[i].rank < candidateRank) return false;
+    }
+    return true;
+}
+
+bool ServerDiscovery::hasKnownMac(uint8_t host) const {
+    if (knownMacCount == 0) return false;
+    ip4_addr_t ip;
+    IP4_ADDR(&ip, subnet[0], subnet[1], subnet[2], host);
+    uint8_t mac[6];
+    bool found = false;
+
+#if LWIP_TCPIP_CORE_LOCKING
+    LOCK_TCPIP_CORE();
+#endif
+    for (struct netif* nif = netif_list; nif && !found; nif = nif->next) {
+        struct eth_addr* entryMac = nullptr;
+        const ip4_addr_t* entryIp = nullptr;
+        if (etharp_find_addr(nif, &ip, &entryMac, &entryIp) >= 0 && entryMac) {
+            memcpy(mac, entryMac->addr, sizeof(mac));
+            found = true;
+        }
+    }
+#if LWIP_TCPIP_CORE_LOCKING
+    UNLOCK_TCPIP_CORE();
+#endif
+
+    if (!found) return false;
+    for (uint8_t i = 0; i < knownMacCount; i++) {
+        if (memcmp(mac, knownMacs[i], sizeof(mac)) == 0) return true;
+    }
+    return false;
+}
+
+void ServerDiscovery::sendBroadcast(unsigned long now) {
+    udp.beginPacket(hostAddress(255), DISCOVERY_UDP_PORT);      // assumes a /24 like the sweep
+    udp.write(reinterpret_cast<const uint8_t*>(DISCOVERY_MSG), sizeof(DISCOVERY_MSG) - 1);
+    udp.endPacket();
+    lastBroadcast = now;
+}
+
+bool ServerDiscovery::pollUdp(IPAddress& ip) {
+    if (!udpOpen) return false;
+    // Our own broadcast and other boards' requests arrive here too
+    while (udp.parsePacket()) {
+        uint8_t packet[64];
+        const int length = udp.read(packet, sizeof(packet));
+        const IPAddress sender = udp.remoteIP();
+        if (length <= 0 || !isDiscoveryReply(packet, length, DISCOVERY_REPLY_TOKEN)) continue;
+        if (static_cast<uint32_t>(sender) == rejectedUdp) continue;    // already failed the check
+        ip = sender;
+        return true;
+    }
+    return false;
+}
+
+bool ServerDiscovery::verifyServer(const IPAddress& ip, uint32_t timeoutMs) {
+    const unsigned long start = millis();
+    WiFiClient client;
+    if (!client.connect(ip, 80, timeoutMs)) return false;
+
+    char request[96];
+    const int requestLength = snprintf(request, sizeof(request), "GET %s HTTP/1.0\r\nHost: %s\r\n\r\n",
+                                       DISCOVERY_VERIFY_PATH, ip.toString().c_str());
+    client.write(reinterpret_cast<const uint8_t*>(request), requestLength);
+
+    // HTTP/1.0: the answer ends when the server closes; the token sits early in a short body
+    char response[256];
+    size_t length = 0;
+    while (length + 1 < sizeof(response) && millis() - start < timeoutMs) {
+        if (!client.available()) {
+            if (!client.connected()) break;
+            delay(5);
+            continue;
+        }
+        const int n = client.read(reinterpret_cast<uint8_t*>(response + length), sizeof(response) - 1 - length);
+        if (n > 0) length += n;
+    }
+    client.stop();
+    response[length] = '\0';
+    return isDiscoveryAnswer(response, DISCOVERY_REPLY_TOKEN);
+}
+
+bool ServerDiscovery::accept(const IPAddress& ip, Source source) {
+    if (verifyServer(ip, DISCOVERY_VERIFY_TIMEOUT_MS)) return true;
+    Serial.printf("[Server Discovery] %s (%s) is not the game server, searching on\n", ip.toString().c_str(),
+                  sourceName(source));
+    return false;
+}
+
+void ServerDiscovery::describeNetwork(CachedServer& entry) {
+    const IPAddress myIp = WiFi.localIP();
+    const IPAddress mask = WiFi.subnetMask();
+    const IPAddress gateway = WiFi.gatewayIP();
+    const uint8_t* bssid = WiFi.BSSID();
+    for (uint8_t i = 0; i < 4; i++) {
+        entry.network[i] = myIp[i] & mask[i];
+        entry.gateway[i] = gateway[i];
+    }
+    if (bssid) {
+        memcpy(entry.bssid, bssid, sizeof(entry.bssid));
+    } else {
+        memset(entry.bssid, 0, sizeof(entry.bssid));
+    }
+}
+
+bool ServerDiscovery::loadCached(CachedServer& entry) {
+    Preferences prefs;
+    if (!prefs.begin(NVS_NAMESPACE, true)) return false;
+    const bool ok = prefs.getBytesLength(NVS_KEY) == sizeof(entry) &&
+                    prefs.getBytes(NVS_KEY, &entry, sizeof(entry)) == sizeof(entry) &&
+                    entry.version == CACHE_VERSION;
+    prefs.end();
+    return ok;
+}
+
+void ServerDiscovery::rememberServer(const IPAddress& ip) {
+    CachedServer entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.version = CACHE_VERSION;
+    for (uint8_t i = 0; i < 4; i++) entry.ip[i] = ip[i];
+    describeNetwork(entry);
+
+    CachedServer stored;
+    if (loadCached(stored) && memcmp(&stored, &entry, sizeof(entry)) == 0) return;   // spare the flash
+    Preferences prefs;
+    if (!prefs.begin(NVS_NAMESPACE, false)) return;
+    prefs.putBytes(NVS_KEY, &entry, sizeof(entry));
+    prefs.end();
+    Serial.printf("[Server Discovery] Remembered server %s\n", ip.toString().c_str());
+}
+
+void ServerDiscovery::forgetServer() {
+    Preferences prefs;
+    if (!prefs.begin(NVS_NAMESPACE, false)) return;
+    prefs.remove(NVS_KEY);
+    prefs.end();
+}
+
+bool ServerDiscovery::revalidateCached(uint32_t timeoutMs, IPAddress& ip) {
+    CachedServer cached;
+    if (!loadCached(cached)) return false;
+
+    CachedServer current;
+    describeNetwork(current);
+    const IPAddress cachedIp(cached.ip[0], cached.ip[1], cached.ip[2], cached.ip[3]);
+    const bool sameSubnet = memcmp(cached.network, current.network, sizeof(current.network)) == 0;
+    const bool sameAccessPoint = memcmp(cached.bssid, current.bssid, sizeof(current.bssid)) == 0;
+    const bool sameGateway = memcmp(cached.gateway, current.gateway, sizeof(current.gateway)) == 0;
+    if (!sameSubnet || (!sameAccessPoint && !sameGateway)) {
+        Serial.printf("[Server Discovery] Remembered server %s is from another network\n", cachedIp.toString().c_str());
+        return false;
+    }
+
+    const unsigned long start = millis();
+    if (!verifyServer(cachedIp, timeoutMs)) {
+        Serial.printf("[Server Discovery] Remembered server %s did not answer as the game server\n",
+                      cachedIp.toString().c_str());
+        return false;
+    }
+    Serial.printf("[Server Discovery] ✅ Remembered server %s answered in %lu ms\n", cachedIp.toString().c_str(),
+                  (unsigned long)(millis() - start));
+    ip = cachedIp;
+    return true;
+}
+
+ServerDiscovery::Result ServerDiscovery::run(uint32_t timeoutMs) {
+    Result result;
+    result.ip = IPAddress();
+    result.source = SOURCE_NONE;
+
+    const unsigned long start = millis();
+    const IPAddress myIp = WiFi.localIP();
+    const IPAddress mask = WiFi.subnetMask();
+    for (uint8_t i = 0; i < 3; i++) subnet[i] = myIp[i] & mask[i];
+    ownHost = myIp[3];
+    buildOrder();
+    nextProbe = 0;
+    hostsProbed = 0;
+    candidateRank = -1;
+    rejectedUdp = 0;
+
+    Serial.printf("[Server Discovery] Searching %u.%u.%u.0/24: UDP broadcast, %u parallel connects\n",
+                  subnet[0], subnet[1], subnet[2], MAX_PARALLEL_CONNECTS);
+
+    udpOpen = udp.begin(DISCOVERY_UDP_PORT);
+    if (udpOpen) {
+        sendBroadcast(start);
+    } else {
+        Serial.println("[Server Discovery] Failed to start UDP");
+    }
+
+    while (millis() - start < timeoutMs) {
+        const unsigned long now = millis();
+        IPAddress ip;
+        if (pollUdp(ip)) {
+            if (accept(ip, SOURCE_UDP)) {
+                result.ip = ip;
+                result.source = SOURCE_UDP;
+                break;
+            }
+            rejectedUdp = static_cast<uint32_t>(ip);
+        }
+
+        for (uint8_t i = 0; i < MAX_PARALLEL_CONNECTS && nextProbe < orderCount; i++) {
+            if (probes[i].fd >= 0) continue;
+            if (!startProbe(probes[i], nextProbe, now)) break;       // out of sockets for now
+            nextProbe++;
+        }
+        bool active = false;
+        for (uint8_t i = 0; i < MAX_PARALLEL_CONNECTS; i++) {
+            if (probes[i].fd >= 0) active = true;
+        }
+
+        const uint8_t confirmed = pollProbes(now);
+        if (confirmed && accept(hostAddress(confirmed), SOURCE_MAC)) {
+            result.ip = hostAddress(confirmed);
+            result.source = SOURCE_MAC;
+            break;
+        }
+
+        if (candidateSettled(now)) {
+            if (accept(hostAddress(order[candidateRank]), SOURCE_PORT)) break;
+            candidateRank = -1;                                       // later preferred hosts may still open
+        }
+        if (!active) delay(10);                                       // only UDP left to wait for
+
+        if (udpOpen && now - lastBroadcast >= DISCOVERY_BROADCAST_INTERVAL_MS) sendBroadcast(now);
+    }
+
+    if (result.source == SOURCE_NONE && candidateRank >= 0) {
+        for (uint8_t i = 0; i < MAX_PARALLEL_CONNECTS; i++) closeProbe(probes[i]);   // free sockets for the check
+        if (accept(hostAddress(order[candidateRank]), SOURCE_PORT)) {
+            result.ip = hostAddress(order[candidateRank]);
+            result.source = SOURCE_PORT;
+        }
+    }
+
+    for (uint8_t i = 0; i < MAX_PARALLEL_CONNECTS; i++) closeProbe(probes[i]);
+    if (udpOpen) udp.stop();
+    udpOpen = false;
+
+    result.elapsedMs = millis() - start;
+    result.hostsProbed = hostsProbed;
+    if (result.source != SOURCE_NONE) {
+        Serial.printf("[Server Discovery] ✅ Server %s via %s in %lu ms (%u hosts probed)\n",
+                      result.ip.toString().c_str(), sourceName(result.source), (unsigned long)result.elapsedMs,
+                      hostsProbed);
+    } else {
+        Serial.printf("[Server Discovery] No server found in %lu ms (%u hosts probed)\n",
+                      (unsigned long)result.elapsedMs, hostsProbed);
+    }
+    return result;
+}
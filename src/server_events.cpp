@@ -0,0 +1,118 @@
+#include "server_events.h"
+#include "board_config.h"
+#include <Arduino.h>
+#include <WiFi.h>
+#include <WiFiClient.h>
+#include <freertos/FreeRTOS.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+ServerEvents::ServerEvents()
+    : ServerEventsSession(SERVER_EVENTS_IDLE_TIMEOUT_MS, SERVER_EVENTS_STABLE_MS, SERVER_EVENTS_RETRY_MIN_MS,
+                          SERVER_EVENTS_RETRY_MAX_MS),
+      started(false), tls("push") {
+    url[0] = '\0';
+    tls.setHandshakeTimeout(CONNECT_TIMEOUT_MS);
+}
+
+bool ServerEvents::begin(const char* serverUrl) {
+    if (started.load()) return true;
+    char host[MAX_HOST_LEN + 1];
+    uint16_t port;
+    bool secure;
+    if (!parseUrl(serverUrl, host, port, secure) || strlen(serverUrl) >= sizeof(url)) {
+        Serial.printf("[PUSH] Cannot subscribe to %s, polling only\n", serverUrl ? serverUrl : "(none)");
+        return false;
+    }
+    strcpy(url, serverUrl);
+    if (xTaskCreate(taskEntry, "push", TASK_STACK, this, 1, nullptr) != pdPASS) {
+        Serial.println("[PUSH] Could not start the subscription task, polling only");
+        return false;
+    }
+    started = true;
+    return true;
+}
+
+bool ServerEvents::parseUrl(const char* url, char* host, uint16_t& port, bool& secure) {
+    if (!url) return false;
+    const char* rest;
+    if (strncmp(url, "https://", 8) == 0) {
+        secure = true;
+        port = 443;
+        rest = url + 8;
+    } else if (strncmp(url, "http://", 7) == 0) {
+        secure = false;
+        port = 80;
+        rest = url + 7;
+    } else {
+        return false;
+    }
+
+    const size_t hostLen = strcspn(rest, ":/");
+    if (hostLen == 0 || hostLen > MAX_HOST_LEN) return false;
+    memcpy(host, rest, hostLen);
+    host[hostLen] = '\0';
+
+    if (rest[hostLen] == ':') {
+        const long value = strtol(rest + hostLen + 1, nullptr, 10);
+        if (value <= 0 || value > 65535) return false;
+        port = static_cast<uint16_t>(value);
+    }
+    return true;
+}
+
+void ServerEvents::taskEntry(void* arg) {
+    static_cast<ServerEvents*>(arg)->run();
+}
+
+// ServerEventsSession link over the board's Client, clock and WiFi
+namespace {
+struct PushLink {
+    Client& client;
+    const char* host;
+    uint16_t port;
+
+    bool connect() { return client.connect(host, port); }
+    size_t write(const uint8_t* data, size_t len) { return client.write(data, len); }
+    int available() { return client.available(); }
+    int read(uint8_t* buf, size_t size) { return client.read(buf, size); }
+    bool connected() { return client.connected(); }
+    void stop() { client.stop(); }
+    unsigned long millis() { return ::millis(); }
+    void delay(uint32_t ms) { ::delay(ms); }
+    bool online() { return WiFi.status() == WL_CONNECTED; }
+    void log(const char* line) { Serial.println(line); }
+};
+}
+
+void ServerEvents::run() {
+    char host[MAX_HOST_LEN + 1];
+    uint16_t port;
+    bool secure;
+    parseUrl(url, host, port, secure);
+    for (;;) {
+        if (WiFi.status() != WL_CONNECTED) {
+            delay(1000);
+            continue;
+        }
+        WiFiClient plain;
+        PushLink link = {secure ? static_cast<Client&>(tls) : static_cast<Client&>(plain), host, port};
+        delay(session(link, host, SERVER_EVENTS_PATH, BOARD_ID));
+    }
+}
+
+void ServerEvents::print() const {
+    if (!started.load()) {
+        Serial.println("[PUSH] Not started, polling only");
+        return;
+    }
+    const unsigned long now = millis();
+    const unsigned long lastEventAt = getLastEventAt();
+    Serial.printf("[PUSH] %s, %lu connects (%lu failed), %lu events (%lu unknown)",
+                  isSubscribed() ? "subscribed" : "down", (unsigned long)getConnects(), (unsigned long)getFailures(),
+                  (unsigned long)getEvents(), (unsigned long)getUnknownEvents());
+    if (lastEventAt) Serial.printf(", last event %lu s ago", (unsigned long)((now - lastEventAt) / 1000));
+    Serial.println();
+    tls.print("PUSH");
+}
@@ -0,0 +1,241 @@
+#include "tls_session_client.h"
+#include <Arduino.h>
+#include <Preferences.h>
+#include <lwip/sockets.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char* NVS_NAMESPACE = "tlssession";
+
+TlsSessionClient::TlsSessionClient(const char* nvsKey)
+    : seeded(false), haveSession(false), sessionLoaded(false), open(false), peeked(-1), handshakeTimeoutMs(5000),
+      handshakes(0), resumed(0), failedHandshakes(0), lastHandshakeMs(0), fullHandshakeMs(0), resumedHandshakeMs(0) {
+    strncpy(this->nvsKey, nvsKey, sizeof(this->nvsKey) - 1);
+    this->nvsKey[sizeof(this->nvsKey) - 1] = '\0';
+    mbedtls_net_init(&net);
+    mbedtls_ssl_init(&ssl);
+    mbedtls_ssl_config_init(&conf);
+    mbedtls_entropy_init(&entropy);
+    mbedtls_ctr_drbg_init(&drbg);
+    mbedtls_ssl_session_init(&saved);
+}
+
+TlsSessionClient::~TlsSessionClient() {
+    stop();
+    mbedtls_ssl_session_free(&saved);
+    mbedtls_ssl_config_free(&conf);
+    mbedtls_ctr_drbg_free(&drbg);
+    mbedtls_entropy_free(&entropy);
+}
+
+bool TlsSessionClient::setup(const char* host) {
+    if (!seeded) {
+        static const char personalization[] = "tls-session-client";
+        if (mbedtls_ctr_drbg_seed(&drbg, mbedtls_entropy_func, &entropy,
+                                  reinterpret_cast<const unsigned char*>(personalization),
+                                  sizeof(personalization) - 1) != 0 ||
+            mbedtls_ssl_config_defaults(&conf, MBEDTLS_SSL_IS_CLIENT, MBEDTLS_SSL_TRANSPORT_STREAM,
+                                        MBEDTLS_SSL_PRESET_DEFAULT) != 0) {
+            return false;
+        }
+        mbedtls_ssl_conf_authmode(&conf, MBEDTLS_SSL_VERIFY_NONE);   // like the API client
+        mbedtls_ssl_conf_rng(&conf, mbedtls_ctr_drbg_random, &drbg);
+#if defined(MBEDTLS_SSL_SESSION_TICKETS)
+        mbedtls_ssl_conf_session_tickets(&conf, MBEDTLS_SSL_SESSION_TICKETS_ENABLED);
+#endif
+        seeded = true;
+    }
+    mbedtls_ssl_conf_read_timeout(&conf, handshakeTimeoutMs);
+    return mbedtls_ssl_setup(&ssl, &conf) == 0 && mbedtls_ssl_set_hostname(&ssl, host) == 0;
+}
+
+int TlsSessionClient::connect(IPAddress ip, uint16_t port) {
+    return connect(ip.toString().c_str(), port);
+}
+
+int TlsSessionClient::connect(const char* host, uint16_t port) {
+    stop();
+    if (!sessionLoaded) loadSession();
+
+    char portText[6];
+    snprintf(portText, sizeof(portText), "%u", port);
+    if (mbedtls_net_connect(&net, host, portText, MBEDTLS_NET_PROTO_TCP) != 0) {
+        mbedtls_net_free(&net);
+        return 0;
+    }
+    // Probe an idle stream so a peer that vanished without a FIN is noticed
+    int enable = 1;
+    int idleS = 30;
+    int intervalS = 5;
+    int probes = 3;
+    setsockopt(net.fd, SOL_SOCKET, SO_KEEPALIVE, &enable, sizeof(enable));
+    setsockopt(net.fd, IPPROTO_TCP, TCP_KEEPIDLE, &idleS, sizeof(idleS));
+    setsockopt(net.fd, IPPROTO_TCP, TCP_KEEPINTVL, &intervalS, sizeof(intervalS));
+    setsockopt(net.fd, IPPROTO_TCP, TCP_KEEPCNT, &probes, sizeof(probes));
+
+    if (!setup(host)) {
+        stop();
+        return 0;
+    }
+    mbedtls_ssl_set_bio(&ssl, &net, mbedtls_net_send, nullptr, mbedtls_net_recv_timeout);
+    const bool offered = haveSession && mbedtls_ssl_set_session(&ssl, &saved) == 0;
+
+    const unsigned long startedAt = millis();
+    const int ret = mbedtls_ssl_handshake(&ssl);
+    const uint32_t elapsedMs = static_cast<uint32_t>(millis() - startedAt);
+    if (ret != 0) {
+        failedHandshakes++;
+        Serial.printf("[TLS] Handshake with %s failed (-0x%04x) after %lu ms\n", host, (unsigned)-ret,
+                      (unsigned long)elapsedMs);
+        if (offered) forgetSession();   // never retry with a session the server chokes on
+        stop();
+        return 0;
+    }
+
+    // Resumption keeps the master secret of the offered session, a full handshake makes a new one
+    const bool wasResumed = offered && memcmp(ssl.session->master, saved.master, sizeof(saved.master)) == 0;
+    handshakes++;
+    lastHandshakeMs = elapsedMs;
+    if (wasResumed) {
+        resumed++;
+        resumedHandshakeMs += elapsedMs;
+    } else {
+        fullHandshakeMs += elapsedMs;
+    }
+    // Keep the latest session (a resumed one may come with a fresh ticket); flash only after a
+    // full handshake
+    mbedtls_ssl_session_free(&saved);
+    mbedtls_ssl_session_init(&saved);
+    haveSession = mbedtls_ssl_get_session(&ssl, &saved) == 0;
+    if (haveSession && !wasResumed) storeSession();
+
+    // Streaming from here: reads return at once when nothing is buffered
+    mbedtls_net_set_nonblock(&net);
+    mbedtls_ssl_set_bio(&ssl, &net, mbedtls_net_send, mbedtls_net_recv, nullptr);
+    open = true;
+    return 1;
+}
+
+size_t TlsSessionClient::write(const uint8_t* buf, size_t size) {
+    size_t sent = 0;
+    const unsigned long startedAt = millis();
+    while (open && sent < size) {
+        const int ret = mbedtls_ssl_write(&ssl, buf + sent, size - sent);
+        if (ret > 0) {
+            sent += ret;
+        } else if (ret == MBEDTLS_ERR_SSL_WANT_WRITE || ret == MBEDTLS_ERR_SSL_WANT_READ) {
+            if (millis() - startedAt >= handshakeTimeoutMs) break;
+            delay(1);
+        } else {
+            open = false;
+        }
+    }
+    return sent;
+}
+
+int TlsSessionClient::readSome(uint8_t* buf, size_t size) {
+    if (!open) return -1;
+    const int ret = mbedtls_ssl_read(&ssl, buf, size);
+    if (ret > 0) return ret;
+    if (ret == MBEDTLS_ERR_SSL_WANT_READ || ret == MBEDTLS_ERR_SSL_WANT_WRITE) return 0;
+    open = false;   // closed by the peer (0, close notify) or broken
+    return -1;
+}
+
+int TlsSessionClient::available() {
+    if (peeked < 0 && open) {
+        uint8_t b;
+        if (readSome(&b, 1) == 1) peeked = b;
+    }
+    if (peeked < 0) return 0;
+    return 1 + static_cast<int>(mbedtls_ssl_get_bytes_avail(&ssl));
+}
+
+int TlsSessionClient::read() {
+    uint8_t b;
+    return read(&b, 1) == 1 ? b : -1;
+}
+
+int TlsSessionClient::read(uint8_t* buf, size_t size) {
+    if (size == 0) return 0;
+    size_t n = 0;
+    if (peeked >= 0) {
+        buf[n++] = static_cast<uint8_t>(peeked);
+        peeked = -1;
+    }
+    if (n < size) {
+        const int more = readSome(buf + n, size - n);
+        if (more > 0) n += more;
+    }
+    return n ? static_cast<int>(n) : -1;
+}
+
+int TlsSessionClient::peek() {
+    return available() ? peeked : -1;
+}
+
+void TlsSessionClient::stop() {
+    if (open) mbedtls_ssl_close_notify(&ssl);   // best effort, the socket is non-blocking
+    open = false;
+    peeked = -1;
+    mbedtls_ssl_free(&ssl);
+    mbedtls_ssl_init(&ssl);
+    mbedtls_net_free(&net);
+}
+
+void TlsSessionClient::loadSession() {
+    sessionLoaded = true;
+    Preferences prefs;
+    if (!prefs.begin(NVS_NAMESPACE, true)) return;
+    const size_t length = prefs.getBytesLength(nvsKey);
+    uint8_t* blob = length > 0 && length <= MAX_SAVED_SESSION ? static_cast<uint8_t*>(malloc(length)) : nullptr;
+    if (blob) {
+        haveSession = prefs.getBytes(nvsKey, blob, length) == length && mbedtls_ssl_session_load(&saved, blob, length) == 0;
+        free(blob);
+    }
+    prefs.end();
+    if (!haveSession) {
+        mbedtls_ssl_session_free(&saved);
+        mbedtls_ssl_session_init(&saved);
+    }
+}
+
+void TlsSessionClient::storeSession() {
+    uint8_t* blob = static_cast<uint8_t*>(malloc(MAX_SAVED_SESSION));
+    if (!blob) return;
+    size_t length = 0;
+    if (mbedtls_ssl_session_save(&saved, blob, MAX_SAVED_SESSION, &length) == 0) {
+        Preferences prefs;
+        if (prefs.begin(NVS_NAMESPACE, false)) {
+            prefs.putBytes(nvsKey, blob, length);
+            prefs.end();
+        }
+    }
+    free(blob);
+}
+
+void TlsSessionClient::forgetSession() {
+    mbedtls_ssl_session_free(&saved);
+    mbedtls_ssl_session_init(&saved);
+    haveSession = false;
+    Preferences prefs;
+    if (prefs.begin(NVS_NAMESPACE, false)) {
+        prefs.remove(nvsKey);
+        prefs.end();
+    }
+}
+
+void TlsSessionClient::print(const char* tag) const {
+    const uint32_t total = handshakes.load();
+    if (total == 0 && failedHandshakes.load() == 0) return;
+    const uint32_t resumedCount = resumed.load();
+    const uint32_t fullCount = total - resumedCount;
+    Serial.printf("[%s] TLS handshakes: %lu (%lu resumed, %lu%%), %lu failed, avg full %lu ms, avg resumed %lu ms, "
+                  "last %lu ms\n",
+                  tag, (unsigned long)total, (unsigned long)resumedCount,
+                  (unsigned long)(total ? resumedCount * 100 / total : 0), (unsigned long)failedHandshakes.load(),
+                  (unsigned long)(fullCount ? fullHandshakeMs.load() / fullCount : 0),
+                  (unsigned long)(resumedCount ? resumedHandshakeMs.load() / resumedCount : 0),
+                  (unsigned long)lastHandshakeMs.load());
+}
@@ -0,0 +1,144 @@
+#include "uid_store.h"
+#include <string.h>
+
+bool RawUid::operator==(const RawUid& other) const {
+    return len == other.len && memcmp(bytes, other.bytes, len) == 0;
+}
+
+static int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+bool UidStore::parse(const char* text, size_t len, RawUid& out, uint8_t& format) {
+    memset(&out, 0, sizeof(out));
+    format = 0;
+    if (!text) return false;
+
+    char separator = 0;
+    bool sawLower = false;
+    size_t pos = 0;
+    uint8_t n = 0;
+    while (pos < len) {
+        if (n > 0) {
+            // Optional separator between bytes; it has to be the same one throughout
+            const char c = text[pos];
+            if (hexValue(c) < 0) {
+                if (c != ':' && c != ' ' && c != '-') return false;
+                if (n == 1) separator = c;
+                else if (c != separator) return false;
+                pos++;
+            } else if (separator != 0) {
+                return false;
+            }
+        }
+        if (n >= RawUid::MAX_BYTES || pos + 2 > len) return false;
+        const int hi = hexValue(text[pos]);
+        const int lo = hexValue(text[pos + 1]);
+        if (hi < 0 || lo < 0) return false;
+        sawLower = sawLower || (text[pos] >= 'a') || (text[pos + 1] >= 'a');
+        out.bytes[n++] = static_cast<uint8_t>((hi << 4) | lo);
+        pos += 2;
+    }
+    if (n != 4 && n != 7 && n != 10) return false;
+
+    out.len = n;
+    format = static_cast<uint8_t>(separator) | (sawLower ? FORMAT_LOWERCASE : 0);
+    return true;
+}
+
+size_t UidStore::format(const RawUid& uid, uint8_t format, char* out, size_t capacity) {
+    if (uid.len == 0 || uid.len > RawUid::MAX_BYTES) return 0;
+    const char separator = static_cast<char>(format & FORMAT_SEPARATOR_MASK);
+    const size_t length = uid.len * 2 + (separator ? uid.len - 1 : 0);
+    if (!out || capacity < length + 1) return 0;
+
+    const char* digits = (format & FORMAT_LOWERCASE) ? "0123456789abcdef" : "0123456789ABCDEF";
+    size_t pos = 0;
+    for (uint8_t i = 0; i < uid.len; i++) {
+        if (i > 0 && separator) out[pos++] = separator;
+        out[pos++] = digits[uid.bytes[i] >> 4];
+        out[pos++] = digits[uid.bytes[i] & 0x0F];
+    }
+    out[pos] = '\0';
+    return pos;
+}
+
+UidStore::UidStore() : rejected(0) {
+    clear();
+}
+
+uint32_t UidStore::keyOf(const RawUid& uid) {
+    return (static_cast<uint32_t>(uid.bytes[0]) << 24 | static_cast<uint32_t>(uid.bytes[1]) << 16 |
+            static_cast<uint32_t>(uid.bytes[2]) << 8 | uid.bytes[3]) ^ uid.len;
+}
+
+UidHandle UidStore::find(const RawUid& uid) const {
+    if (uid.len == 0 || count == 0) return INVALID;
+    const uint32_t key = keyOf(uid);
+    for (uint8_t i = 0; i < CAPACITY; i++) {
+        if (entries[i].key == key && entries[i].uid.len != 0 && entries[i].uid == uid) return i;
+    }
+    return INVALID;
+}
+
+UidHandle UidStore::find(const char* text, size_t len) const {
+    RawUid uid;
+    uint8_t format;
+    return parse(text, len, uid, format) ? find(uid) : INVALID;
+}
+
+UidHandle UidStore::intern(const RawUid& uid, uint8_t buildingType, uint8_t format) {
+    if (uid.len == 0 || uid.len > RawUid::MAX_BYTES) {
+        rejected++;
+        return INVALID;
+    }
+    UidHandle handle = find(uid);
+    if (handle == INVALID) {
+        for (uint8_t i = 0; i < CAPACITY; i++) {
+            if (entries[i].uid.len == 0) { handle = i; break; }
+        }
+        if (handle == INVALID) {
+            rejected++;
+            return INVALID;
+        }
+        Entry& entry = entries[handle];
+        memset(&entry.uid, 0, sizeof(entry.uid));
+        entry.uid.len = uid.len;
+        memcpy(entry.uid.bytes, uid.bytes, uid.len);
+        entry.key = keyOf(entry.uid);
+        count++;
+    }
+    entries[handle].buildingType = buildingType;
+    entries[handle].format = format;
+    return handle;
+}
+
+UidHandle UidStore::intern(const char* text, size_t len, uint8_t buildingType) {
+    RawUid uid;
+    uint8_t format;
+    if (!parse(text, len, uid, format)) {
+        rejected++;
+        return INVALID;
+    }
+    return intern(uid, buildingType, format);
+}
+
+bool UidStore::release(UidHandle handle) {
+    if (!isValid(handle)) return false;
+    memset(&entries[handle], 0, sizeof(Entry));
+    count--;
+    return true;
+}
+
+void UidStore::clear() {
+    memset(entries, 0, sizeof(entries));
+    count = 0;
+}
+
+size_t UidStore::toText(UidHandle handle, char* out, size_t capacity) const {
+    if (!isValid(handle)) return 0;
+    return format(entries[handle].uid, entries[handle].format, out, capacity);
+}
@@ -0,0 +1,67 @@
+#include "warm_start.h"
+#include <string.h>
+#include <Preferences.h>
+
+static const char* NVS_NAMESPACE = "warmstart";
+static const char* NVS_KEY = "state";
+
+// Scratch buffer for encode / load and a copy of the record in flash (kept off the loop
+// task stack). Encoding lives in warm_start_codec.cpp.
+static uint8_t recordBuffer[WarmStart::MAX_RECORD_SIZE];
+static uint8_t storedRecord[WarmStart::MAX_RECORD_SIZE];
+
+WarmStart::WarmStart()
+    : storedLength(0), wroteOnce(false), lastWriteTime(0), writeCount(0), unchangedCount(0), lastRecordSize(0) {}
+
+bool WarmStart::load(WarmStartState& state) {
+    Preferences prefs;
+    if (!prefs.begin(NVS_NAMESPACE, true)) return false;
+    size_t length = prefs.getBytesLength(NVS_KEY);
+    bool ok = false;
+    if (length >= HEADER_SIZE && length <= MAX_RECORD_SIZE) {
+        ok = prefs.getBytes(NVS_KEY, recordBuffer, length) == length &&
+             decode(recordBuffer, length, state);
+    }
+    prefs.end();
+    if (ok) {
+        memcpy(storedRecord, recordBuffer, length);
+        storedLength = length;
+        lastRecordSize = length;
+    }
+    return ok;
+}
+
+bool WarmStart::save(const WarmStartState& state, unsigned long now, bool force) {
+    if (!force && !isWriteAllowed(now)) return false;
+
+    size_t length = encode(state, recordBuffer, sizeof(recordBuffer));
+    if (length == 0) return false;
+    // Byte-for-byte: a matching CRC alone would drop a real change on a collision
+    if (length == storedLength && memcmp(recordBuffer, storedRecord, length) == 0) {
+        unchangedCount++;
+        return false;
+    }
+
+    Preferences prefs;
+    if (!prefs.begin(NVS_NAMESPACE, false)) return false;
+    bool ok = prefs.putBytes(NVS_KEY, recordBuffer, length) == length;
+    prefs.end();
+    if (!ok) return false;
+
+    memcpy(storedRecord, recordBuffer, length);
+    storedLength = length;
+    wroteOnce = true;
+    lastWriteTime = now;
+    lastRecordSize = length;
+    writeCount++;
+    return true;
+}
+
+void WarmStart::erase() {
+    Preferences prefs;
+    if (prefs.begin(NVS_NAMESPACE, false)) {
+        prefs.remove(NVS_KEY);
+        prefs.end();
+    }
+    storedLength = 0;
+}
@@ -0,0 +1,199 @@
+#include "warm_start.h"
+#include <string.h>
+
+static const uint8_t MAGIC_0 = 'W';
+static const uint8_t MAGIC_1 = 'S';
+
+// CRC16-CCITT, same polynomial as the UART link; crc continues an earlier run
+static uint16_t crc16(const uint8_t* data, size_t len, uint16_t crc = 0xFFFF) {
+    for (size_t i = 0; i < len; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (uint8_t j = 0; j < 8; j++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+// ---------------- WarmStartState ----------------
+
+void WarmStartState::clear() {
+    memset(this, 0, sizeof(*this));
+}
+
+bool WarmStartState::addConsumption(uint8_t buildingType, float value) {
+    if (consumptionCount >= MAX_CONSUMPTION) return false;
+    consumption[consumptionCount].buildingType = buildingType;
+    consumption[consumptionCount].consumption = value;
+    consumptionCount++;
+    return true;
+}
+
+bool WarmStartState::addBuilding(uint8_t buildingType, const RawUid& uid, uint8_t uidFormat) {
+    if (buildingCount >= MAX_BUILDINGS || uid.len == 0 || uid.len > RawUid::MAX_BYTES) return false;
+    Building& b = buildings[buildingCount];
+    b.buildingType = buildingType;
+    b.uidFormat = uidFormat;
+    b.uid = uid;
+    buildingCount++;
+    return true;
+}
+
+// ---------------- Encoding ----------------
+
+namespace {
+    struct Writer {
+        uint8_t* out;
+        size_t capacity;
+        size_t pos;
+        bool ok;
+
+        void bytes(const void* src, size_t len) {
+            if (!ok || pos + len > capacity) { ok = false; return; }
+            memcpy(out + pos, src, len);
+            pos += len;
+        }
+        void u8(uint8_t v) { bytes(&v, 1); }
+        void u16(uint16_t v) { uint8_t b[2] = {(uint8_t)v, (uint8_t)(v >> 8)}; bytes(b, 2); }
+        void f32(float v) { uint32_t u; memcpy(&u, &v, 4); uint8_t b[4] = {(uint8_t)u, (uint8_t)(u >> 8), (uint8_t)(u >> 16), (uint8_t)(u >> 24)}; bytes(b, 4); }
+    };
+
+    struct Reader {
+        const uint8_t* in;
+        size_t length;
+        size_t pos;
+        bool ok;
+
+        bool take(void* dst, size_t len) {
+            if (!ok || pos + len > length) { ok = false; return false; }
+            memcpy(dst, in + pos, len);
+            pos += len;
+            return true;
+        }
+        uint8_t u8() { uint8_t v = 0; take(&v, 1); return v; }
+        uint16_t u16() { uint8_t b[2] = {0, 0}; take(b, 2); return (uint16_t)(b[0] | (b[1] << 8)); }
+        float f32() {
+            uint8_t b[4] = {0, 0, 0, 0};
+            take(b, 4);
+            uint32_t u = (uint32_t)b[0] | ((uint32_t)b[1] << 8) | ((uint32_t)b[2] << 16) | ((uint32_t)b[3] << 24);
+            float v;
+            memcpy(&v, &u, 4);
+            return v;
+        }
+    };
+
+    // Only the slots that exist in the state can be flagged in a mask
+    const uint16_t TYPE_MASK_LIMIT = (uint16_t)((1u << WarmStartState::TYPE_SLOTS) - 1);
+}
+
+size_t WarmStart::encode(const WarmStartState& state, uint8_t* out, size_t capacity) {
+    if (capacity < HEADER_SIZE) return 0;
+
+    Writer w = {out, capacity, HEADER_SIZE, true};
+
+    const uint16_t rangeMask = state.rangeMask & TYPE_MASK_LIMIT;
+    w.u16(rangeMask);
+    for (uint8_t t = 0; t < WarmStartState::TYPE_SLOTS; t++) {
+        if (rangeMask & (1u << t)) { w.f32(state.minWatts[t]); w.f32(state.maxWatts[t]); }
+    }
+
+    const uint16_t coefficientMask = state.coefficientMask & TYPE_MASK_LIMIT;
+    w.u16(coefficientMask);
+    for (uint8_t t = 0; t < WarmStartState::TYPE_SLOTS; t++) {
+        if (coefficientMask & (1u << t)) w.f32(state.productionCoefficient[t]);
+    }
+
+    const uint16_t inventoryMask = state.inventoryMask & TYPE_MASK_LIMIT;
+    w.u16(inventoryMask);
+    for (uint8_t t = 0; t < WarmStartState::TYPE_SLOTS; t++) {
+        if (inventoryMask & (1u << t)) w.u8(state.inventory[t]);
+    }
+
+    const uint8_t consumptionCount = state.consumptionCount < WarmStartState::MAX_CONSUMPTION
+        ? state.consumptionCount : WarmStartState::MAX_CONSUMPTION;
+    w.u8(consumptionCount);
+    for (uint8_t i = 0; i < consumptionCount; i++) {
+        w.u8(state.consumption[i].buildingType);
+        w.f32(state.consumption[i].consumption);
+    }
+
+    const uint8_t buildingCount = state.buildingCount < WarmStartState::MAX_BUILDINGS
+        ? state.buildingCount : WarmStartState::MAX_BUILDINGS;
+    w.u8(buildingCount);
+    for (uint8_t i = 0; i < buildingCount; i++) {
+        const WarmStartState::Building& b = state.buildings[i];
+        w.u8(b.buildingType);
+        w.u8(b.uidFormat);
+        w.u8(b.uid.len);
+        w.bytes(b.uid.bytes, b.uid.len);
+    }
+
+    if (!w.ok) return 0;
+
+    const uint16_t payloadLen = (uint16_t)(w.pos - HEADER_SIZE);
+    out[0] = MAGIC_0;
+    out[1] = MAGIC_1;
+    out[2] = RECORD_VERSION;
+    out[3] = state.gameActive ? 0x01 : 0x00;
+    const uint16_t crc = crc16(out + HEADER_SIZE, payloadLen, crc16(out + 3, 1));
+    out[4] = (uint8_t)payloadLen;
+    out[5] = (uint8_t)(payloadLen >> 8);
+    out[6] = (uint8_t)crc;
+    out[7] = (uint8_t)(crc >> 8);
+    return w.pos;
+}
+
+bool WarmStart::decode(const uint8_t* data, size_t length, WarmStartState& state) {
+    if (length < HEADER_SIZE) return false;
+    if (data[0] != MAGIC_0 || data[1] != MAGIC_1 || data[2] != RECORD_VERSION) return false;
+    const uint16_t payloadLen = (uint16_t)(data[4] | (data[5] << 8));
+    const uint16_t crc = (uint16_t)(data[6] | (data[7] << 8));
+    if (HEADER_SIZE + payloadLen != length) return false;
+    if (crc16(data + HEADER_SIZE, payloadLen, crc16(data + 3, 1)) != crc) return false;
+
+    // Parse into a scratch copy so a malformed payload never leaves state half-written
+    static WarmStartState parsed;
+    parsed.clear();
+    parsed.gameActive = (data[3] & 0x01) != 0;
+
+    Reader r = {data, length, HEADER_SIZE, true};
+
+    parsed.rangeMask = r.u16() & TYPE_MASK_LIMIT;
+    for (uint8_t t = 0; t < WarmStartState::TYPE_SLOTS; t++) {
+        if (parsed.rangeMask & (1u << t)) { parsed.minWatts[t] = r.f32(); parsed.maxWatts[t] = r.f32(); }
+    }
+
+    parsed.coefficientMask = r.u16() & TYPE_MASK_LIMIT;
+    for (uint8_t t = 0; t < WarmStartState::TYPE_SLOTS; t++) {
+        if (parsed.coefficientMask & (1u << t)) parsed.productionCoefficient[t] = r.f32();
+    }
+
+    parsed.inventoryMask = r.u16() & TYPE_MASK_LIMIT;
+    for (uint8_t t = 0; t < WarmStartState::TYPE_SLOTS; t++) {
+        if (parsed.inventoryMask & (1u << t)) parsed.inventory[t] = r.u8();
+    }
+
+    const uint8_t consumptionCount = r.u8();
+    if (consumptionCount > WarmStartState::MAX_CONSUMPTION) return false;
+    for (uint8_t i = 0; i < consumptionCount && r.ok; i++) {
+        uint8_t type = r.u8();
+        float value = r.f32();
+        parsed.addConsumption(type, value);
+    }
+
+    const uint8_t buildingCount = r.u8();
+    if (buildingCount > WarmStartState::MAX_BUILDINGS) return false;
+    for (uint8_t i = 0; i < buildingCount && r.ok; i++) {
+        uint8_t type = r.u8();
+        uint8_t uidFormat = r.u8();
+        RawUid uid = {};
+        uid.len = r.u8();
+        if (uid.len == 0 || uid.len > RawUid::MAX_BYTES) return false;
+        if (!r.take(uid.bytes, uid.len)) break;
+        parsed.addBuilding(type, uid, uidFormat);
+    }
+
+    if (!r.ok || r.pos != length) return false;
+    memcpy(&state, &parsed, sizeof(parsed));
+    return true;
+}
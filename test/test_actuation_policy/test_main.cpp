@@ -0,0 +1,274 @@
+// Host tests for actuation_policy.h: every table row against the per-type functions it
+// replaced (the updatePhotovoltaic() ... updateBattery() chain in GameManager.cpp before the
+// table). Run with: pio test -e native
+#include <unity.h>
+#include <math.h>
+#include "actuation_policy.h"
+
+using namespace ActuationPolicy;
+using namespace UartProtocol;
+
+// ---- Reference: the pre-table per-type mapping ----------------------------------------
+
+struct LegacyInputs {
+    bool hasApi;         // espApi != nullptr
+    bool hasCoefficient; // the server sent a coefficient for the type (table only; legacy saw 0)
+    float coefficient;   // getProductionCoefficientForType(), 0 without a coefficient
+    float maxWatts;
+    float percent;       // encoder 0..1
+    float signedPower;   // power per plant (battery), sign only matters
+};
+
+static uint8_t legacyOnOffByPercent(const LegacyInputs& in) {
+    if (in.maxWatts <= 0.0f) return CMD_OFF;
+    return in.percent > 0.5f ? CMD_ON : CMD_OFF;
+}
+
+static uint8_t legacyCommand(uint8_t type, const LegacyInputs& in) {
+    switch (type) {
+    case SOURCE_PHOTOVOLTAIC:
+        return (in.hasApi && in.coefficient <= SOLAR_ACTIVE_THRESHOLD) ? CMD_ON : CMD_BATTERY_IDLE;
+    case SOURCE_WIND:
+        return (in.hasApi && in.coefficient > WIND_COEFFICIENT_THRESHOLD) ? CMD_ON : CMD_OFF;
+    case SOURCE_NUCLEAR:
+    case SOURCE_HYDRO:
+    case SOURCE_COAL:
+        return legacyOnOffByPercent(in);
+    case SOURCE_GAS: {
+        if (in.maxWatts <= 0.0f || in.percent < 0.05f) return CMD_OFF;
+        int level = (int)floorf(in.percent * 10.0f);
+        if (level == 0) level = 1;
+        if (level > 10) level = 10;
+        return static_cast<uint8_t>(0x05 + level);
+    }
+    case SOURCE_BATTERY:
+        // computePowerPerPlant() is 0 for a disabled type
+        if (in.maxWatts <= 0.0f || in.signedPower == 0.0f) return CMD_BATTERY_IDLE;
+        return in.signedPower < 0.0f ? CMD_BATTERY_CHARGE : CMD_BATTERY_DISCHARGE;
+    default:
+        return CMD_OFF;
+    }
+}
+
+static uint8_t tableCommand(uint8_t type, const LegacyInputs& in) {
+    Inputs inputs;
+    inputs.rangeValid = in.maxWatts > 0.0f;
+    inputs.coefficientValid = in.hasCoefficient;
+    inputs.values[INPUT_NONE] = 0.0f;
+    inputs.values[INPUT_ENCODER_PERCENT] = in.percent;
+    inputs.values[INPUT_COEFFICIENT] = in.coefficient;
+    inputs.values[INPUT_SIGNED_POWER] = inputs.rangeValid ? in.signedPower : 0.0f;
+    inputs.values[INPUT_STATE_OF_CHARGE] = 0.0f;
+    return evaluate(forType(type), inputs);
+}
+
+// Every input the sweep visits: a fine grid plus the floats right around every threshold of
+// every row, where a > / >= or float rounding mistake would show
+static const int NEIGHBOURS = 16;
+
+template <typename Visit>
+static void sweepValues(Visit visit) {
+    for (int i = -1500; i <= 1500; i++) visit(i / 1000.0f);
+    for (uint8_t type = 0; type < POLICY_COUNT; type++) {
+        const Policy& policy = POLICIES[type];
+        for (uint8_t t = 0; t < policy.thresholdCount; t++) {
+            float below = policy.thresholds[t];
+            float above = policy.thresholds[t];
+            visit(below);
+            for (int n = 0; n < NEIGHBOURS; n++) {
+                below = nextafterf(below, -INFINITY);
+                above = nextafterf(above, INFINITY);
+                visit(below);
+                visit(above);
+            }
+        }
+    }
+    // Gas bands of the old floorf(pct * 10) mapping
+    for (int band = 0; band <= 10; band++) {
+        float below = band / 10.0f;
+        float above = below;
+        for (int n = 0; n < NEIGHBOURS; n++) {
+            below = nextafterf(below, -INFINITY);
+            above = nextafterf(above, INFINITY);
+            visit(below);
+            visit(above);
+        }
+    }
+}
+
+static uint32_t mismatches;
+static uint32_t checked;
+
+static void expectSame(uint8_t type, const LegacyInputs& in) {
+    checked++;
+    const uint8_t expected = legacyCommand(type, in);
+    const uint8_t actual = tableCommand(type, in);
+    if (expected != actual && mismatches++ < 5) {
+        char msg[160];
+        snprintf(msg, sizeof(msg), "type %u api=%d has=%d coeff=%.9g max=%.1f pct=%.9g power=%.9g: legacy 0x%02X table 0x%02X",
+                 type, in.hasApi, in.hasCoefficient, in.coefficient, in.maxWatts, in.percent, in.signedPower, expected, actual);
+        TEST_MESSAGE(msg);
+    }
+}
+
+void setUp() {
+    mismatches = 0;
+    checked = 0;
+}
+
+void tearDown() {}
+
+static void test_coefficient_rows_match_legacy() {
+    const uint8_t types[] = {SOURCE_PHOTOVOLTAIC, SOURCE_WIND};
+    for (uint8_t type : types) {
+        sweepValues([&](float x) {
+            LegacyInputs in = {true, true, x, 0.0f, 0.0f, 0.0f};
+            expectSame(type, in);
+            in.maxWatts = 100.0f;  // coefficient rows ignore the range
+            expectSame(type, in);
+        });
+        // No ESP-API at all: no coefficient either
+        const LegacyInputs noApi = {false, false, 0.0f, 0.0f, 0.0f, 0.0f};
+        expectSame(type, noApi);
+    }
+    // Connected, but the server sent no coefficient for the type: the old getter returned 0
+    const LegacyInputs noWind = {true, false, 0.0f, 0.0f, 0.0f, 0.0f};
+    expectSame(SOURCE_WIND, noWind);
+    TEST_ASSERT_GREATER_THAN(0, checked);
+    TEST_ASSERT_EQUAL_UINT32(0, mismatches);
+}
+
+// Deliberate change: the old mapping read a missing solar coefficient as 0 and lit the
+// attraction orange (ON); the table idles it like the no-ESP-API case
+static void test_solar_without_coefficient_changed_from_legacy() {
+    const LegacyInputs in = {true, false, 0.0f, 0.0f, 0.0f, 0.0f};
+    TEST_ASSERT_EQUAL_HEX8(CMD_ON, legacyCommand(SOURCE_PHOTOVOLTAIC, in));
+    TEST_ASSERT_EQUAL_HEX8(CMD_BATTERY_IDLE, tableCommand(SOURCE_PHOTOVOLTAIC, in));
+}
+
+static void test_encoder_rows_match_legacy() {
+    const uint8_t types[] = {SOURCE_NUCLEAR, SOURCE_GAS, SOURCE_HYDRO, SOURCE_COAL};
+    const float maxWatts[] = {-10.0f, 0.0f, 250.0f};
+    for (uint8_t type : types) {
+        for (float max : maxWatts) {
+            sweepValues([&](float x) {
+                const LegacyInputs in = {true, true, 0.0f, max, x, 0.0f};
+                expectSame(type, in);
+            });
+        }
+    }
+    TEST_ASSERT_GREATER_THAN(0, checked);
+    TEST_ASSERT_EQUAL_UINT32(0, mismatches);
+}
+
+static void test_battery_matches_legacy() {
+    const float maxWatts[] = {0.0f, 250.0f};
+    for (float max : maxWatts) {
+        sweepValues([&](float x) {
+            const LegacyInputs in = {true, true, 0.0f, max, 0.0f, x};
+            expectSame(SOURCE_BATTERY, in);
+        });
+    }
+    TEST_ASSERT_GREATER_THAN(0, checked);
+    TEST_ASSERT_EQUAL_UINT32(0, mismatches);
+}
+
+static void test_unknown_types_are_off() {
+    const LegacyInputs in = {true, true, 1.0f, 100.0f, 1.0f, 1.0f};
+    TEST_ASSERT_EQUAL_HEX8(CMD_OFF, tableCommand(0, in));
+    TEST_ASSERT_EQUAL_HEX8(CMD_OFF, tableCommand(POLICY_COUNT, in));
+    TEST_ASSERT_EQUAL_HEX8(CMD_OFF, tableCommand(0xFF, in));
+}
+
+static void test_solar_without_coefficient_idles_with_state() {
+    Inputs inputs = {};
+    inputs.rangeValid = true;
+    inputs.coefficientValid = false;
+    LevelState state = {};
+    const Policy& solar = forType(SOURCE_PHOTOVOLTAIC);
+    TEST_ASSERT_EQUAL_HEX8(CMD_BATTERY_IDLE, evaluate(solar, inputs, state, 0));
+    TEST_ASSERT_FALSE(state.valid);
+
+    // The first coefficient applies at once, no dwell after being disabled
+    inputs.coefficientValid = true;
+    inputs.values[INPUT_COEFFICIENT] = 0.1f;
+    TEST_ASSERT_EQUAL_HEX8(CMD_ON, evaluate(solar, inputs, state, 1));
+    TEST_ASSERT_TRUE(state.valid);
+}
+
+// Ramp one row's input across its range and back with the dwell satisfied at every step
+template <typename Step>
+static void rampStateful(const Policy& policy, Step step) {
+    const InputRange& range = INPUT_RANGES[policy.source];
+    const float lo = range.min > -1.5f ? range.min : -1.5f;
+    const float hi = range.max < 1.5f ? range.max : 1.5f;
+    const int steps = static_cast<int>((hi - lo) * 1000.0f + 0.5f);
+    LevelState state = {};
+    unsigned long now = 0;
+    for (int pass = 0; pass < 2; pass++) {
+        for (int i = 0; i <= steps; i++) {
+            const float x = pass == 0 ? lo + (hi - lo) * i / steps : hi - (hi - lo) * i / steps;
+            Inputs inputs = {};
+            inputs.rangeValid = true;
+            inputs.coefficientValid = true;
+            inputs.values[policy.source] = x;
+            now += policy.minDwellMs + 1;
+            evaluate(policy, inputs, state, now);
+            step(x, state.level);
+        }
+    }
+}
+
+static void test_stateful_reaches_every_level() {
+    for (uint8_t type = 1; type < POLICY_COUNT; type++) {
+        const Policy& policy = forType(type);
+        bool reached[MAX_THRESHOLDS + 1] = {};
+        rampStateful(policy, [&](float x, uint8_t level) {
+            reached[level] = true;
+            // Hysteresis only ever keeps the level between the stateless levels of x -/+ band
+            TEST_ASSERT_TRUE(level >= quantize(policy, x - policy.hysteresis));
+            TEST_ASSERT_TRUE(level <= quantize(policy, x + policy.hysteresis));
+        });
+        for (uint8_t level = 0; level <= policy.thresholdCount; level++) {
+            char msg[64];
+            snprintf(msg, sizeof(msg), "%s level %u never reached", policy.name, level);
+            TEST_ASSERT_TRUE_MESSAGE(reached[level], msg);
+        }
+    }
+}
+
+static void test_stateful_matches_stateless_at_range_ends() {
+    for (uint8_t type = 1; type < POLICY_COUNT; type++) {
+        const Policy& policy = forType(type);
+        const InputRange& range = INPUT_RANGES[policy.source];
+        if (range.max == FLT_MAX) continue;
+        rampStateful(policy, [&](float x, uint8_t level) {
+            if (x == range.min || x == range.max) TEST_ASSERT_EQUAL_UINT8(quantize(policy, x), level);
+        });
+    }
+}
+
+static void test_full_encoder_reaches_gas_level_10() {
+    const Policy& gas = forType(SOURCE_GAS);
+    Inputs inputs = {};
+    inputs.rangeValid = true;
+    LevelState state = {};
+    inputs.values[INPUT_ENCODER_PERCENT] = 0.95f;
+    TEST_ASSERT_EQUAL_HEX8(CMD_GAS_LEVEL_1 + 8, evaluate(gas, inputs, state, 0));
+    inputs.values[INPUT_ENCODER_PERCENT] = 1.0f;
+    TEST_ASSERT_EQUAL_HEX8(CMD_GAS_LEVEL_10, evaluate(gas, inputs, state, ACTUATION_MIN_DWELL_MS + 1));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_coefficient_rows_match_legacy);
+    RUN_TEST(test_solar_without_coefficient_changed_from_legacy);
+    RUN_TEST(test_encoder_rows_match_legacy);
+    RUN_TEST(test_battery_matches_legacy);
+    RUN_TEST(test_unknown_types_are_off);
+    RUN_TEST(test_solar_without_coefficient_idles_with_state);
+    RUN_TEST(test_stateful_reaches_every_level);
+    RUN_TEST(test_stateful_matches_stateless_at_range_ends);
+    RUN_TEST(test_full_encoder_reaches_gas_level_10);
+    return UNITY_END();
+}
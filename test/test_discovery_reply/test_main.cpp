@@ -0,0 +1,49 @@
+// Host tests for discovery_reply.h: what discovery accepts as the game server's answer.
+// Run with: pio test -e native
+#include <unity.h>
+#include <string.h>
+#include "discovery_reply.h"
+
+static const char TOKEN[] = "POWERPLANT-SERVER";
+
+static bool udp(const char* packet) {
+    return isDiscoveryReply(reinterpret_cast<const uint8_t*>(packet), strlen(packet), TOKEN);
+}
+
+void setUp() {}
+void tearDown() {}
+
+static void test_reply_needs_the_token() {
+    TEST_ASSERT_TRUE(udp("POWERPLANT-SERVER"));
+    TEST_ASSERT_TRUE(udp("POWERPLANT-SERVER v2 game"));
+    TEST_ASSERT_FALSE(udp("POWERPLANT-SERV"));
+    TEST_ASSERT_FALSE(udp("hello POWERPLANT-SERVER"));
+    TEST_ASSERT_FALSE(udp(""));
+}
+
+static void test_request_of_another_board_is_not_a_reply() {
+    TEST_ASSERT_FALSE(udp("DISCOVER-POWERPLANT"));
+}
+
+static void test_answer_needs_2xx_and_the_token_in_the_body() {
+    TEST_ASSERT_TRUE(isDiscoveryAnswer("HTTP/1.1 200 OK\r\nContent-Length: 17\r\n\r\nPOWERPLANT-SERVER", TOKEN));
+    TEST_ASSERT_TRUE(isDiscoveryAnswer("HTTP/1.0 204 No Content\r\n\r\n{\"id\":\"POWERPLANT-SERVER\"}", TOKEN));
+    TEST_ASSERT_FALSE(isDiscoveryAnswer("HTTP/1.1 404 Not Found\r\n\r\nPOWERPLANT-SERVER", TOKEN));
+    TEST_ASSERT_FALSE(isDiscoveryAnswer("HTTP/1.1 200 OK\r\n\r\n<html>router</html>", TOKEN));
+}
+
+static void test_token_in_a_header_or_cut_answer_is_not_enough() {
+    TEST_ASSERT_FALSE(isDiscoveryAnswer("HTTP/1.1 200 OK\r\nX-Echo: POWERPLANT-SERVER\r\n\r\n", TOKEN));
+    TEST_ASSERT_FALSE(isDiscoveryAnswer("HTTP/1.1 200 OK\r\nServer: x", TOKEN));
+    TEST_ASSERT_FALSE(isDiscoveryAnswer("", TOKEN));
+    TEST_ASSERT_FALSE(isDiscoveryAnswer("SSH-2.0-OpenSSH\r\n", TOKEN));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_reply_needs_the_token);
+    RUN_TEST(test_request_of_another_board_is_not_a_reply);
+    RUN_TEST(test_answer_needs_2xx_and_the_token_in_the_body);
+    RUN_TEST(test_token_in_a_header_or_cut_answer_is_not_enough);
+    return UNITY_END();
+}
@@ -0,0 +1,187 @@
+// Host tests for the state poll helpers: response fingerprints (fingerprint.h), the
+// adaptive poll interval (poll_cadence.h) and the request hand-off (poll_handoff.h).
+// Run with: pio test -e native
+#include <unity.h>
+#include <vector>
+#include "fingerprint.h"
+#include "poll_cadence.h"
+#include "poll_handoff.h"
+
+// Same field names as the ESPGameAPI records
+struct Range { uint8_t source_id; float min_power; float max_power; };
+struct ProductionCoefficient { uint8_t source_id; float coefficient; };
+struct ConsumptionCoefficient { uint8_t building_id; float consumption; };
+
+void setUp() {}
+void tearDown() {}
+
+static void test_fnv1a_reference_values() {
+    // Published FNV-1a 32-bit vectors
+    TEST_ASSERT_EQUAL_HEX32(0x811C9DC5u, Fingerprint().get());
+    TEST_ASSERT_EQUAL_HEX32(0xE40C292Cu, Fingerprint().addBytes("a", 1).get());
+    TEST_ASSERT_EQUAL_HEX32(0xBF9CF968u, Fingerprint().addBytes("foobar", 6).get());
+}
+
+static void test_ranges_fingerprint_follows_every_field() {
+    std::vector<Range> ranges = {{1, 0.0f, 100.0f}, {4, 50.0f, 300.0f}};
+    const uint32_t base = Fingerprint::ofRanges(ranges);
+    TEST_ASSERT_EQUAL_HEX32(base, Fingerprint::ofRanges(std::vector<Range>(ranges)));
+    TEST_ASSERT_NOT_EQUAL(0u, base);   // 0 means "never fetched" to the poll
+
+    std::vector<Range> changed = ranges;
+    changed[1].max_power = 301.0f;
+    TEST_ASSERT_NOT_EQUAL(base, Fingerprint::ofRanges(changed));
+    changed = ranges;
+    changed[0].min_power = 1.0f;
+    TEST_ASSERT_NOT_EQUAL(base, Fingerprint::ofRanges(changed));
+    changed = ranges;
+    changed[0].source_id = 2;
+    TEST_ASSERT_NOT_EQUAL(base, Fingerprint::ofRanges(changed));
+    changed = ranges;
+    changed.pop_back();
+    TEST_ASSERT_NOT_EQUAL(base, Fingerprint::ofRanges(changed));
+    std::vector<Range> reordered = {ranges[1], ranges[0]};
+    TEST_ASSERT_NOT_EQUAL(base, Fingerprint::ofRanges(reordered));
+}
+
+static void test_coefficient_tables_do_not_alias() {
+    const std::vector<ProductionCoefficient> production = {{1, 0.5f}};
+    const std::vector<ConsumptionCoefficient> consumption = {{1, 0.5f}};
+    const std::vector<ProductionCoefficient> noProduction;
+    const std::vector<ConsumptionCoefficient> noConsumption;
+    // The same bytes in the other table give another fingerprint
+    TEST_ASSERT_NOT_EQUAL(Fingerprint::ofCoefficients(production, noConsumption),
+                          Fingerprint::ofCoefficients(noProduction, consumption));
+
+    std::vector<ProductionCoefficient> changed = production;
+    changed[0].coefficient = 0.51f;
+    TEST_ASSERT_NOT_EQUAL(Fingerprint::ofCoefficients(production, consumption),
+                          Fingerprint::ofCoefficients(changed, consumption));
+    TEST_ASSERT_EQUAL_HEX32(Fingerprint::ofCoefficients(production, consumption),
+                            Fingerprint::ofCoefficients(production, consumption));
+}
+
+// min 1 s, base 5 s, max 20 s, step 1 s, idle 30 s, burst 15 s
+static PollCadence makeCadence() { return PollCadence(1000, 5000, 20000, 1000, 30000, 15000); }
+
+static void test_cadence_idle_and_burst() {
+    PollCadence cadence = makeCadence();
+    TEST_ASSERT_EQUAL_UINT32(30000, cadence.intervalMs(0));
+    cadence.setGameActive(true, 1000);
+    TEST_ASSERT_TRUE(cadence.isBursting());
+    TEST_ASSERT_EQUAL_UINT32(1000, cadence.intervalMs(15999));
+    TEST_ASSERT_EQUAL_UINT32(5000, cadence.intervalMs(16000));
+    TEST_ASSERT_FALSE(cadence.isBursting());
+
+    cadence.setGameActive(false, 20000);   // game end bursts too, then idles
+    TEST_ASSERT_EQUAL_UINT32(1000, cadence.intervalMs(20000));
+    TEST_ASSERT_EQUAL_UINT32(30000, cadence.intervalMs(35000));
+
+    cadence.setGameActive(false, 40000);   // no flip, no burst
+    TEST_ASSERT_FALSE(cadence.isBursting());
+}
+
+static void test_cadence_adapts_to_changes() {
+    PollCadence cadence = makeCadence();
+    cadence.setGameActive(true, 0);
+    const unsigned long later = 100000;
+    cadence.onCycle(true);
+    TEST_ASSERT_EQUAL_UINT32(2500, cadence.intervalMs(later));
+    cadence.onCycle(true);
+    cadence.onCycle(true);
+    TEST_ASSERT_EQUAL_UINT32(1000, cadence.intervalMs(later));   // floor at min
+    for (int i = 0; i < 40; i++) cadence.onCycle(false);
+    TEST_ASSERT_EQUAL_UINT32(20000, cadence.intervalMs(later));  // ceiling at max
+
+    cadence.setGameActive(false, later);
+    cadence.setGameActive(true, later);
+    TEST_ASSERT_EQUAL_UINT32(5000, cadence.getActiveIntervalMs()); // new game starts at base
+}
+
+static void test_cadence_burst_survives_millis_wrap() {
+    PollCadence cadence = makeCadence();
+    const unsigned long start = static_cast<unsigned long>(-1) - 5000;   // millis() about to wrap
+    cadence.setGameActive(true, start);
+    TEST_ASSERT_EQUAL_UINT32(1000, cadence.intervalMs(start + 10000));  // wrapped, still in burst
+    TEST_ASSERT_EQUAL_UINT32(5000, cadence.intervalMs(start + 15000));
+}
+
+static void test_handoff_answer_round_trip() {
+    PollHandoff handoff;
+    TEST_ASSERT_EQUAL_UINT8(POLL_IDLE, handoff.stage());
+    const PollHandoff::Ticket ticket = handoff.begin(POLL_RANGES);
+    TEST_ASSERT_TRUE(handoff.inFlight());
+    TEST_ASSERT_TRUE(handoff.claim(ticket));
+    TEST_ASSERT_EQUAL_UINT8(POLL_RECEIVING, handoff.stage());
+    TEST_ASSERT_FALSE(handoff.claim(ticket));      // one answer per request
+    handoff.publish(ticket);
+    TEST_ASSERT_EQUAL_UINT8(POLL_ANSWERED, handoff.stage());
+    uint8_t stage;
+    TEST_ASSERT_FALSE(handoff.abandon(stage));     // answered requests are not timed out
+    handoff.finish();
+    TEST_ASSERT_EQUAL_UINT8(POLL_IDLE, handoff.stage());
+}
+
+static void test_handoff_timeout_drops_late_answer() {
+    PollHandoff handoff;
+    const PollHandoff::Ticket ticket = handoff.begin(POLL_COEFFICIENTS);
+    uint8_t stage = POLL_IDLE;
+    TEST_ASSERT_TRUE(handoff.abandon(stage));
+    TEST_ASSERT_EQUAL_UINT8(POLL_COEFFICIENTS, stage);
+    TEST_ASSERT_EQUAL_UINT8(POLL_IDLE, handoff.stage());
+    TEST_ASSERT_FALSE(handoff.claim(ticket));
+    TEST_ASSERT_EQUAL_UINT8(POLL_IDLE, handoff.stage());
+    TEST_ASSERT_FALSE(handoff.abandon(stage));     // nothing in flight any more
+}
+
+static void test_handoff_late_answer_cannot_claim_newer_request() {
+    // Request A times out, request B of the same stage goes out, then A's callback arrives:
+    // the stage alone would match (ABA), the ticket does not
+    PollHandoff handoff;
+    const PollHandoff::Ticket first = handoff.begin(POLL_RANGES);
+    uint8_t stage;
+    TEST_ASSERT_TRUE(handoff.abandon(stage));
+    const PollHandoff::Ticket second = handoff.begin(POLL_RANGES);
+    TEST_ASSERT_NOT_EQUAL(first, second);
+    TEST_ASSERT_FALSE(handoff.claim(first));
+    TEST_ASSERT_EQUAL_UINT8(POLL_RANGES, handoff.stage());
+    TEST_ASSERT_TRUE(handoff.claim(second));
+    handoff.publish(second);
+    TEST_ASSERT_EQUAL_UINT8(POLL_ANSWERED, handoff.stage());
+}
+
+static void test_handoff_claim_wins_over_timeout() {
+    PollHandoff handoff;
+    const PollHandoff::Ticket ticket = handoff.begin(POLL_RANGES);
+    TEST_ASSERT_TRUE(handoff.claim(ticket));
+    uint8_t stage;
+    TEST_ASSERT_FALSE(handoff.abandon(stage));
+    TEST_ASSERT_EQUAL_UINT8(POLL_RECEIVING, stage);
+    handoff.publish(ticket);
+    TEST_ASSERT_EQUAL_UINT8(POLL_ANSWERED, handoff.stage());
+}
+
+static void test_handoff_reset_invalidates_tickets() {
+    PollHandoff handoff;
+    const PollHandoff::Ticket ticket = handoff.begin(POLL_RANGES);
+    handoff.reset();
+    const PollHandoff::Ticket next = handoff.begin(POLL_RANGES);
+    TEST_ASSERT_FALSE(handoff.claim(ticket));
+    TEST_ASSERT_TRUE(handoff.claim(next));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_fnv1a_reference_values);
+    RUN_TEST(test_ranges_fingerprint_follows_every_field);
+    RUN_TEST(test_coefficient_tables_do_not_alias);
+    RUN_TEST(test_cadence_idle_and_burst);
+    RUN_TEST(test_cadence_adapts_to_changes);
+    RUN_TEST(test_cadence_burst_survives_millis_wrap);
+    RUN_TEST(test_handoff_answer_round_trip);
+    RUN_TEST(test_handoff_timeout_drops_late_answer);
+    RUN_TEST(test_handoff_late_answer_cannot_claim_newer_request);
+    RUN_TEST(test_handoff_claim_wins_over_timeout);
+    RUN_TEST(test_handoff_reset_invalidates_tickets);
+    return UNITY_END();
+}
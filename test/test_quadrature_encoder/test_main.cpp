@@ -0,0 +1,99 @@
+// Host tests for encoder_input.h: QuadratureEncoder value tracking, driven by the
+// SyntheticQuadratureEncoder decoder that mirrors the PCNT channel setup.
+// Run with: pio test -e native
+#include <unity.h>
+#include "encoder_input.h"
+
+// Counter set directly by the test, for wrap-around checks
+class CountedEncoder : public QuadratureEncoder {
+public:
+    CountedEncoder(long minValue, long maxValue, uint8_t edgesPerStep, int32_t start)
+        : QuadratureEncoder(minValue, maxValue, edgesPerStep), count(start) {
+        resetReference();
+    }
+    int32_t count;
+
+protected:
+    int32_t readCount() override { return count; }
+};
+
+void setUp() {}
+void tearDown() {}
+
+static void test_every_edge_counts_in_both_directions() {
+    SyntheticQuadratureEncoder encoder(0, 1000, 1);
+    encoder.rotate(250);
+    TEST_ASSERT_EQUAL(250, encoder.getValue());
+    encoder.rotate(-100);
+    TEST_ASSERT_EQUAL(150, encoder.getValue());
+    TEST_ASSERT_EQUAL_UINT32(350, encoder.getTotalEdges());
+    TEST_ASSERT_EQUAL_UINT32(0, encoder.getInvalidTransitions());
+}
+
+static void test_sub_step_remainders_are_kept() {
+    SyntheticQuadratureEncoder encoder(0, 1000, 4);
+    for (int i = 0; i < 10; i++) {
+        encoder.rotate(3);
+        encoder.getValue();   // read between every few edges, like the loop does
+    }
+    TEST_ASSERT_EQUAL(7, encoder.getValue());   // 30 edges = 7 steps + 2 edges
+    encoder.rotate(2);
+    TEST_ASSERT_EQUAL(8, encoder.getValue());
+    encoder.rotate(-3);
+    TEST_ASSERT_EQUAL(8, encoder.getValue());   // residual only, no step back yet
+    encoder.rotate(-1);
+    TEST_ASSERT_EQUAL(7, encoder.getValue());
+}
+
+static void test_no_wind_up_past_the_ends() {
+    SyntheticQuadratureEncoder encoder(0, 1000, 1);
+    encoder.rotate(-500);
+    TEST_ASSERT_EQUAL(0, encoder.getValue());
+    encoder.rotate(1);
+    TEST_ASSERT_EQUAL(1, encoder.getValue());   // reversing moves at once
+    encoder.rotate(5000);
+    TEST_ASSERT_EQUAL(1000, encoder.getValue());
+    encoder.rotate(-1);
+    TEST_ASSERT_EQUAL(999, encoder.getValue());
+}
+
+static void test_set_value_takes_the_current_count_as_reference() {
+    SyntheticQuadratureEncoder encoder(0, 1000, 4);
+    encoder.rotate(6);              // one step and a 2-edge remainder
+    encoder.setValue(500);
+    TEST_ASSERT_EQUAL(500, encoder.getValue());
+    encoder.rotate(2);              // the old remainder is gone
+    TEST_ASSERT_EQUAL(500, encoder.getValue());
+    encoder.setValue(2000);
+    TEST_ASSERT_EQUAL(1000, encoder.getValue());
+}
+
+static void test_double_transition_is_ignored() {
+    SyntheticQuadratureEncoder encoder(0, 1000, 1);
+    encoder.setLevels(true, true);  // 00 -> 11: both lines changed, direction unknown
+    TEST_ASSERT_EQUAL(0, encoder.getValue());
+    TEST_ASSERT_EQUAL_UINT32(1, encoder.getInvalidTransitions());
+    encoder.setLevels(false, true); // 11 -> 01: valid, A trails B in the up sequence
+    TEST_ASSERT_EQUAL_UINT32(1, encoder.getInvalidTransitions());
+    TEST_ASSERT_EQUAL(1, encoder.getValue());
+}
+
+static void test_counter_wrap_is_a_small_delta() {
+    CountedEncoder encoder(0, 1000, 1, INT32_MAX - 2);
+    encoder.setValue(500);
+    encoder.count = static_cast<int32_t>(static_cast<uint32_t>(INT32_MAX) + 3u); // +5 edges, wrapped
+    TEST_ASSERT_EQUAL(505, encoder.getValue());
+    encoder.count = INT32_MAX;  // -3 edges back across the wrap
+    TEST_ASSERT_EQUAL(502, encoder.getValue());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_every_edge_counts_in_both_directions);
+    RUN_TEST(test_sub_step_remainders_are_kept);
+    RUN_TEST(test_no_wind_up_past_the_ends);
+    RUN_TEST(test_set_value_takes_the_current_count_as_reference);
+    RUN_TEST(test_double_transition_is_ignored);
+    RUN_TEST(test_counter_wrap_is_a_small_delta);
+    return UNITY_END();
+}
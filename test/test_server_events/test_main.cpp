@@ -0,0 +1,218 @@
+// Host tests for server_events_session.h: the server-push subscription run against a
+// scripted stand-in server on a simulated clock (subscribe, events, silence, reconnect
+// back-off, and the subscribed flag the state poll falls back on). Run with: pio test -e native
+#include <unity.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "server_events_session.h"
+
+static const uint32_t IDLE_MS = 45000;
+static const uint32_t STABLE_MS = 10000;
+static const uint32_t RETRY_MIN_MS = 1000;
+static const uint32_t RETRY_MAX_MS = 8000;
+
+static const char OK_HEADERS[] = "HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\n\r\n";
+
+// One scripted connection: what the server answers and when (ms after connect); it closes at
+// closeAtMs, or never (0) and only goes silent
+struct ServerScript {
+    bool accept = true;
+    struct Chunk {
+        uint32_t atMs;
+        std::string bytes;
+    };
+    std::vector<Chunk> chunks;
+    uint32_t closeAtMs = 0;
+
+    ServerScript& send(uint32_t atMs, const std::string& bytes) {
+        chunks.push_back({atMs, bytes});
+        return *this;
+    }
+    ServerScript& closeAt(uint32_t atMs) {
+        closeAtMs = atMs;
+        return *this;
+    }
+};
+
+// Stand-in server plus simulated board clock; implements the Link interface
+struct FakeServer {
+    std::vector<ServerScript> scripts;   // one per connect, in order
+    size_t nextScript = 0;
+    const ServerScript* current = nullptr;
+    unsigned long clock = 100000;
+    unsigned long connectedAt = 0;
+    std::string buffered;                // due bytes not read yet
+    size_t nextChunk = 0;
+    std::string requests;
+    const ServerEventsSession* session = nullptr;
+    std::vector<std::pair<unsigned long, bool>> subscribedSeen;   // sampled on every delay
+
+    void deliver() {
+        if (!current) return;
+        while (nextChunk < current->chunks.size() && clock - connectedAt >= current->chunks[nextChunk].atMs) {
+            buffered += current->chunks[nextChunk++].bytes;
+        }
+    }
+    bool closed() const {
+        return !current || (current->closeAtMs && clock - connectedAt >= current->closeAtMs);
+    }
+
+    bool connect() {
+        if (nextScript >= scripts.size() || !scripts[nextScript].accept) {
+            nextScript++;
+            return false;
+        }
+        current = &scripts[nextScript++];
+        connectedAt = clock;
+        nextChunk = 0;
+        buffered.clear();
+        return true;
+    }
+    size_t write(const uint8_t* data, size_t len) {
+        requests.append(reinterpret_cast<const char*>(data), len);
+        return len;
+    }
+    int available() {
+        deliver();
+        return static_cast<int>(buffered.size());
+    }
+    int read(uint8_t* buf, size_t size) {
+        deliver();
+        const size_t n = size < buffered.size() ? size : buffered.size();
+        memcpy(buf, buffered.data(), n);
+        buffered.erase(0, n);
+        return n ? static_cast<int>(n) : -1;
+    }
+    bool connected() {
+        deliver();
+        return !buffered.empty() || !closed();
+    }
+    void stop() { current = nullptr; }
+    unsigned long millis() { return clock; }
+    void delay(uint32_t ms) {
+        clock += ms;
+        if (session) subscribedSeen.push_back(std::make_pair(clock, session->isSubscribed()));
+    }
+    bool online() { return true; }
+    void log(const char*) {}
+};
+
+static ServerEventsSession* push;
+
+void setUp() { push = new ServerEventsSession(IDLE_MS, STABLE_MS, RETRY_MIN_MS, RETRY_MAX_MS); }
+void tearDown() { delete push; }
+
+static uint32_t runSession(FakeServer& server) {
+    server.session = push;
+    return push->session(server, "game.local", "/events", 7);
+}
+
+static void test_subscribe_and_receive_events() {
+    FakeServer server;
+    server.scripts.push_back(ServerScript()
+                                 .send(0, OK_HEADERS)
+                                 .send(1000, "event: buildings\ndata: {}\n\n")
+                                 .send(2000, ": keepalive\n\n")
+                                 .send(3000, "event: surprise\ndata: x\n\n")
+                                 .send(4000, "event: game\ndata: start\n\n")
+                                 .closeAt(20000));
+    const uint32_t pause = runSession(server);
+
+    TEST_ASSERT_TRUE(server.requests.find("GET /events?board=7 HTTP/1.0\r\n") == 0);
+    TEST_ASSERT_TRUE(server.requests.find("Host: game.local\r\n") != std::string::npos);
+    TEST_ASSERT_EQUAL_HEX8(ServerEventsSession::INVALIDATE_RANGES | ServerEventsSession::INVALIDATE_COEFFICIENTS |
+                               ServerEventsSession::INVALIDATE_BUILDINGS | ServerEventsSession::INVALIDATE_GAME,
+                           push->takeInvalidations());
+    TEST_ASSERT_EQUAL_HEX8(0, push->takeInvalidations());
+    TEST_ASSERT_EQUAL_UINT32(2, push->getEvents());
+    TEST_ASSERT_EQUAL_UINT32(1, push->getUnknownEvents());
+    TEST_ASSERT_EQUAL_UINT32(1, push->getConnects());
+    TEST_ASSERT_EQUAL_UINT32(0, push->getFailures());            // up 20 s: stable
+    TEST_ASSERT_EQUAL_UINT32(RETRY_MIN_MS, pause);
+    TEST_ASSERT_EQUAL_UINT32(push->getSubscribedAt() + 4000, push->getLastEventAt());
+    TEST_ASSERT_FALSE(push->isSubscribed());
+}
+
+static void test_refusals_back_off_up_to_the_cap() {
+    FakeServer server;
+    server.scripts.push_back(ServerScript());
+    server.scripts.back().accept = false;                        // connection refused
+    server.scripts.push_back(ServerScript().send(0, "HTTP/1.1 404 Not Found\r\n\r\n").closeAt(10));
+    server.scripts.push_back(ServerScript().send(0, "HTTP/1.1 503 Busy\r\n\r\n").closeAt(10));
+    server.scripts.push_back(ServerScript().send(0, "HTTP/1.1 401 Unauthorized\r\n\r\n").closeAt(10));
+
+    TEST_ASSERT_EQUAL_UINT32(2000, runSession(server));
+    TEST_ASSERT_EQUAL_UINT32(4000, runSession(server));
+    TEST_ASSERT_EQUAL_UINT32(8000, runSession(server));
+    TEST_ASSERT_EQUAL_UINT32(8000, runSession(server));
+    TEST_ASSERT_EQUAL_UINT32(4, push->getConnects());
+    TEST_ASSERT_EQUAL_UINT32(4, push->getFailures());
+    TEST_ASSERT_EQUAL_HEX8(0, push->takeInvalidations());        // never subscribed
+}
+
+static void test_accept_and_drop_is_not_stable() {
+    // A server that takes the subscription and drops it at once must not be hit every second
+    FakeServer server;
+    for (int i = 0; i < 3; i++) server.scripts.push_back(ServerScript().send(0, OK_HEADERS).closeAt(500));
+    TEST_ASSERT_EQUAL_UINT32(2000, runSession(server));
+    TEST_ASSERT_EQUAL_UINT32(4000, runSession(server));
+    TEST_ASSERT_EQUAL_UINT32(8000, runSession(server));
+    TEST_ASSERT_EQUAL_UINT32(3, push->getFailures());
+}
+
+static void test_silent_stream_reconnects_and_resets_back_off() {
+    FakeServer server;
+    server.scripts.push_back(ServerScript().send(0, "HTTP/1.1 500 Oops\r\n\r\n").closeAt(10));
+    // Keepalives hold the stream open, then the server hangs without closing
+    server.scripts.push_back(ServerScript().send(0, OK_HEADERS).send(30000, ":\n").send(60000, ":\n"));
+    server.scripts.push_back(ServerScript().send(0, OK_HEADERS).send(100, "event: ranges\ndata:\n\n").closeAt(200));
+
+    TEST_ASSERT_EQUAL_UINT32(2000, runSession(server));
+    const unsigned long startedAt = server.clock;
+    TEST_ASSERT_EQUAL_UINT32(RETRY_MIN_MS, runSession(server));  // up long enough: back-off reset
+    // Ended by the idle timeout after the last keepalive, not by the server
+    TEST_ASSERT_TRUE(server.clock - startedAt >= 60000 + IDLE_MS);
+    TEST_ASSERT_TRUE(server.clock - startedAt < 60000 + IDLE_MS + 100);
+    TEST_ASSERT_EQUAL_UINT32(startedAt + 60000, push->getLastByteAt());
+
+    push->takeInvalidations();
+    TEST_ASSERT_EQUAL_UINT32(2000, runSession(server));          // reconnected, short-lived again
+    TEST_ASSERT_EQUAL_HEX8(ServerEventsSession::INVALIDATE_RANGES | ServerEventsSession::INVALIDATE_COEFFICIENTS,
+                           push->takeInvalidations());
+    TEST_ASSERT_EQUAL_UINT32(3, push->getConnects());
+    TEST_ASSERT_EQUAL_UINT32(2, push->getFailures());
+}
+
+static void test_subscribed_only_while_the_stream_is_up() {
+    // The state poll runs at the slow fallback interval only while isSubscribed(): it has to
+    // drop as soon as the stream does, silence included
+    FakeServer server;
+    server.scripts.push_back(ServerScript().send(0, OK_HEADERS).send(5000, ":\n"));
+    server.session = push;
+    TEST_ASSERT_FALSE(push->isSubscribed());
+    const unsigned long startedAt = server.clock;
+    runSession(server);
+    TEST_ASSERT_FALSE(push->isSubscribed());
+
+    bool seenUp = false;
+    for (const auto& sample : server.subscribedSeen) {
+        const unsigned long at = sample.first - startedAt;
+        if (at <= 5000 + IDLE_MS) {
+            if (sample.second) seenUp = true;
+        } else {
+            TEST_ASSERT_FALSE(sample.second);
+        }
+    }
+    TEST_ASSERT_TRUE(seenUp);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_subscribe_and_receive_events);
+    RUN_TEST(test_refusals_back_off_up_to_the_cap);
+    RUN_TEST(test_accept_and_drop_is_not_stable);
+    RUN_TEST(test_silent_stream_reconnects_and_resets_back_off);
+    RUN_TEST(test_subscribed_only_while_the_stream_is_up);
+    return UNITY_END();
+}
@@ -0,0 +1,120 @@
+// Host tests for sse_parser.h: the event-stream parser behind the server-push subscription.
+// Run with: pio test -e native
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include "sse_parser.h"
+
+static SseParser parser;
+
+// Feed a whole string, return how many events it completed
+static int feed(const char* text) {
+    int events = 0;
+    while (*text) {
+        if (parser.feed(*text++)) events++;
+    }
+    return events;
+}
+
+void setUp() { parser.reset(); }
+void tearDown() {}
+
+static void test_named_event() {
+    TEST_ASSERT_EQUAL_INT(1, feed("event: ranges\ndata: {}\n\n"));
+    TEST_ASSERT_EQUAL_STRING("ranges", parser.getEventName());
+    TEST_ASSERT_EQUAL_STRING("{}", parser.getEventData());
+}
+
+static void test_event_without_name_is_message() {
+    TEST_ASSERT_EQUAL_INT(1, feed("data: hello\n\n"));
+    TEST_ASSERT_EQUAL_STRING("message", parser.getEventName());
+    TEST_ASSERT_EQUAL_STRING("hello", parser.getEventData());
+}
+
+static void test_event_without_data() {
+    TEST_ASSERT_EQUAL_INT(1, feed("event: game\n\n"));
+    TEST_ASSERT_EQUAL_STRING("game", parser.getEventName());
+    TEST_ASSERT_EQUAL_STRING("", parser.getEventData());
+}
+
+static void test_crlf_and_no_space_after_colon() {
+    TEST_ASSERT_EQUAL_INT(1, feed("event:coefficients\r\ndata:x\r\n\r\n"));
+    TEST_ASSERT_EQUAL_STRING("coefficients", parser.getEventName());
+    TEST_ASSERT_EQUAL_STRING("x", parser.getEventData());
+}
+
+static void test_data_lines_are_joined() {
+    TEST_ASSERT_EQUAL_INT(1, feed("data: a\ndata: b\ndata:\n\n"));
+    TEST_ASSERT_EQUAL_STRING("a\nb\n", parser.getEventData());
+}
+
+static void test_keepalives_and_other_fields_are_ignored() {
+    TEST_ASSERT_EQUAL_INT(0, feed(":\n\n: keepalive\n\nid: 7\nretry: 3000\n\n"));
+    TEST_ASSERT_EQUAL_INT(1, feed(": note\nevent: buildings\nid: 8\n\n"));
+    TEST_ASSERT_EQUAL_STRING("buildings", parser.getEventName());
+}
+
+static void test_events_split_across_reads() {
+    // Socket reads end anywhere, including inside a field name or the blank line
+    const char* stream = "event: ranges\n\nevent: game\ndata: end\n\n";
+    int events = 0;
+    for (const char* p = stream; *p; p++) {
+        if (!parser.feed(*p)) continue;
+        events++;
+        TEST_ASSERT_EQUAL_STRING(events == 1 ? "ranges" : "game", parser.getEventName());
+    }
+    TEST_ASSERT_EQUAL_INT(2, events);
+    TEST_ASSERT_EQUAL_STRING("end", parser.getEventData());
+}
+
+static void test_state_does_not_leak_between_events() {
+    TEST_ASSERT_EQUAL_INT(1, feed("event: ranges\ndata: 1\n\n"));
+    TEST_ASSERT_EQUAL_INT(1, feed("data: 2\n\n"));
+    TEST_ASSERT_EQUAL_STRING("message", parser.getEventName());
+    TEST_ASSERT_EQUAL_STRING("2", parser.getEventData());
+}
+
+static void test_overlong_fields_are_truncated() {
+    char text[512];
+    char longName[64];
+    memset(longName, 'n', sizeof(longName) - 1);
+    longName[sizeof(longName) - 1] = '\0';
+    char longData[300];
+    memset(longData, 'd', sizeof(longData) - 1);
+    longData[sizeof(longData) - 1] = '\0';
+
+    snprintf(text, sizeof(text), "event: %s\n\n", longName);
+    TEST_ASSERT_EQUAL_INT(1, feed(text));
+    TEST_ASSERT_EQUAL_size_t(SseParser::MAX_NAME, strlen(parser.getEventName()));
+
+    snprintf(text, sizeof(text), "data: %s\n\n", longData);
+    TEST_ASSERT_EQUAL_INT(1, feed(text));
+    TEST_ASSERT_EQUAL_size_t(SseParser::MAX_DATA, strlen(parser.getEventData()));
+
+    // The parser is still in step afterwards
+    TEST_ASSERT_EQUAL_INT(1, feed("event: ranges\n\n"));
+    TEST_ASSERT_EQUAL_STRING("ranges", parser.getEventName());
+}
+
+static void test_reset_drops_a_partial_event() {
+    TEST_ASSERT_EQUAL_INT(0, feed("event: ranges\ndata: half"));
+    parser.reset();
+    TEST_ASSERT_EQUAL_INT(1, feed("data: whole\n\n"));
+    TEST_ASSERT_EQUAL_STRING("message", parser.getEventName());
+    TEST_ASSERT_EQUAL_STRING("whole", parser.getEventData());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_named_event);
+    RUN_TEST(test_event_without_name_is_message);
+    RUN_TEST(test_event_without_data);
+    RUN_TEST(test_crlf_and_no_space_after_colon);
+    RUN_TEST(test_data_lines_are_joined);
+    RUN_TEST(test_keepalives_and_other_fields_are_ignored);
+    RUN_TEST(test_events_split_across_reads);
+    RUN_TEST(test_state_does_not_leak_between_events);
+    RUN_TEST(test_overlong_fields_are_truncated);
+    RUN_TEST(test_reset_drops_a_partial_event);
+    return UNITY_END();
+}
@@ -0,0 +1,121 @@
+// Host tests for storage_integrator.h. Run with: pio test -e native
+#include <unity.h>
+#include "storage_integrator.h"
+
+static const uint16_t STEP = StorageIntegrator::STEP_MS;
+
+void setUp() {}
+void tearDown() {}
+
+static void test_one_advance_equals_single_steps() {
+    StorageIntegrator batched(0.5f);
+    StorageIntegrator stepped(0.5f);
+    batched.configure(100.0f, 1);
+    stepped.configure(100.0f, 1);
+    batched.setPower(-250.0f);
+    stepped.setPower(-250.0f);
+    batched.advance(0);
+    stepped.advance(0);
+
+    TEST_ASSERT_EQUAL_UINT32(50, batched.advance(50 * STEP));
+    for (unsigned long t = STEP; t <= 50ul * STEP; t += STEP) stepped.advance(t);
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, stepped.getSoc(), batched.getSoc());
+    // 250 W into 100 Wh for 5 s
+    TEST_ASSERT_FLOAT_WITHIN(1e-5f, 0.5f + 250.0f * 5.0f / 3600.0f / 100.0f, batched.getSoc());
+}
+
+static void test_sub_step_remainder_carries_over() {
+    StorageIntegrator storage(0.5f);
+    storage.configure(100.0f, 1);
+    storage.setPower(100.0f);
+    storage.advance(0);
+    TEST_ASSERT_EQUAL_UINT32(0, storage.advance(STEP - 1));
+    TEST_ASSERT_EQUAL_UINT32(1, storage.advance(STEP + 40));
+    TEST_ASSERT_EQUAL_UINT32(1, storage.advance(2 * STEP));   // 60 + 40 ms left over
+    TEST_ASSERT_EQUAL_UINT32(2, storage.getSteps());
+}
+
+static void test_clamps_at_empty_and_full() {
+    StorageIntegrator storage(0.1f);
+    storage.configure(1.0f, 2);
+    storage.setPower(1000.0f);
+    storage.advance(0);
+    storage.advance(100 * STEP);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, storage.getSoc());
+    TEST_ASSERT_EQUAL(StorageIntegrator::BOUNDARY_EMPTY, storage.getBoundary());
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, storage.limitPower(50.0f));
+    TEST_ASSERT_EQUAL_FLOAT(-50.0f, storage.limitPower(-50.0f));
+
+    storage.setPower(-1000.0f);
+    storage.advance(200 * STEP);
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, storage.getSoc());
+    TEST_ASSERT_EQUAL(StorageIntegrator::BOUNDARY_FULL, storage.getBoundary());
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, storage.limitPower(-50.0f));
+    TEST_ASSERT_EQUAL_FLOAT(50.0f, storage.limitPower(50.0f));
+    TEST_ASSERT_EQUAL_FLOAT(2.0f, storage.getEnergyWh());
+}
+
+static void test_long_gaps_are_capped() {
+    StorageIntegrator storage(0.5f);
+    storage.configure(100.0f, 1);
+    storage.setPower(10.0f);
+    storage.advance(0);
+    const uint32_t n = storage.advance(30000);  // 300 steps
+    TEST_ASSERT_EQUAL_UINT32(StorageIntegrator::MAX_STEPS_PER_ADVANCE, n);
+    TEST_ASSERT_EQUAL_UINT32(300 - StorageIntegrator::MAX_STEPS_PER_ADVANCE, storage.getDroppedSteps());
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.5f - 10.0f * 10.0f / 3600.0f / 100.0f, storage.getSoc());
+}
+
+static void test_soc_does_not_depend_on_unit_count() {
+    StorageIntegrator one(0.5f);
+    StorageIntegrator four(0.5f);
+    one.configure(50.0f, 1);
+    four.configure(50.0f, 4);
+    one.setPower(120.0f);
+    four.setPower(120.0f);
+    one.advance(0);
+    four.advance(0);
+    one.advance(3000);
+    four.advance(3000);
+    TEST_ASSERT_EQUAL_FLOAT(one.getSoc(), four.getSoc());
+    TEST_ASSERT_EQUAL_FLOAT(4.0f * one.getEnergyWh(), four.getEnergyWh());
+}
+
+static void test_unconfigured_or_idle_keeps_soc() {
+    StorageIntegrator storage(0.3f);
+    storage.setPower(100.0f);
+    storage.advance(0);
+    storage.advance(5000);
+    TEST_ASSERT_EQUAL_FLOAT(0.3f, storage.getSoc());   // no capacity
+    TEST_ASSERT_EQUAL_FLOAT(100.0f, storage.limitPower(100.0f));
+
+    storage.configure(10.0f, 1);
+    storage.setPower(0.0f);
+    storage.advance(10000);
+    TEST_ASSERT_EQUAL_FLOAT(0.3f, storage.getSoc());
+}
+
+static void test_reset_restarts_from_initial_soc() {
+    StorageIntegrator storage(2.0f);   // clamped to full
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, storage.getSoc());
+    storage.configure(10.0f, 1);
+    storage.setPower(100.0f);
+    storage.advance(1000);
+    storage.advance(2000);
+    TEST_ASSERT_TRUE(storage.getSoc() < 1.0f);
+    storage.reset();
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, storage.getSoc());
+    TEST_ASSERT_EQUAL_UINT32(0, storage.advance(50000));   // first call after reset only starts
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_one_advance_equals_single_steps);
+    RUN_TEST(test_sub_step_remainder_carries_over);
+    RUN_TEST(test_clamps_at_empty_and_full);
+    RUN_TEST(test_long_gaps_are_capped);
+    RUN_TEST(test_soc_does_not_depend_on_unit_count);
+    RUN_TEST(test_unconfigured_or_idle_keeps_soc);
+    RUN_TEST(test_reset_restarts_from_initial_soc);
+    return UNITY_END();
+}
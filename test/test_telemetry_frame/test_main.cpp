@@ -0,0 +1,138 @@
+// Host tests for telemetry_frame.h: the wire layout of the live-telemetry WebSocket frames
+// and a client that follows a stream of key and delta frames. Run with: pio test -e native
+#include <unity.h>
+#include "telemetry_frame.h"
+
+typedef TelemetrySnapshot S;
+
+static uint32_t le32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | static_cast<uint32_t>(p[1]) << 8 | static_cast<uint32_t>(p[2]) << 16 |
+           static_cast<uint32_t>(p[3]) << 24;
+}
+
+static uint64_t le64(const uint8_t* p) {
+    return le32(p) | static_cast<uint64_t>(le32(p + 4)) << 32;
+}
+
+static S sample() {
+    S s;
+    s.fields[S::FIELD_PRODUCTION] = 12345;
+    s.fields[S::FIELD_TYPE_POWER + 7] = -2500;   // battery charging
+    s.fields[S::FIELD_WIFI_RSSI] = -67;
+    s.fields[S::FIELD_MISSED_PERIODS] = 7;
+    s.fields[S::FIELD_STATUS_MS] = 180;
+    s.fields[S::FIELD_REQUEST_FAILURES] = 3;
+    return s;
+}
+
+void setUp() {}
+void tearDown() {}
+
+static void test_key_frame_layout() {
+    const S s = sample();
+    uint8_t frame[TelemetryFrame::MAX_SIZE];
+    const size_t len = TelemetryFrame::encode(s, nullptr, 5, 1000, frame);
+    TEST_ASSERT_EQUAL_size_t(20 + 4 * S::FIELD_COUNT, len);
+    TEST_ASSERT_EQUAL_HEX8('E', frame[0]);
+    TEST_ASSERT_EQUAL_HEX8('A', frame[1]);
+    TEST_ASSERT_EQUAL_HEX8(2, frame[2]);
+    TEST_ASSERT_EQUAL_HEX8(TelemetryFrame::KIND_KEY, frame[3]);
+    TEST_ASSERT_EQUAL_UINT32(5, le32(frame + 4));
+    TEST_ASSERT_EQUAL_UINT32(1000, le32(frame + 8));
+    TEST_ASSERT_TRUE(le64(frame + 12) == TelemetryFrame::ALL_FIELDS);
+    TEST_ASSERT_EQUAL_HEX32(0xFFFFFFFFu, le32(frame + 12));
+    TEST_ASSERT_EQUAL_HEX32((1u << (S::FIELD_COUNT - 32)) - 1, le32(frame + 16));
+    TEST_ASSERT_EQUAL_INT32(12345, (int32_t)le32(frame + 20));
+    TEST_ASSERT_EQUAL_INT32(-67, (int32_t)le32(frame + 20 + 4 * S::FIELD_WIFI_RSSI));
+    TEST_ASSERT_EQUAL_INT32(3, (int32_t)le32(frame + 20 + 4 * S::FIELD_REQUEST_FAILURES));
+}
+
+static void test_delta_carries_changed_fields_only() {
+    const S a = sample();
+    S b = a;
+    b.fields[S::FIELD_CONSUMPTION] = 900;
+    b.fields[S::FIELD_WIFI_RSSI] = -70;
+    b.fields[S::FIELD_POLL_P99_MS] = 420;                        // above bit 31
+    uint8_t frame[TelemetryFrame::MAX_SIZE];
+    size_t len = TelemetryFrame::encode(b, &a, 6, 1100, frame);
+    TEST_ASSERT_EQUAL_size_t(20 + 3 * 4, len);
+    TEST_ASSERT_EQUAL_HEX8(TelemetryFrame::KIND_DELTA, frame[3]);
+    TEST_ASSERT_TRUE(le64(frame + 12) == ((1ull << S::FIELD_CONSUMPTION) | (1ull << S::FIELD_WIFI_RSSI) |
+                                          (1ull << S::FIELD_POLL_P99_MS)));
+    TEST_ASSERT_EQUAL_INT32(900, (int32_t)le32(frame + 20));     // ascending field order
+    TEST_ASSERT_EQUAL_INT32(-70, (int32_t)le32(frame + 24));
+    TEST_ASSERT_EQUAL_INT32(420, (int32_t)le32(frame + 28));
+
+    len = TelemetryFrame::encode(b, &b, 7, 1200, frame);         // heartbeat
+    TEST_ASSERT_EQUAL_size_t(20, len);
+    TEST_ASSERT_TRUE(le64(frame + 12) == 0);
+}
+
+static void test_client_follows_a_stream() {
+    S server = sample();
+    S baseline;
+    S client;
+    uint8_t frame[TelemetryFrame::MAX_SIZE];
+    TelemetryFrame::Header header;
+
+    size_t len = TelemetryFrame::encode(server, nullptr, 0, 0, frame);
+    TEST_ASSERT_TRUE(TelemetryFrame::decode(frame, len, client, &header));
+    TEST_ASSERT_EQUAL_HEX8(TelemetryFrame::KIND_KEY, header.kind);
+    baseline = server;
+
+    for (uint32_t seq = 1; seq < 200; seq++) {
+        // A few fields move every frame, some not at all
+        server.fields[seq % S::FIELD_COUNT] += static_cast<int32_t>(seq * 37) - 3000;
+        if (seq % 7 == 0) server.fields[S::FIELD_LINK_FLAGS] ^= S::LINK_SERVER;
+        len = TelemetryFrame::encode(server, &baseline, seq, seq * 100, frame);
+        baseline = server;
+        TEST_ASSERT_TRUE(TelemetryFrame::decode(frame, len, client, &header));
+        TEST_ASSERT_EQUAL_UINT32(seq, header.sequence);
+        TEST_ASSERT_EQUAL_UINT32(seq * 100, header.uptimeMs);
+        TEST_ASSERT_TRUE(client.diff(server) == 0);
+    }
+}
+
+static void test_malformed_frames_are_rejected() {
+    const S s = sample();
+    S client;
+    uint8_t frame[TelemetryFrame::MAX_SIZE];
+    const size_t len = TelemetryFrame::encode(s, nullptr, 1, 1, frame);
+
+    uint8_t bad[TelemetryFrame::MAX_SIZE];
+    memcpy(bad, frame, len);
+    bad[0] = 'X';
+    TEST_ASSERT_FALSE(TelemetryFrame::decode(bad, len, client));
+    memcpy(bad, frame, len);
+    bad[2] = 1;                                       // old version
+    TEST_ASSERT_FALSE(TelemetryFrame::decode(bad, len, client));
+    memcpy(bad, frame, len);
+    bad[3] = 9;                                       // unknown kind
+    TEST_ASSERT_FALSE(TelemetryFrame::decode(bad, len, client));
+    TEST_ASSERT_FALSE(TelemetryFrame::decode(frame, len - 4, client));   // truncated
+    TEST_ASSERT_FALSE(TelemetryFrame::decode(frame, 10, client));
+    memcpy(bad, frame, len);
+    bad[12] = 0xFE;                                   // key frame missing a field
+    TEST_ASSERT_FALSE(TelemetryFrame::decode(bad, len - 4, client));
+    memcpy(bad, frame, len);
+    bad[19] = 0x80;                                   // mask bit past the last field
+    TEST_ASSERT_FALSE(TelemetryFrame::decode(bad, len, client));
+    TEST_ASSERT_TRUE(client.diff(S()) == 0);          // nothing applied
+}
+
+static void test_scaled_rounds_half_away_from_zero() {
+    TEST_ASSERT_EQUAL_INT32(-13, S::scaled(-1.26f, 10.0f));
+    TEST_ASSERT_EQUAL_INT32(13, S::scaled(1.26f, 10.0f));
+    TEST_ASSERT_EQUAL_INT32(500, S::scaled(0.5004f, 1000.0f));
+    TEST_ASSERT_EQUAL_INT32(0, S::scaled(0.04f, 10.0f));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_key_frame_layout);
+    RUN_TEST(test_delta_carries_changed_fields_only);
+    RUN_TEST(test_client_follows_a_stream);
+    RUN_TEST(test_malformed_frames_are_rejected);
+    RUN_TEST(test_scaled_rounds_half_away_from_zero);
+    return UNITY_END();
+}
@@ -0,0 +1,133 @@
+// Host tests for telemetry_journal.h: the outage ring, the backfill step against a fake
+// uploader and the acknowledgement of delivered records. Run with: pio test -e native
+#include <unity.h>
+#include <string.h>
+#include <vector>
+#include "telemetry_journal.h"
+
+typedef TelemetryJournal<8> Journal;
+
+static JournalRecord record(uint32_t endMs) {
+    JournalRecord r;
+    r.endMs = endMs;
+    r.durationMs = 10000;
+    r.productionMean = endMs / 1000.0f;
+    r.productionMax = endMs / 500.0f;
+    r.consumptionMean = 42.5f;
+    return r;
+}
+
+// Stand-in for the HTTP uploader: records what it was sent, fails on demand and can run
+// code "while the request is in flight" (the loop task journaling meanwhile)
+struct FakeUploader {
+    bool accept = true;
+    std::vector<uint32_t> sentEndMs;
+    std::vector<uint32_t> sentAt;
+    Journal* journal = nullptr;
+    uint16_t pushWhileSending = 0;
+    uint32_t nextEndMs = 0;
+
+    bool send(const JournalRecord* records, uint16_t count, uint32_t now) {
+        for (uint16_t i = 0; i < count; i++) {
+            sentEndMs.push_back(records[i].endMs);
+            sentAt.push_back(now);
+        }
+        for (uint16_t i = 0; i < pushWhileSending && journal; i++) journal->push(record(nextEndMs += 10000));
+        return accept;
+    }
+};
+
+static std::mutex journalMutex;
+
+void setUp() {}
+void tearDown() {}
+
+static void test_ring_keeps_the_most_recent_records() {
+    Journal journal;
+    for (uint32_t i = 1; i <= 10; i++) journal.push(record(i * 10000));
+    TEST_ASSERT_EQUAL_UINT16(8, journal.size());
+    TEST_ASSERT_EQUAL_UINT32(2, journal.getDropped());
+    TEST_ASSERT_EQUAL_UINT32(10, journal.getRecorded());
+    JournalRecord oldest;
+    uint32_t sequence;
+    TEST_ASSERT_EQUAL_UINT16(1, journal.peek(&oldest, 1, &sequence));
+    TEST_ASSERT_EQUAL_UINT32(30000, oldest.endMs);
+    TEST_ASSERT_EQUAL_UINT32(2, sequence);
+}
+
+static void test_replay_delivers_in_order_and_acks() {
+    Journal journal;
+    for (uint32_t i = 1; i <= 7; i++) journal.push(record(i * 10000));
+    FakeUploader uploader;
+    TEST_ASSERT_EQUAL_INT(3, (replayJournalBatch<3>(journal, journalMutex, uploader, 100000)));
+    TEST_ASSERT_EQUAL_UINT16(4, journal.size());
+    TEST_ASSERT_EQUAL_INT(3, (replayJournalBatch<3>(journal, journalMutex, uploader, 101000)));
+    TEST_ASSERT_EQUAL_INT(1, (replayJournalBatch<3>(journal, journalMutex, uploader, 102000)));
+    TEST_ASSERT_EQUAL_INT(0, (replayJournalBatch<3>(journal, journalMutex, uploader, 103000)));
+    TEST_ASSERT_TRUE(journal.empty());
+    TEST_ASSERT_EQUAL_size_t(7, uploader.sentEndMs.size());
+    for (uint32_t i = 0; i < 7; i++) TEST_ASSERT_EQUAL_UINT32((i + 1) * 10000, uploader.sentEndMs[i]);
+}
+
+static void test_failed_send_keeps_the_batch() {
+    Journal journal;
+    for (uint32_t i = 1; i <= 4; i++) journal.push(record(i * 10000));
+    FakeUploader uploader;
+    uploader.accept = false;
+    TEST_ASSERT_EQUAL_INT(-1, (replayJournalBatch<3>(journal, journalMutex, uploader, 50000)));
+    TEST_ASSERT_EQUAL_UINT16(4, journal.size());
+    uploader.accept = true;
+    uploader.sentEndMs.clear();
+    TEST_ASSERT_EQUAL_INT(3, (replayJournalBatch<3>(journal, journalMutex, uploader, 60000)));
+    TEST_ASSERT_EQUAL_UINT32(10000, uploader.sentEndMs[0]);   // the same records again
+    TEST_ASSERT_EQUAL_UINT16(1, journal.size());
+}
+
+static void test_ack_after_overwrite_keeps_undelivered_records() {
+    // The ring is full and the loop keeps journaling while a batch is in flight: the records
+    // that pushed the batch out must not be acknowledged in its place
+    Journal journal;
+    for (uint32_t i = 1; i <= 8; i++) journal.push(record(i * 10000));
+    FakeUploader uploader;
+    uploader.journal = &journal;
+    uploader.pushWhileSending = 2;
+    uploader.nextEndMs = 80000;
+    TEST_ASSERT_EQUAL_INT(3, (replayJournalBatch<3>(journal, journalMutex, uploader, 90000)));
+    // Records 1 and 2 were overwritten (counted dropped), record 3 was delivered and removed
+    TEST_ASSERT_EQUAL_UINT32(2, journal.getDropped());
+    TEST_ASSERT_EQUAL_UINT16(7, journal.size());
+    JournalRecord oldest;
+    journal.peek(&oldest, 1);
+    TEST_ASSERT_EQUAL_UINT32(40000, oldest.endMs);
+
+    uploader.pushWhileSending = 0;
+    uploader.sentEndMs.clear();
+    while (replayJournalBatch<3>(journal, journalMutex, uploader, 100000) > 0) {}
+    TEST_ASSERT_EQUAL_size_t(7, uploader.sentEndMs.size());
+    TEST_ASSERT_EQUAL_UINT32(40000, uploader.sentEndMs.front());
+    TEST_ASSERT_EQUAL_UINT32(100000, uploader.sentEndMs.back());
+}
+
+static void test_batch_body_carries_record_ages() {
+    JournalRecord records[2] = {record(10000), record(20000)};
+    char body[512];
+    const size_t len = formatJournalBatch(records, 2, 3, 25000, body, sizeof(body));
+    TEST_ASSERT_EQUAL_size_t(strlen(body), len);
+    TEST_ASSERT_EQUAL_STRING("{\"board\":3,\"records\":["
+                             "{\"age_ms\":15000,\"duration_ms\":10000,\"production_mean\":10.00,"
+                             "\"production_max\":20.00,\"consumption_mean\":42.50},"
+                             "{\"age_ms\":5000,\"duration_ms\":10000,\"production_mean\":20.00,"
+                             "\"production_max\":40.00,\"consumption_mean\":42.50}]}",
+                             body);
+    TEST_ASSERT_EQUAL_size_t(0, formatJournalBatch(records, 2, 3, 25000, body, 64));   // too small
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_ring_keeps_the_most_recent_records);
+    RUN_TEST(test_replay_delivers_in_order_and_acks);
+    RUN_TEST(test_failed_send_keeps_the_batch);
+    RUN_TEST(test_ack_after_overwrite_keeps_undelivered_records);
+    RUN_TEST(test_batch_body_carries_record_ages);
+    return UNITY_END();
+}
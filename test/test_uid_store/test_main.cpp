@@ -0,0 +1,122 @@
+// Host tests for uid_store.h: UID text parsing/formatting round trips and the interned table.
+// Run with: pio test -e native
+#include <unity.h>
+#include <string.h>
+#include "uid_store.h"
+
+void setUp() {}
+void tearDown() {}
+
+static void assertRoundTrip(const char* text) {
+    RawUid uid;
+    uint8_t format;
+    TEST_ASSERT_TRUE_MESSAGE(UidStore::parse(text, strlen(text), uid, format), text);
+    char out[UidStore::MAX_TEXT_LEN + 1];
+    const size_t len = UidStore::format(uid, format, out, sizeof(out));
+    TEST_ASSERT_EQUAL_size_t(strlen(text), len);
+    TEST_ASSERT_EQUAL_STRING(text, out);
+}
+
+static void test_round_trip_keeps_text_style() {
+    assertRoundTrip("04A1B2C3");
+    assertRoundTrip("04a1b2c3");
+    assertRoundTrip("04:A1:B2:C3");
+    assertRoundTrip("04 a1 b2 c3");
+    assertRoundTrip("04-A1-B2-C3-D4-E5-F6");
+    assertRoundTrip("0102030405060708090A");
+    assertRoundTrip("01:02:03:04:05:06:07:08:09:0a");
+}
+
+static void test_parse_reads_bytes() {
+    RawUid uid;
+    uint8_t format;
+    TEST_ASSERT_TRUE(UidStore::parse("04:a1:B2:c3", 11, uid, format));
+    TEST_ASSERT_EQUAL_UINT8(4, uid.len);
+    const uint8_t expected[] = {0x04, 0xA1, 0xB2, 0xC3};
+    TEST_ASSERT_EQUAL_MEMORY(expected, uid.bytes, 4);
+    TEST_ASSERT_EQUAL_UINT8(':' | UidStore::FORMAT_LOWERCASE, format);
+}
+
+static void test_parse_rejects_invalid_text() {
+    const char* invalid[] = {
+        "",                 // empty
+        "04A1B2",           // 3 bytes
+        "04A1B2C3D4",       // 5 bytes
+        "04A1B2C",          // odd digit count
+        "04A1B2CG",         // not hex
+        "04:A1-B2:C3",      // mixed separators
+        "04:A1B2C3",        // separator only once
+        "04_A1_B2_C3",      // unknown separator
+        "0102030405060708090A0B", // 11 bytes
+    };
+    for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); i++) {
+        RawUid uid;
+        uint8_t format;
+        TEST_ASSERT_FALSE_MESSAGE(UidStore::parse(invalid[i], strlen(invalid[i]), uid, format), invalid[i]);
+    }
+    RawUid uid;
+    uint8_t format;
+    TEST_ASSERT_FALSE(UidStore::parse(nullptr, 0, uid, format));
+}
+
+static void test_format_needs_room_for_terminator() {
+    RawUid uid;
+    uint8_t format;
+    TEST_ASSERT_TRUE(UidStore::parse("04A1B2C3", 8, uid, format));
+    char out[9];
+    TEST_ASSERT_EQUAL_size_t(0, UidStore::format(uid, format, out, 8));
+    TEST_ASSERT_EQUAL_size_t(8, UidStore::format(uid, format, out, 9));
+}
+
+static void test_intern_find_and_text() {
+    UidStore store;
+    const UidHandle handle = store.intern("04:a1:b2:c3", 11, 7);
+    TEST_ASSERT_TRUE(store.isValid(handle));
+    TEST_ASSERT_EQUAL_UINT8(7, store.getBuildingType(handle));
+    // Same UID in another style finds the same entry
+    TEST_ASSERT_EQUAL_UINT8(handle, store.find("04A1B2C3", 8));
+    // Re-interning updates the type, not the count
+    TEST_ASSERT_EQUAL_UINT8(handle, store.intern("04:a1:b2:c3", 11, 9));
+    TEST_ASSERT_EQUAL_UINT8(1, store.size());
+    TEST_ASSERT_EQUAL_UINT8(9, store.getBuildingType(handle));
+
+    char out[UidStore::MAX_TEXT_LEN + 1];
+    TEST_ASSERT_EQUAL_size_t(11, store.toText(handle, out, sizeof(out)));
+    TEST_ASSERT_EQUAL_STRING("04:a1:b2:c3", out);
+
+    TEST_ASSERT_TRUE(store.release(handle));
+    TEST_ASSERT_EQUAL_UINT8(UidStore::INVALID, store.find("04A1B2C3", 8));
+    TEST_ASSERT_FALSE(store.release(handle));
+    TEST_ASSERT_EQUAL_UINT8(0, store.size());
+}
+
+static void test_capacity_and_rejects() {
+    UidStore store;
+    RawUid uid;
+    memset(&uid, 0, sizeof(uid));
+    uid.len = 7;
+    for (unsigned i = 0; i < UidStore::CAPACITY; i++) {
+        uid.bytes[0] = static_cast<uint8_t>(i);
+        TEST_ASSERT_NOT_EQUAL(UidStore::INVALID, store.intern(uid, 1));
+    }
+    TEST_ASSERT_EQUAL_UINT8(UidStore::CAPACITY, store.size());
+    uid.bytes[1] = 0xFF;
+    TEST_ASSERT_EQUAL_UINT8(UidStore::INVALID, store.intern(uid, 1));
+    TEST_ASSERT_EQUAL_UINT8(UidStore::INVALID, store.intern("nope", 4, 1));
+    TEST_ASSERT_EQUAL_UINT32(2, store.getRejectedCount());
+
+    // A released slot is reused
+    TEST_ASSERT_TRUE(store.release(5));
+    TEST_ASSERT_EQUAL_UINT8(5, store.intern(uid, 1));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_round_trip_keeps_text_style);
+    RUN_TEST(test_parse_reads_bytes);
+    RUN_TEST(test_parse_rejects_invalid_text);
+    RUN_TEST(test_format_needs_room_for_terminator);
+    RUN_TEST(test_intern_find_and_text);
+    RUN_TEST(test_capacity_and_rejects);
+    return UNITY_END();
+}
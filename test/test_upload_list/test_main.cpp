@@ -0,0 +1,130 @@
+// Host tests for upload_list.h: refilling the ESP-API upload lists must not allocate, and
+// entries past the capacity are counted.
+// Run with: pio test -e native
+#include <unity.h>
+#include <new>
+#include <stdlib.h>
+#include "upload_list.h"
+
+// Count every heap allocation made by the test binary
+static size_t allocations = 0;
+
+void* operator new(size_t size) {
+    allocations++;
+    void* p = malloc(size ? size : 1);
+    if (!p) abort();
+    return p;
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+struct Plant {
+    uint16_t id;
+    float power;
+};
+
+void setUp() {}
+void tearDown() {}
+
+static void test_refill_does_not_allocate() {
+    UploadList<Plant> list(8);
+    const size_t before = allocations;
+    for (int upload = 0; upload < 1000; upload++) {
+        list.clear();
+        for (uint16_t type = 1; type <= 8; type++) list.push({type, upload * 1.5f});
+    }
+    TEST_ASSERT_EQUAL_size_t(0, allocations - before);
+    TEST_ASSERT_EQUAL_size_t(8, list.size());
+    TEST_ASSERT_EQUAL_UINT16(8, list.get()[7].id);
+}
+
+static void test_overflow_drops_instead_of_growing() {
+    UploadList<Plant> list(4);
+    const size_t capacity = list.capacity();
+    const size_t before = allocations;
+    for (uint16_t i = 0; i < capacity + 3; i++) list.push({i, 0.0f});
+    TEST_ASSERT_EQUAL_size_t(0, allocations - before);
+    TEST_ASSERT_EQUAL_size_t(capacity, list.size());
+    TEST_ASSERT_EQUAL_size_t(capacity, list.capacity());
+    TEST_ASSERT_EQUAL_UINT32(3, list.getDropped());
+    TEST_ASSERT_FALSE(list.push({99, 0.0f}));
+}
+
+static void test_clear_keeps_storage() {
+    UploadList<Plant> list(16);
+    list.push({1, 2.0f});
+    const Plant* storage = list.get().data();
+    list.clear();
+    TEST_ASSERT_EQUAL_size_t(0, list.size());
+    list.push({2, 3.0f});
+    TEST_ASSERT_TRUE(storage == list.get().data());
+}
+
+struct Consumer {
+    uint32_t id;
+};
+
+static Consumer consumerForType(size_t type) { return {static_cast<uint32_t>(type)}; }
+
+static void test_fill_from_counts_lists_every_unit() {
+    std::array<uint16_t, 256> counts;
+    counts.fill(0);
+    counts[3] = 2;
+    counts[200] = 1;
+    UploadList<Consumer> list(8);
+    const size_t before = allocations;
+    fillFromCounts(list, counts, consumerForType);
+    TEST_ASSERT_EQUAL_size_t(0, allocations - before);
+    TEST_ASSERT_EQUAL_size_t(3, list.size());
+    TEST_ASSERT_EQUAL_UINT32(3, list.get()[0].id);
+    TEST_ASSERT_EQUAL_UINT32(3, list.get()[1].id);
+    TEST_ASSERT_EQUAL_UINT32(200, list.get()[2].id);
+    TEST_ASSERT_EQUAL_UINT32(0, list.getFillDropped());
+}
+
+static void test_fill_from_counts_counts_every_dropped_unit() {
+    std::array<uint16_t, 256> counts;
+    counts.fill(0);
+    counts[1] = 100;
+    counts[2] = 50;
+    counts[255] = 7;
+    UploadList<Consumer> list(128);
+    fillFromCounts(list, counts, consumerForType);
+    TEST_ASSERT_EQUAL_size_t(128, list.size());
+    TEST_ASSERT_EQUAL_UINT32(2, list.get()[127].id);
+    TEST_ASSERT_EQUAL_UINT32(157 - 128, list.getFillDropped());
+
+    // The per-fill count restarts, the total keeps growing
+    fillFromCounts(list, counts, consumerForType);
+    TEST_ASSERT_EQUAL_UINT32(157 - 128, list.getFillDropped());
+    TEST_ASSERT_EQUAL_UINT32(2 * (157 - 128), list.getDropped());
+    counts[255] = 0;
+    fillFromCounts(list, counts, consumerForType);
+    TEST_ASSERT_EQUAL_UINT32(150 - 128, list.getFillDropped());
+}
+
+static void test_upload_callback_allocates_only_the_returned_copy() {
+    // Refill + return by value, as the ESP-API callbacks do on every upload
+    std::array<uint16_t, 256> counts;
+    counts.fill(1);
+    UploadList<Consumer> list(128);
+    for (int upload = 0; upload < 100; upload++) {
+        const size_t before = allocations;
+        fillFromCounts(list, counts, consumerForType);
+        std::vector<Consumer> sent = list.get();
+        TEST_ASSERT_EQUAL_size_t(1, allocations - before);
+        TEST_ASSERT_EQUAL_size_t(128, sent.size());
+    }
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_refill_does_not_allocate);
+    RUN_TEST(test_overflow_drops_instead_of_growing);
+    RUN_TEST(test_clear_keeps_storage);
+    RUN_TEST(test_fill_from_counts_lists_every_unit);
+    RUN_TEST(test_fill_from_counts_counts_every_dropped_unit);
+    RUN_TEST(test_upload_callback_allocates_only_the_returned_copy);
+    return UNITY_END();
+}
@@ -0,0 +1,152 @@
+// Host tests for the warm-start record (warm_start_codec.cpp): encode / decode round trip
+// and rejection of damaged records. Run with: pio test -e native
+#include <unity.h>
+#include <string.h>
+#include "warm_start.h"
+
+static WarmStartState state;
+static WarmStartState decoded;
+static uint8_t record[WarmStart::MAX_RECORD_SIZE];
+
+static RawUid uidOf(uint8_t len, uint8_t seed) {
+    RawUid uid = {};
+    uid.len = len;
+    for (uint8_t i = 0; i < len; i++) uid.bytes[i] = static_cast<uint8_t>(seed + i * 17);
+    return uid;
+}
+
+// A state with every section in use
+static void fillState(WarmStartState& s) {
+    s.clear();
+    s.gameActive = true;
+    s.rangeMask = (1u << 1) | (1u << 4) | (1u << 8);
+    s.minWatts[1] = 0.0f;   s.maxWatts[1] = 120.5f;
+    s.minWatts[4] = 10.0f;  s.maxWatts[4] = 400.0f;
+    s.minWatts[8] = -250.0f; s.maxWatts[8] = 250.0f;
+    s.coefficientMask = (1u << 1) | (1u << 2);
+    s.productionCoefficient[1] = 0.35f;
+    s.productionCoefficient[2] = 0.875f;
+    s.inventoryMask = (1u << 3) | (1u << 7);
+    s.inventory[3] = 2;
+    s.inventory[7] = 5;
+    s.addConsumption(1, 12.5f);
+    s.addConsumption(200, -3.0f);
+    s.addBuilding(1, uidOf(4, 0x04), 0);
+    s.addBuilding(2, uidOf(7, 0x10), ':' | UidStore::FORMAT_LOWERCASE);
+    s.addBuilding(9, uidOf(10, 0x80), ' ');
+}
+
+static void assertSameState(const WarmStartState& a, const WarmStartState& b) {
+    TEST_ASSERT_EQUAL(a.gameActive, b.gameActive);
+    TEST_ASSERT_EQUAL_HEX16(a.rangeMask, b.rangeMask);
+    TEST_ASSERT_EQUAL_HEX16(a.coefficientMask, b.coefficientMask);
+    TEST_ASSERT_EQUAL_HEX16(a.inventoryMask, b.inventoryMask);
+    for (uint8_t t = 0; t < WarmStartState::TYPE_SLOTS; t++) {
+        if (a.rangeMask & (1u << t)) {
+            TEST_ASSERT_EQUAL_FLOAT(a.minWatts[t], b.minWatts[t]);
+            TEST_ASSERT_EQUAL_FLOAT(a.maxWatts[t], b.maxWatts[t]);
+        }
+        if (a.coefficientMask & (1u << t)) {
+            TEST_ASSERT_EQUAL_FLOAT(a.productionCoefficient[t], b.productionCoefficient[t]);
+        }
+        if (a.inventoryMask & (1u << t)) TEST_ASSERT_EQUAL_UINT8(a.inventory[t], b.inventory[t]);
+    }
+    TEST_ASSERT_EQUAL_UINT8(a.consumptionCount, b.consumptionCount);
+    for (uint8_t i = 0; i < a.consumptionCount; i++) {
+        TEST_ASSERT_EQUAL_UINT8(a.consumption[i].buildingType, b.consumption[i].buildingType);
+        TEST_ASSERT_EQUAL_FLOAT(a.consumption[i].consumption, b.consumption[i].consumption);
+    }
+    TEST_ASSERT_EQUAL_UINT8(a.buildingCount, b.buildingCount);
+    for (uint8_t i = 0; i < a.buildingCount; i++) {
+        TEST_ASSERT_EQUAL_UINT8(a.buildings[i].buildingType, b.buildings[i].buildingType);
+        TEST_ASSERT_EQUAL_HEX8(a.buildings[i].uidFormat, b.buildings[i].uidFormat);
+        TEST_ASSERT_TRUE(a.buildings[i].uid == b.buildings[i].uid);
+    }
+}
+
+void setUp() {
+    fillState(state);
+    decoded.clear();
+}
+
+void tearDown() {}
+
+static void test_round_trip() {
+    const size_t len = WarmStart::encode(state, record, sizeof(record));
+    TEST_ASSERT_TRUE(len > WarmStart::HEADER_SIZE);
+    TEST_ASSERT_TRUE(WarmStart::decode(record, len, decoded));
+    assertSameState(state, decoded);
+}
+
+static void test_empty_state_round_trip() {
+    WarmStartState empty;
+    empty.clear();
+    const size_t len = WarmStart::encode(empty, record, sizeof(record));
+    // Header, three empty masks, two zero counts
+    TEST_ASSERT_EQUAL_size_t(WarmStart::HEADER_SIZE + 2 + 2 + 2 + 1 + 1, len);
+    fillState(decoded);
+    TEST_ASSERT_TRUE(WarmStart::decode(record, len, decoded));
+    assertSameState(empty, decoded);
+}
+
+static void test_full_state_fits_max_record() {
+    state.clear();
+    state.rangeMask = state.coefficientMask = state.inventoryMask = 0x1FF;
+    for (uint8_t i = 0; i < WarmStartState::MAX_CONSUMPTION; i++) TEST_ASSERT_TRUE(state.addConsumption(i, i));
+    TEST_ASSERT_FALSE(state.addConsumption(99, 1.0f));
+    for (uint8_t i = 0; i < WarmStartState::MAX_BUILDINGS; i++) {
+        TEST_ASSERT_TRUE(state.addBuilding(i, uidOf(RawUid::MAX_BYTES, i), 0));
+    }
+    TEST_ASSERT_FALSE(state.addBuilding(1, uidOf(4, 1), 0));
+    const size_t len = WarmStart::encode(state, record, sizeof(record));
+    TEST_ASSERT_EQUAL_size_t(WarmStart::MAX_RECORD_SIZE, len);
+    TEST_ASSERT_TRUE(WarmStart::decode(record, len, decoded));
+    assertSameState(state, decoded);
+    TEST_ASSERT_EQUAL_size_t(0, WarmStart::encode(state, record, len - 1));   // does not fit
+}
+
+static void test_game_flag_changes_the_record() {
+    uint8_t other[WarmStart::MAX_RECORD_SIZE];
+    const size_t len = WarmStart::encode(state, record, sizeof(record));
+    state.gameActive = false;
+    TEST_ASSERT_EQUAL_size_t(len, WarmStart::encode(state, other, sizeof(other)));
+    TEST_ASSERT_TRUE(memcmp(record, other, len) != 0);
+}
+
+static void test_corrupted_records_are_rejected() {
+    const size_t len = WarmStart::encode(state, record, sizeof(record));
+    uint8_t bad[WarmStart::MAX_RECORD_SIZE];
+
+    // Every single-bit flip anywhere in the record is caught (header fields, CRC, payload)
+    for (size_t byte = 0; byte < len; byte++) {
+        for (uint8_t bit = 0; bit < 8; bit++) {
+            memcpy(bad, record, len);
+            bad[byte] ^= static_cast<uint8_t>(1u << bit);
+            if (WarmStart::decode(bad, len, decoded)) {
+                char msg[48];
+                snprintf(msg, sizeof(msg), "flip of byte %u bit %u accepted", (unsigned)byte, bit);
+                TEST_FAIL_MESSAGE(msg);
+            }
+        }
+    }
+    TEST_ASSERT_FALSE(WarmStart::decode(record, len - 1, decoded));          // truncated
+    TEST_ASSERT_FALSE(WarmStart::decode(record, WarmStart::HEADER_SIZE - 1, decoded));
+    memcpy(bad, record, len);
+    bad[len] = 0;
+    TEST_ASSERT_FALSE(WarmStart::decode(bad, len + 1, decoded));             // trailing byte
+
+    // Nothing of the rejected records reached the output
+    WarmStartState cleared;
+    cleared.clear();
+    assertSameState(cleared, decoded);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_round_trip);
+    RUN_TEST(test_empty_state_round_trip);
+    RUN_TEST(test_full_state_fits_max_record);
+    RUN_TEST(test_game_flag_changes_the_record);
+    RUN_TEST(test_corrupted_records_are_rejected);
+    return UNITY_END();
+}